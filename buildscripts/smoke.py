@@ -378,6 +378,7 @@ def skipTest(path):
         authTestsToSkip = [("jstests", "drop2.js"), # SERVER-8589,
                            ("sharding", "sync3.js"), # SERVER-6388 for this and those below
                            ("sharding", "sync6.js"),
+                           ("sharding", "distlock_single_server.js"),
                            ("sharding", "parallel.js"),
                            ("jstests", "bench_test1.js"),
                            ("jstests", "bench_test2.js"),
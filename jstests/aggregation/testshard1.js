@@ -172,6 +172,19 @@ testSortLimit(10, -1);
 testSortLimit(100,  1);
 testSortLimit(100, -1);
 
+// test sort without a limit, merged from the shards' presorted output
+function testSortMerge(direction) {
+    var from_cursor = db.ts1.find({},{random:1, _id:0})
+                            .sort({random: direction})
+                            .toArray();
+    var from_agg = db.ts1.aggregate({$project: {random:1, _id:0}}
+                                   ,{$sort: {random: direction}}
+                                   ).result;
+    assert.eq(from_cursor, from_agg);
+}
+testSortMerge(1);
+testSortMerge(-1);
+
 
 // shut everything down
 shardedAggTest.stop();
@@ -0,0 +1,43 @@
+// A bulk insert into a capped collection, of documents without _id that wrap around the
+// collection within the batch, logs every document as inserted and replicates it unchanged.
+
+var replTest = new ReplSetTest( {name: 'cappedInsertBatch', nodes: 2} );
+replTest.startSet();
+replTest.initiate();
+
+var master = replTest.getMaster();
+replTest.awaitSecondaryNodes();
+var slave = replTest.liveNodes.slaves[0];
+
+var masterdb = master.getDB( "capped_insert_batch" );
+var slavedb = slave.getDB( "capped_insert_batch" );
+
+assert.commandWorked( masterdb.createCollection( "capped", { capped: true, size: 8 * 1024 } ) );
+
+var padding = new Array( 512 ).join( "x" );
+var docs = [];
+for ( var i = 0; i < 100; i++ ) {
+    docs.push( { i: i, padding: padding } );
+}
+masterdb.capped.insert( docs );
+assert.eq( null, masterdb.getLastError() );
+
+// every entry logged for the batch holds the document inserted at that position
+var oplog = master.getDB( "local" ).oplog.rs;
+var i = 0;
+oplog.find( { ns: masterdb.capped.getFullName(), op: "i" } ).sort( { $natural: 1 } ).forEach(
+    function( entry ) {
+        assert.eq( i, entry.o.i, "oplog entry holds the wrong document: " + tojson( entry.o ) );
+        assert.eq( padding, entry.o.padding );
+        assert( entry.o._id, "oplog entry is missing the generated _id" );
+        i++;
+    } );
+assert.eq( docs.length, i );
+
+replTest.awaitReplication();
+
+var onMaster = masterdb.capped.find().sort( { $natural: 1 } ).toArray();
+var onSlave = slavedb.capped.find().sort( { $natural: 1 } ).toArray();
+assert.eq( tojson( onMaster ), tojson( onSlave ), "secondary diverged from the primary" );
+
+replTest.stopSet();
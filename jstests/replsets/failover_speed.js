@@ -0,0 +1,69 @@
+// Benchmark the time it takes a replica set to elect a new primary after the primary goes away,
+// with the default heartbeat settings and with a short heartbeatIntervalMillis and
+// electionTimeoutMillis.
+
+var measureFailover = function(name, settings) {
+    var replTest = new ReplSetTest({ name: name, nodes: 3 });
+    var nodes = replTest.startSet();
+
+    var config = replTest.getReplSetConfig();
+    if (settings) {
+        config.settings = settings;
+    }
+    replTest.initiate(config);
+
+    var master = replTest.getMaster();
+    replTest.awaitSecondaryNodes();
+
+    master.getDB("foo").bar.insert({ x: 1 });
+    master.getDB("foo").runCommand({ getLastError: 1, w: 3, wtimeout: 60000 });
+
+    if (settings) {
+        var stored = master.getDB("local").system.replset.findOne();
+        for (var key in settings) {
+            assert.eq(settings[key], stored.settings[key], "setting " + key + " not stored");
+        }
+    }
+
+    var masterId = replTest.getNodeId(master);
+    var start = new Date();
+    replTest.stop(masterId);
+
+    var newMaster = null;
+    assert.soon(function() {
+        for (var i = 0; i < nodes.length; i++) {
+            if (i == masterId) {
+                continue;
+            }
+            try {
+                if (nodes[i].getDB("admin").runCommand({ ismaster: 1 }).ismaster) {
+                    newMaster = nodes[i];
+                    return true;
+                }
+            }
+            catch (e) {
+                print("failover_speed.js ismaster failed: " + e);
+            }
+        }
+        return false;
+    }, "no new primary elected", 120 * 1000, 10);
+
+    var millis = new Date() - start;
+    print("failover_speed.js " + name + ": new primary " + newMaster.host + " after " +
+          millis + "ms");
+
+    replTest.stopSet();
+    return millis;
+};
+
+var defaultMillis = measureFailover("failoverDefault");
+var fastMillis = measureFailover("failoverFast", { heartbeatIntervalMillis: 200,
+                                                   electionTimeoutMillis: 1000 });
+
+print("failover_speed.js default settings: " + defaultMillis + "ms, fast settings: " +
+      fastMillis + "ms");
+
+// generous bound so slow build hosts do not fail the test
+assert.lt(fastMillis, 10 * 1000, "failover with fast heartbeat settings took too long");
+
+print("failover_speed.js success");
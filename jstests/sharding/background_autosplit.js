@@ -0,0 +1,46 @@
+//
+// With autoSplitInBackground, mongos splits chunks that grow past the split threshold on its
+// auto-split thread instead of on the writing client's, and reports that work in serverStatus.
+//
+
+var chunkSize = 1; // MB
+
+var st = new ShardingTest({ shards: 1, mongos: 1, other: { chunksize: chunkSize } });
+
+var mongos = st.s0;
+var admin = mongos.getDB("admin");
+var config = mongos.getDB("config");
+var coll = mongos.getCollection("background_autosplit.coll");
+
+assert.commandWorked(admin.runCommand({ setParameter: 1, autoSplitInBackground: true }));
+
+assert.commandWorked(admin.runCommand({ enableSharding: coll.getDB() + "" }));
+assert.commandWorked(admin.runCommand({ shardCollection: coll + "", key: { _id: 1 } }));
+
+var padding = new Array(1024).join("x");
+for (var i = 0; i < 5000; i++) {
+    coll.insert({ _id: i, padding: padding });
+}
+assert.eq(null, coll.getDB().getLastError());
+
+// the splits happen after the inserts return
+assert.soon(function() {
+    return config.chunks.find({ ns: coll + "" }).count() > 1;
+}, "chunks were not split in the background", 60 * 1000);
+
+var metrics = admin.serverStatus().metrics.autoSplit;
+printjson(metrics);
+assert.gt(metrics.queued, 0);
+assert.gt(metrics.splits, 0);
+assert.gt(metrics.check.num, 0);
+assert.eq(5000, coll.find().itcount());
+
+// a full queue drops checks rather than blocking writes
+assert.commandWorked(admin.runCommand({ setParameter: 1, autoSplitMaxQueueSize: 0 }));
+for (var i = 5000; i < 10000; i++) {
+    coll.insert({ _id: i, padding: padding });
+}
+assert.eq(null, coll.getDB().getLastError());
+assert.gt(admin.serverStatus().metrics.autoSplit.dropped, 0);
+
+st.stop();
@@ -0,0 +1,60 @@
+//
+// Measures continue-on-error bulk insert throughput through mongos as the number of shards grows.
+// Documents are spread over all shards by a hashed shard key, so each bulk insert is split between
+// every shard and mongos dispatches all of the per-shard batches before waiting on any of them.
+//
+
+var numBatches = 50;
+var batchSize = 500;
+
+var measureInserts = function(numShards) {
+    var st = new ShardingTest({ shards: numShards, mongos: 1, verbose: 0 });
+    st.stopBalancer();
+
+    var admin = st.s.getDB("admin");
+    var coll = st.s.getCollection("bulk_insert_shard_count.coll");
+
+    assert.commandWorked(admin.runCommand({ enableSharding: coll.getDB() + "" }));
+    assert.commandWorked(admin.runCommand({ shardCollection: coll + "",
+                                            key: { _id: "hashed" },
+                                            numInitialChunks: numShards * 4 }));
+
+    var batches = [];
+    for (var i = 0; i < numBatches; i++) {
+        var batch = [];
+        for (var j = 0; j < batchSize; j++) {
+            batch.push({ _id: i * batchSize + j, payload: "bulk insert benchmark document" });
+        }
+        batches.push(batch);
+    }
+
+    var start = new Date();
+    for (var i = 0; i < batches.length; i++) {
+        coll.insert(batches[i], 1); // continue on error
+        assert.eq(null, coll.getDB().getLastError());
+    }
+    var millis = Math.max(new Date() - start, 1);
+
+    assert.eq(numBatches * batchSize, coll.count());
+
+    // every shard received part of each batch
+    var shards = st.s.getDB("config").shards.find().toArray();
+    for (var i = 0; i < shards.length; i++) {
+        var shardColl = new Mongo(shards[i].host).getCollection(coll + "");
+        assert.gt(shardColl.count(), 0, "no documents on " + shards[i]._id);
+    }
+
+    st.stop();
+
+    var docsPerSec = Math.round(numBatches * batchSize * 1000 / millis);
+    jsTest.log("Inserted " + (numBatches * batchSize) + " documents into " + numShards +
+               " shards in " + millis + "ms (" + docsPerSec + " docs/sec)");
+    return docsPerSec;
+};
+
+var results = {};
+[1, 2, 4].forEach(function(numShards) {
+    results[numShards] = measureInserts(numShards);
+});
+
+jsTest.log("Bulk insert throughput by shard count (docs/sec): " + tojson(results));
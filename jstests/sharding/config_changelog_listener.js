@@ -0,0 +1,70 @@
+//
+// A mongos that tails the config changelog picks up splits and migrations made through another
+// mongos without being sent a stale version error first.
+//
+
+var st = new ShardingTest({ shards: 2, mongos: 2, verbose: 0 });
+st.stopBalancer();
+
+var admin = st.s0.getDB("admin");
+var otherAdmin = st.s1.getDB("admin");
+var coll = st.s0.getCollection("config_changelog_listener.coll");
+var otherColl = st.s1.getCollection(coll + "");
+
+assert.commandWorked(admin.runCommand({ enableSharding: coll.getDB() + "" }));
+printjson(admin.runCommand({ movePrimary: coll.getDB() + "", to: st.shard0.shardName }));
+assert.commandWorked(admin.runCommand({ shardCollection: coll + "", key: { _id: 1 } }));
+
+// load the collection metadata on the other mongos before it starts tailing
+assert.eq(0, otherColl.find().itcount());
+assert.commandWorked(otherAdmin.runCommand({ setParameter: 1, tailConfigChangelog: true }));
+
+var refreshed = function() {
+    return otherAdmin.serverStatus().metrics.sharding.configChangelog.collectionsRefreshed;
+};
+var otherVersion = function() {
+    return otherAdmin.runCommand({ getShardVersion: coll + "" }).version;
+};
+
+// The listener skips changes logged before it reached the end of the changelog, so log
+// changes until it reads one.
+var entries = function() {
+    return otherAdmin.serverStatus().metrics.sharding.configChangelog.entries;
+};
+var entriesBefore = entries();
+var warmup = st.s0.getCollection("config_changelog_listener.warmup");
+assert.commandWorked(admin.runCommand({ shardCollection: warmup + "", key: { _id: 1 } }));
+var splitAt = 0;
+assert.soon(function() {
+    assert.commandWorked(admin.runCommand({ split: warmup + "", middle: { _id: splitAt++ } }));
+    return entries() > entriesBefore;
+}, "other mongos did not start tailing the changelog");
+
+var refreshedBefore = refreshed();
+
+assert.commandWorked(admin.runCommand({ split: coll + "", middle: { _id: 0 } }));
+assert.commandWorked(admin.runCommand({ moveChunk: coll + "",
+                                        find: { _id: 0 },
+                                        to: st.shard1.shardName }));
+var version = admin.runCommand({ getShardVersion: coll + "" }).version;
+
+assert.soon(function() { return refreshed() >= refreshedBefore + 2; },
+            "split and migration not picked up from the changelog");
+assert.soon(function() { return bsonWoCompare({ v: otherVersion() }, { v: version }) == 0; },
+            "other mongos did not load the new version");
+
+// the collection is usable through both mongoses
+coll.insert({ _id: -1 });
+coll.insert({ _id: 1 });
+assert.eq(null, coll.getDB().getLastError());
+assert.eq(2, otherColl.find().itcount());
+
+// dropping the collection reloads its database on the other mongos
+var databasesBefore = otherAdmin.serverStatus().metrics.sharding.configChangelog.databasesRefreshed;
+coll.drop();
+assert.soon(function() {
+    return otherAdmin.serverStatus().metrics.sharding.configChangelog.databasesRefreshed >
+           databasesBefore;
+}, "drop not picked up from the changelog");
+
+st.stop();
@@ -0,0 +1,68 @@
+//
+// mongos spreads its cursors over independently locked partitions; the per-partition counts add
+// up to the totals, and idle cursors in every partition are timed out.
+//
+
+var st = new ShardingTest({ shards: 2, mongos: 1, verbose: 0 });
+st.stopBalancer();
+
+var admin = st.s.getDB("admin");
+var coll = st.s.getCollection("cursor_partitions.coll");
+
+assert.commandWorked(admin.runCommand({ enableSharding: coll.getDB() + "" }));
+printjson(admin.runCommand({ movePrimary: coll.getDB() + "", to: st.shard0.shardName }));
+assert.commandWorked(admin.runCommand({ shardCollection: coll + "", key: { _id: 1 } }));
+assert.commandWorked(admin.runCommand({ split: coll + "", middle: { _id: 0 } }));
+assert.commandWorked(admin.runCommand({ moveChunk: coll + "",
+                                        find: { _id: 0 },
+                                        to: st.shard1.shardName }));
+
+for (var i = -50; i < 50; i++) {
+    coll.insert({ _id: i });
+}
+assert.eq(null, coll.getDB().getLastError());
+
+var checkTotals = function(info) {
+    assert.eq(16, info.partitions.length);
+    var sharded = 0, refs = 0;
+    info.partitions.forEach(function(p) {
+        sharded += p.sharded;
+        refs += p.refs;
+    });
+    assert.eq(info.sharded, sharded);
+    assert.eq(info.refs, refs);
+    assert.eq(info.totalOpen, sharded + refs);
+};
+
+// keep many sharded cursors open, so they land in several partitions
+var cursors = [];
+for (var i = 0; i < 64; i++) {
+    var cursor = coll.find().batchSize(2);
+    cursor.next();
+    cursors.push(cursor);
+}
+
+var info = admin.serverStatus().cursors;
+printjson(info);
+checkTotals(info);
+assert.gte(info.sharded, 64);
+
+var used = info.partitions.filter(function(p) { return p.sharded > 0; }).length;
+assert.gt(used, 1, "cursors not spread over partitions");
+
+cursors.forEach(function(cursor) { assert.eq(99, cursor.itcount()); });
+
+// idle cursors time out
+var timedOutBefore = admin.serverStatus().cursors.timedOut;
+var idle = [];
+for (var i = 0; i < 8; i++) {
+    var cursor = coll.find().batchSize(2);
+    cursor.next();
+    idle.push(cursor);
+}
+assert.commandWorked(admin.runCommand({ cursorInfo: 1, setTimeout: 1000 }));
+assert.soon(function() { return admin.serverStatus().cursors.timedOut >= timedOutBefore + 8; },
+            "idle cursors not timed out");
+checkTotals(admin.runCommand({ cursorInfo: 1 }));
+
+st.stop();
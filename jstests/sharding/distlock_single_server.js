@@ -0,0 +1,26 @@
+// Distributed locks kept on a single config server are taken with a single findAndModify when
+// free, and still exclude each other.
+
+// NOTE: this test is skipped when running smoke.py with --auth or --keyFile to force authentication
+// in all tests.
+
+var conn = MongoRunner.runMongod({});
+var admin = conn.getDB("admin");
+
+// four threads of one process taking and releasing the same lock
+var res = admin.runCommand({ _testDistLockWithSyncCluster: 1, host: conn.host, secs: 5 });
+printjson(res);
+assert(res.ok, "lock was held by two threads at once");
+assert.gt(res.count, 0);
+
+var metrics = admin.serverStatus().metrics.distLock;
+printjson(metrics);
+assert.gt(metrics.acquiredDirectly, 0, "no lock was taken directly");
+assert.gte(metrics.acquired, metrics.acquiredDirectly);
+assert.gt(metrics.pings, 0);
+
+var lock = conn.getDB("config").locks.findOne({ _id: "testdistlockwithsync" });
+printjson(lock);
+assert.eq(0, lock.state);
+
+MongoRunner.stopMongod(conn);
@@ -0,0 +1,50 @@
+// Pre-split chunks of a new hashed collection are created directly on their shards, each shard
+// owning one contiguous range of them, without migrating any.
+
+var s = new ShardingTest({ shards : 3, mongos : 1, verbose : 0 });
+s.stopBalancer();
+
+var admin = s.s.getDB("admin");
+var coll = s.s.getCollection("hash_direct.coll");
+var numChunks = 6000;
+
+assert.commandWorked(admin.runCommand({ enableSharding : coll.getDB() + "" }));
+
+var start = new Date();
+assert.commandWorked(admin.runCommand({ shardCollection : coll + "",
+                                        key : { a : "hashed" },
+                                        numInitialChunks : numChunks }));
+print("sharding with " + numChunks + " initial chunks took " + (new Date() - start) + "ms");
+
+assert.eq(numChunks, s.config.chunks.count({ ns : coll + "" }));
+
+// nothing was migrated
+assert.eq(0, s.config.changelog.count({ ns : coll + "", what : "moveChunk.commit" }));
+
+// every shard has the shard key index and a third of the chunks, in one run
+s.config.shards.find().forEach(function(shard) {
+    var chunks = s.config.chunks.find({ ns : coll + "", shard : shard._id }).sort({ min : 1 })
+                                .toArray();
+    assert.gte(chunks.length, Math.floor(numChunks / 3), shard._id);
+    for (var i = 1; i < chunks.length; i++) {
+        assert.eq(chunks[i - 1].max, chunks[i].min, "chunks of " + shard._id + " not contiguous");
+    }
+
+    var indexes = new Mongo(shard.host).getCollection(coll + "").getIndexes();
+    assert(indexes.some(function(index) { return friendlyEqual(index.key, { a : "hashed" }); }),
+           "no shard key index on " + shard._id);
+});
+
+// documents spread over every shard
+for (var i = 0; i < 300; i++) {
+    coll.insert({ a : i });
+}
+assert.eq(null, coll.getDB().getLastError());
+assert.eq(300, coll.find().itcount());
+[s.shard0, s.shard1, s.shard2].forEach(function(shard) {
+    assert.gt(shard.getCollection(coll + "").count(), 0, shard.host);
+});
+
+assert.commandWorked(coll.getDB().runCommand({ drop : coll.getName() }));
+
+s.stop();
@@ -0,0 +1,109 @@
+//
+// Sorted and unsorted queries merged from several shards return every document in order while
+// mongos prefetches the next batch from each shard.
+//
+
+var st = new ShardingTest({ shards: 2, mongos: 1, verbose: 0 });
+st.stopBalancer();
+
+var mongos = st.s;
+var admin = mongos.getDB("admin");
+var coll = mongos.getCollection("merge_prefetch.coll");
+
+assert.commandWorked(admin.runCommand({ enableSharding: coll.getDB() + "" }));
+printjson(admin.runCommand({ movePrimary: coll.getDB() + "", to: st.shard0.shardName }));
+assert.commandWorked(admin.runCommand({ shardCollection: coll + "", key: { _id: 1 } }));
+assert.commandWorked(admin.runCommand({ split: coll + "", middle: { _id: 0 } }));
+assert.commandWorked(admin.runCommand({ moveChunk: coll + "",
+                                        find: { _id: 0 },
+                                        to: st.shard1.shardName }));
+
+// interleave the sort field across the shards so the merge switches shards on every document
+var N = 2000;
+for (var i = 0; i < N; i++) {
+    coll.insert({ _id: (i % 2 == 0 ? 1 : -1) * (i + 1), x: i });
+}
+assert.eq(null, coll.getDB().getLastError());
+
+var prefetchedBefore = mongos.getDB("admin").serverStatus().metrics.cursor.shardGetMore.prefetched;
+
+// sorted merge, small batches so every shard cursor needs many getMores
+var expected = 0;
+coll.find().sort({ x: 1 }).batchSize(10).forEach(function(doc) {
+    assert.eq(expected, doc.x, "sorted merge out of order");
+    expected++;
+});
+assert.eq(N, expected);
+
+// limit spanning several batches
+assert.eq(150, coll.find().sort({ x: -1 }).batchSize(10).limit(150).itcount());
+
+// unsorted merge
+assert.eq(N, coll.find().batchSize(10).itcount());
+
+// closing a cursor with a prefetch outstanding leaves mongos usable
+var cursor = coll.find().sort({ x: 1 }).batchSize(10);
+for (var i = 0; i < 25; i++) {
+    cursor.next();
+}
+cursor.close();
+assert.eq(N, coll.find().itcount());
+
+function shardGetMoreMetrics() {
+    return mongos.getDB("admin").serverStatus().metrics.cursor.shardGetMore;
+}
+
+// cursors left idle between client getMores hand their prefetch connections back to the pool,
+// and each one still returns every document
+var releasedBefore = shardGetMoreMetrics().prefetchReleased;
+var idle = [];
+for (var i = 0; i < 20; i++) {
+    var c = coll.find().sort({ x: 1 }).batchSize(10);
+    c.next();
+    idle.push(c);
+}
+assert.soon(function() {
+    return shardGetMoreMetrics().prefetchReleased >= releasedBefore + idle.length;
+}, "idle cursors kept their prefetch connections");
+idle.forEach(function(c) {
+    assert.eq(N - 1, c.itcount());
+});
+
+// A getMore served from one shard's buffered batch doesn't use a slow prefetch from the other.
+// The first document comes from shard1, which sends off a getMore for documents that each take
+// 300ms there, while the next 500 documents all come from shard0, each of whose batches was
+// prefetched while the one before it was returned.
+var slow = mongos.getCollection("merge_prefetch.slow");
+assert.commandWorked(admin.runCommand({ shardCollection: slow + "", key: { _id: 1 } }));
+assert.commandWorked(admin.runCommand({ split: slow + "", middle: { _id: 0 } }));
+assert.commandWorked(admin.runCommand({ moveChunk: slow + "",
+                                        find: { _id: 0 },
+                                        to: st.shard1.shardName }));
+slow.insert({ _id: 1, x: -1 });
+for (var i = 0; i < 500; i++) {
+    slow.insert({ _id: -(i + 1), x: i });
+}
+for (var i = 0; i < 30; i++) {
+    slow.insert({ _id: i + 2, x: 1000 + i, slow: i >= 9 });
+}
+slow.ensureIndex({ x: 1 });
+assert.eq(null, slow.getDB().getLastError());
+
+var slowCursor = slow.find({ $where: "if (this.slow) sleep(300); return true;" })
+                     .sort({ x: 1 }).hint({ x: 1 }).batchSize(10);
+assert.eq(-1, slowCursor.next().x);
+var before = shardGetMoreMetrics();
+for (var i = 0; i < 500; i++) {
+    assert.eq(i, slowCursor.next().x);
+}
+var after = shardGetMoreMetrics();
+var batches = after.wait.num - before.wait.num;
+var prefetched = after.prefetched - before.prefetched;
+print("read the fast documents in " + batches + " shard batches, " + prefetched + " prefetched");
+assert.gt(batches, 0, "no shard batches were fetched");
+assert.eq(batches, prefetched, "a shard batch wasn't prefetched");
+assert.eq(30, slowCursor.itcount());
+
+assert.gt(shardGetMoreMetrics().prefetched, prefetchedBefore, "no shard batches were prefetched");
+
+st.stop();
@@ -0,0 +1,68 @@
+//
+// Chunk migration copies every document whether or not the donor compresses the initial clone,
+// honours the clone rate limit and records the clone rate in the changelog.
+//
+
+var st = new ShardingTest({ shards: 2, mongos: 1, verbose: 0 });
+st.stopBalancer();
+
+var admin = st.s.getDB("admin");
+var config = st.s.getDB("config");
+var coll = st.s.getCollection("migrate_clone_stream.coll");
+
+assert.commandWorked(admin.runCommand({ enableSharding: coll.getDB() + "" }));
+printjson(admin.runCommand({ movePrimary: coll.getDB() + "", to: st.shard0.shardName }));
+assert.commandWorked(admin.runCommand({ shardCollection: coll + "", key: { _id: 1 } }));
+
+var padding = new Array(1024).join("x");
+for (var i = 0; i < 4000; i++) {
+    coll.insert({ _id: i, padding: padding });
+}
+assert.eq(null, coll.getDB().getLastError());
+coll.ensureIndex({ padding: 1 });
+
+var moveAndCheck = function(splitAt, compress, maxBytesPerSec) {
+    assert.commandWorked(admin.runCommand({ split: coll + "", middle: { _id: splitAt } }));
+
+    var recipient = st.shard1.getDB("admin");
+    assert.commandWorked(recipient.runCommand({ setParameter: 1,
+                                                migrateCompressClone: compress }));
+    assert.commandWorked(recipient.runCommand({ setParameter: 1,
+                                                migrateCloneMaxBytesPerSec: maxBytesPerSec }));
+
+    var start = new Date();
+    assert.commandWorked(admin.runCommand({ moveChunk: coll + "",
+                                            find: { _id: splitAt },
+                                            to: st.shard1.shardName,
+                                            _waitForDelete: true }));
+    var millis = new Date() - start;
+
+    // every chunk moved holds 1000 documents
+    var moved = st.shard1.getCollection(coll + "").find({ _id: { $gte: splitAt,
+                                                                 $lt: splitAt + 1000 } }).itcount();
+    assert.eq(1000, moved, "documents missing after migration");
+    assert.eq(4000, coll.find().itcount());
+    assert.eq(2, st.shard1.getCollection(coll + "").getIndexes().length);
+
+    var entry = config.changelog.find({ what: "moveChunk.to", "details.min._id": splitAt })
+                                .sort({ time: -1 }).next();
+    printjson(entry);
+    assert(entry.details["step3 bytesPerSec"] > 0, "no clone rate recorded");
+    return millis;
+};
+
+moveAndCheck(3000, true, 0);
+
+// move the chunk back so the next one can be moved again
+assert.commandWorked(admin.runCommand({ moveChunk: coll + "",
+                                        find: { _id: 3000 },
+                                        to: st.shard0.shardName,
+                                        _waitForDelete: true }));
+
+moveAndCheck(2000, false, 0);
+
+// about 1MB at 512KB/s takes about two seconds
+var throttledMillis = moveAndCheck(1000, true, 512 * 1024);
+assert.gte(throttledMillis, 1500, "clone rate limit not applied");
+
+st.stop();
@@ -0,0 +1,101 @@
+//
+// With staleWriteRetry, multi-updates and multi-removes with a range predicate on the shard key
+// are sent only to the shards whose chunks intersect the range.
+//
+
+var st = new ShardingTest({ shards: 3, mongos: 2, verbose: 0 });
+st.stopBalancer();
+
+var admin = st.s.getDB("admin");
+[ st.s0, st.s1 ].forEach(function(mongos) {
+    assert.commandWorked(mongos.getDB("admin").runCommand({ setParameter: 1,
+                                                            staleWriteRetry: true }));
+});
+var coll = st.s.getCollection("multi_write_targeting.coll");
+var shards = [ st.shard0, st.shard1, st.shard2 ];
+
+assert.commandWorked(admin.runCommand({ enableSharding: coll.getDB() + "" }));
+printjson(admin.runCommand({ movePrimary: coll.getDB() + "", to: st.shard0.shardName }));
+assert.commandWorked(admin.runCommand({ shardCollection: coll + "", key: { t: 1 } }));
+
+// [MinKey, 100) on shard0, [100, 200) on shard1, [200, MaxKey) on shard2
+assert.commandWorked(admin.runCommand({ split: coll + "", middle: { t: 100 } }));
+assert.commandWorked(admin.runCommand({ split: coll + "", middle: { t: 200 } }));
+assert.commandWorked(admin.runCommand({ moveChunk: coll + "",
+                                        find: { t: 100 },
+                                        to: st.shard1.shardName }));
+assert.commandWorked(admin.runCommand({ moveChunk: coll + "",
+                                        find: { t: 200 },
+                                        to: st.shard2.shardName }));
+
+for (var i = 0; i < 300; i++) {
+    coll.insert({ t: i, x: 0 });
+}
+assert.eq(null, coll.getDB().getLastError());
+
+var opCounts = function(op) {
+    return shards.map(function(shard) {
+        return shard.getDB("admin").serverStatus().opcounters[op];
+    });
+};
+
+var checkTargeted = function(op, write, expectedShards) {
+    var before = opCounts(op);
+    write();
+    assert.eq(null, coll.getDB().getLastError());
+    var after = opCounts(op);
+    for (var i = 0; i < shards.length; i++) {
+        var reached = after[i] > before[i];
+        assert.eq(expectedShards.indexOf(i) >= 0, reached,
+                  op + " targeting wrong for shard " + i + ": " + tojson(before) + " -> " +
+                  tojson(after));
+    }
+};
+
+// multi-update within one chunk
+checkTargeted("update", function() {
+    coll.update({ t: { $gte: 10, $lt: 20 } }, { $inc: { x: 1 } }, false, true);
+}, [ 0 ]);
+assert.eq(10, coll.find({ x: 1 }).itcount());
+
+// multi-update spanning two shards is applied exactly once per document
+checkTargeted("update", function() {
+    coll.update({ t: { $gte: 150, $lt: 250 } }, { $inc: { x: 1 } }, false, true);
+}, [ 1, 2 ]);
+assert.eq(110, coll.find({ x: 1 }).itcount());
+assert.eq(0, coll.find({ x: { $gt: 1 } }).itcount());
+
+// getLastError reports the write from every targeted shard
+coll.update({ t: { $gte: 150, $lt: 250 } }, { $set: { y: 1 } }, false, true);
+var gle = coll.getDB().getLastErrorObj();
+assert.eq(null, gle.err);
+assert.eq(100, gle.n);
+
+// multi-remove of an old time range
+checkTargeted("delete", function() {
+    coll.remove({ t: { $lt: 50 } });
+}, [ 0 ]);
+assert.eq(250, coll.find().itcount());
+
+checkTargeted("delete", function() {
+    coll.remove({ t: { $gte: 90, $lt: 110 } });
+}, [ 0, 1 ]);
+assert.eq(230, coll.find().itcount());
+
+// a predicate without the shard key still reaches every shard
+checkTargeted("delete", function() {
+    coll.remove({ x: 5 });
+}, [ 0, 1, 2 ]);
+assert.eq(230, coll.find().itcount());
+
+// a mongos which missed a migration still applies a targeted multi-update once per document
+var staleColl = st.s1.getCollection(coll + "");
+assert.eq(230, staleColl.find().itcount());
+assert.commandWorked(admin.runCommand({ moveChunk: coll + "",
+                                        find: { t: 150 },
+                                        to: st.shard2.shardName }));
+staleColl.update({ t: { $gte: 150, $lt: 250 } }, { $inc: { x: 1 } }, false, true);
+assert.eq(null, staleColl.getDB().getLastError());
+assert.eq(100, coll.find({ t: { $gte: 150, $lt: 250 }, x: 2 }).itcount());
+
+st.stop();
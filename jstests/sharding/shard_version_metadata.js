@@ -0,0 +1,94 @@
+//
+// A mongos sending the shard version with each query and command, rather than setting it on
+// the connection with setShardVersion, still gets correct results when chunks move under it.
+//
+
+var st = new ShardingTest({ shards: 2, mongos: 2, verbose: 0 });
+st.stopBalancer();
+
+var mongos = st.s0;
+var otherMongos = st.s1;
+var admin = mongos.getDB("admin");
+var coll = mongos.getCollection("shard_version_metadata.coll");
+
+assert.commandWorked(admin.runCommand({ setParameter: 1, shardVersionAsRequestMetadata: true }));
+
+assert.commandWorked(admin.runCommand({ enableSharding: coll.getDB() + "" }));
+printjson(admin.runCommand({ movePrimary: coll.getDB() + "", to: st.shard0.shardName }));
+assert.commandWorked(admin.runCommand({ shardCollection: coll + "", key: { _id: 1 } }));
+assert.commandWorked(admin.runCommand({ split: coll + "", middle: { _id: 0 } }));
+assert.commandWorked(admin.runCommand({ moveChunk: coll + "",
+                                        find: { _id: 0 },
+                                        to: st.shard1.shardName }));
+
+var N = 1000;
+for (var i = -N / 2; i < N / 2; i++) {
+    coll.insert({ _id: i });
+}
+assert.eq(null, coll.getDB().getLastError());
+
+var metrics = function() {
+    return mongos.getDB("admin").serverStatus().metrics.sharding.shardVersion;
+};
+
+var check = function() {
+    assert.eq(N, coll.find().itcount());
+    assert.eq(N, coll.count());
+    assert.eq(N / 2, coll.find({ _id: { $gte: 0 } }).sort({ _id: -1 }).itcount());
+};
+
+check();
+var before = metrics();
+printjson(before);
+assert.gt(before.requestMetadata, 0);
+
+// move chunks through the other mongos, so this one only learns of them from the shards
+var otherAdmin = otherMongos.getDB("admin");
+assert.commandWorked(otherAdmin.runCommand({ split: coll + "", middle: { _id: 250 } }));
+assert.commandWorked(otherAdmin.runCommand({ moveChunk: coll + "",
+                                             find: { _id: 250 },
+                                             to: st.shard0.shardName,
+                                             _waitForDelete: true }));
+assert.commandWorked(otherAdmin.runCommand({ split: coll + "", middle: { _id: -250 } }));
+assert.commandWorked(otherAdmin.runCommand({ moveChunk: coll + "",
+                                             find: { _id: -250 },
+                                             to: st.shard1.shardName,
+                                             _waitForDelete: true }));
+
+check();
+var after = metrics();
+printjson(after);
+assert.gt(after.roundTripsAvoided, before.roundTripsAvoided, "no setShardVersion avoided");
+
+// the shards applied the versions sent with the requests
+[st.shard0, st.shard1].forEach(function(shard) {
+    var applied = shard.getDB("admin").serverStatus().metrics.sharding.requestShardVersion.applied;
+    assert.gt(applied, 0);
+});
+
+// A restarted shard refuses request versions until a setShardVersion initializes sharding on
+// it, and the stale mongos falls back to sending one.
+check();
+MongoRunner.stopMongod(st.shard0);
+st.shard0 = MongoRunner.runMongod({ restart: st.shard0 });
+assert(!st.shard0.getDB("admin").runCommand({ shardingState: 1 }).enabled);
+
+// May fail the first couple times due to socket exceptions
+assert.soon(function() {
+    try {
+        return coll.find({ _id: { $gte: 250 } }).itcount() == N / 4;
+    }
+    catch (e) {
+        print("read after restart failed: " + e);
+        return false;
+    }
+});
+check();
+
+var state = st.shard0.getDB("admin").runCommand({ shardingState: 1 });
+printjson(state);
+assert(state.enabled, "restarted shard was not sent a setShardVersion");
+assert.gt(st.shard0.getDB("admin").serverStatus().metrics.sharding.requestShardVersion.rejected,
+          0);
+
+st.stop();
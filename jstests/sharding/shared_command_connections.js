@@ -0,0 +1,82 @@
+//
+// With shareConnectionsForUnversionedCommands set, mongos sends commands for unsharded databases
+// to the primary shard over a bounded pool of connections shared by all client threads, one
+// command at a time per connection.  While all of them are in use, commands wait for one
+// rather than opening more, up to sharedConnectionWaitMillis.  shardConnPoolStats reports the
+// connections to each host and how often commands waited or gave up waiting.
+//
+
+var st = new ShardingTest({ shards: 2, mongos: 1, verbose: 0 });
+st.stopBalancer();
+
+var mongos = st.s;
+var admin = mongos.getDB("admin");
+var db = mongos.getDB("shared_command_connections");   // db variable name is required by startParallelShell()
+
+assert.commandWorked(admin.runCommand({ setParameter: 1,
+                                        shareConnectionsForUnversionedCommands: true }));
+assert.commandWorked(admin.runCommand({ setParameter: 1, sharedConnectionsPerHost: 2 }));
+
+for (var i = 0; i < 100; i++) {
+    db.coll.insert({ _id: i, x: i % 10 });
+}
+assert.eq(null, db.getLastError());
+
+// commands still return the right answers and errors
+assert.eq(100, db.coll.count());
+assert.eq(10, db.coll.count({ x: 3 }));
+assert.eq(10, db.coll.distinct("x").length);
+assert.commandFailed(db.runCommand({ count: "coll", query: { $bad: 1 } }));
+
+// many client threads at once, which don't make mongos open a connection each to the shard
+var primary = st.getServer(db + "");
+var createdBefore = primary.getDB("admin").serverStatus().connections.totalCreated;
+
+var parallelCommand =
+    "for (var i = 0; i < 200; i++) { " +
+    "    assert.eq(100, db.coll.count()); " +
+    "    assert.eq(10, db.coll.count({ x: i % 10 })); " +
+    "}";
+
+var joins = [];
+for (var i = 0; i < 8; i++) {
+    joins.push(startParallelShell(parallelCommand));
+}
+joins.forEach(function(join) { join(); });
+
+var created = primary.getDB("admin").serverStatus().connections.totalCreated - createdBefore;
+print("connections created on the primary shard: " + created);
+assert.lt(created, 8, "client threads opened connections of their own");
+
+var stats = admin.runCommand({ shardConnPoolStats: 1 });
+assert.commandWorked(stats);
+printjson(stats.shared);
+
+var requests = 0;
+for (var host in stats.shared.hosts) {
+    var hostStats = stats.shared.hosts[host];
+    assert.lte(hostStats.open, 2, "too many shared connections to " + host);
+    requests += hostStats.requests;
+}
+// every command went over a shared connection
+assert.gte(requests, 8 * 400);
+assert.eq(0, stats.shared.totalInUse);
+
+// a slow command holding the only shared connection doesn't hold up the others
+assert.commandWorked(admin.runCommand({ setParameter: 1, sharedConnectionsPerHost: 1 }));
+assert.commandWorked(admin.runCommand({ setParameter: 1, sharedConnectionWaitMillis: 100 }));
+var timeoutsBefore = stats.shared.totalTimeouts;
+var slow = startParallelShell(
+    "db.coll.count({ $where: function() { sleep(100); return true; } });");
+assert.soon(function() {
+    return admin.runCommand({ shardConnPoolStats: 1 }).shared.totalInUse == 1;
+}, "slow command never took the shared connection");
+assert.eq(100, db.coll.count());
+slow();
+assert.gt(admin.runCommand({ shardConnPoolStats: 1 }).shared.totalTimeouts, timeoutsBefore);
+
+assert.commandWorked(admin.runCommand({ setParameter: 1,
+                                        shareConnectionsForUnversionedCommands: false }));
+assert.eq(100, db.coll.count());
+
+st.stop();
@@ -0,0 +1,94 @@
+//
+// A mongos with staleWriteRetry set resends writes a shard rejects as stale itself, instead of
+// the shard queuing them for writeback, and counts the retries in serverStatus.
+//
+
+var st = new ShardingTest({ shards: 2, mongos: 2, verbose: 0 });
+st.stopBalancer();
+
+var admin = st.s0.getDB("admin");
+var staleAdmin = st.s1.getDB("admin");
+var coll = st.s0.getCollection("stale_write_retry.coll");
+var staleColl = st.s1.getCollection(coll + "");
+
+assert.commandWorked(admin.runCommand({ enableSharding: coll.getDB() + "" }));
+printjson(admin.runCommand({ movePrimary: coll.getDB() + "", to: st.shard0.shardName }));
+assert.commandWorked(admin.runCommand({ shardCollection: coll + "", key: { _id: 1 } }));
+
+assert.commandWorked(staleAdmin.runCommand({ setParameter: 1, staleWriteRetry: true }));
+
+var staleWrites = function() {
+    return staleAdmin.serverStatus().metrics.sharding.staleWrites;
+};
+
+var nextSplit = 0;
+
+// moves a new chunk [nextSplit, nextSplit + 10) to shard1 through the other mongos, leaving the
+// stale mongos at the old version of both shards
+var moveChunkBehindStaleMongos = function() {
+    staleColl.insert({ _id: -1000 - nextSplit });
+    assert.eq(null, staleColl.getDB().getLastError());
+
+    nextSplit += 20;
+    assert.commandWorked(admin.runCommand({ split: coll + "", middle: { _id: nextSplit } }));
+    assert.commandWorked(admin.runCommand({ split: coll + "", middle: { _id: nextSplit + 10 } }));
+    assert.commandWorked(admin.runCommand({ moveChunk: coll + "",
+                                            find: { _id: nextSplit },
+                                            to: st.shard1.shardName }));
+};
+
+var onShard1 = function(query) {
+    return st.shard1.getCollection(coll + "").find(query).itcount();
+};
+
+// insert
+moveChunkBehindStaleMongos();
+var before = staleWrites();
+staleColl.insert({ _id: nextSplit + 1, x: 0 });
+assert.eq(null, staleColl.getDB().getLastError());
+var after = staleWrites();
+printjson(after);
+assert.gt(after.rejected, before.rejected, "stale insert was not rejected by the shard");
+assert.gt(after.retried, before.retried, "stale insert was not retried");
+assert.eq(1, onShard1({ _id: nextSplit + 1 }));
+
+// update
+moveChunkBehindStaleMongos();
+coll.insert({ _id: nextSplit + 1, x: 0 });
+assert.eq(null, coll.getDB().getLastError());
+before = staleWrites();
+staleColl.update({ _id: nextSplit + 1 }, { $inc: { x: 1 } });
+var gle = staleColl.getDB().getLastErrorObj();
+assert.eq(null, gle.err);
+assert.eq(1, gle.n);
+assert.gt(staleWrites().rejected, before.rejected, "stale update was not rejected by the shard");
+assert.eq(1, coll.findOne({ _id: nextSplit + 1 }).x);
+
+// delete
+moveChunkBehindStaleMongos();
+coll.insert({ _id: nextSplit + 1 });
+assert.eq(null, coll.getDB().getLastError());
+before = staleWrites();
+staleColl.remove({ _id: nextSplit + 1 });
+gle = staleColl.getDB().getLastErrorObj();
+assert.eq(null, gle.err);
+assert.eq(1, gle.n);
+assert.gt(staleWrites().rejected, before.rejected, "stale delete was not rejected by the shard");
+assert.eq(0, onShard1({ _id: nextSplit + 1 }));
+
+// continue-on-error bulk insert across both shards
+moveChunkBehindStaleMongos();
+before = staleWrites();
+var docs = [];
+for (var i = -5; i < 5; i++) {
+    docs.push({ _id: nextSplit + i, bulk: true });
+}
+staleColl.insert(docs, 1 /* continueOnError */);
+assert.eq(null, staleColl.getDB().getLastError());
+assert.gt(staleWrites().rejected, before.rejected, "stale bulk insert was not rejected");
+assert.eq(10, coll.find({ bulk: true }).itcount());
+assert.eq(5, onShard1({ bulk: true }));
+
+assert.eq(0, staleWrites().failed);
+
+st.stop();
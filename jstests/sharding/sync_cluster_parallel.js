@@ -0,0 +1,69 @@
+//
+// Metadata writes to three config servers go to all of them at once and keep them identical,
+// and the shards record how long each phase of those writes takes.
+//
+
+// writes through a SyncClusterConnection from the shell
+var test = new SyncCCTest("sync_cluster_parallel");
+var t = test.conn.getDB("test").sync_cluster_parallel;
+
+for (var i = 0; i < 50; i++) {
+    t.insert({ _id: i, x: i });
+}
+t.update({ _id: 10 }, { $set: { x: -10 } });
+t.remove({ _id: 20 });
+assert.eq(49, t.find().itcount());
+assert.eq(-10, t.findOne({ _id: 10 }).x);
+test.checkHashes("test", "after writes");
+
+// a write fails if any server is down, before it is sent anywhere
+test.tempKill(2);
+assert.throws(function() { t.insert({ _id: 100 }); });
+test.tempStart(2);
+test.checkHashes("test", "after failed write");
+test.stop();
+
+// metadata writes from the shards
+var st = new ShardingTest({ shards: 2, mongos: 1, other: { sync: true, separateConfig: true } });
+st.stopBalancer();
+
+var admin = st.s.getDB("admin");
+var coll = st.s.getCollection("sync_cluster_parallel.coll");
+
+// the shard splitting a chunk writes the new chunks and the changelog entry
+var syncCluster = function() {
+    var total = { prepare: { num: 0, totalMillis: 0 }, commit: { num: 0, totalMillis: 0 } };
+    [st.shard0, st.shard1].forEach(function(shard) {
+        var metrics = shard.getDB("admin").serverStatus().metrics.syncCluster;
+        total.prepare.num += metrics.prepare.num;
+        total.prepare.totalMillis += metrics.prepare.totalMillis;
+        total.commit.num += metrics.commit.num;
+        total.commit.totalMillis += metrics.commit.totalMillis;
+    });
+    return total;
+};
+
+assert.commandWorked(admin.runCommand({ enableSharding: coll.getDB() + "" }));
+assert.commandWorked(admin.runCommand({ shardCollection: coll + "", key: { _id: 1 } }));
+
+var before = syncCluster();
+for (var i = 1; i <= 10; i++) {
+    assert.commandWorked(admin.runCommand({ split: coll + "", middle: { _id: i * 10 } }));
+}
+var after = syncCluster();
+printjson(before);
+printjson(after);
+
+// each split logs to the changelog
+assert.gte(after.commit.num - before.commit.num, 10);
+assert.gte(after.prepare.num - before.prepare.num, 10);
+assert.gte(after.commit.totalMillis, after.prepare.totalMillis);
+
+assert.eq(11, st.s.getDB("config").chunks.count({ ns: coll + "" }));
+
+// every config server has every chunk
+[st.config0, st.config1, st.config2].forEach(function(config) {
+    assert.eq(11, config.getDB("config").chunks.count({ ns: coll + "" }), config.host);
+});
+
+st.stop();
@@ -1059,6 +1059,9 @@ namespace mongo {
         if( flags & WriteOption_FromWriteback )
             reservedFlags |= Reserved_FromWriteback;
 
+        if( flags & WriteOption_StaleConfigError )
+            reservedFlags |= Reserved_StaleConfigError;
+
         b.appendNum( reservedFlags );
         b.appendStr( ns );
         obj.appendSelfToBufBuilder( b );
@@ -1083,6 +1086,11 @@ namespace mongo {
             flags ^= WriteOption_FromWriteback;
         }
 
+        if( flags & WriteOption_StaleConfigError ){
+            reservedFlags |= Reserved_StaleConfigError;
+            flags ^= WriteOption_StaleConfigError;
+        }
+
         b.appendNum( reservedFlags );
         b.appendStr( ns );
         for( vector< BSONObj >::const_iterator i = v.begin(); i != v.end(); ++i )
@@ -1105,10 +1113,15 @@ namespace mongo {
         BufBuilder b;
         int reservedFlags = 0;
         if( flags & WriteOption_FromWriteback ){
-            reservedFlags |= WriteOption_FromWriteback;
+            reservedFlags |= Reserved_FromWriteback;
             flags ^= WriteOption_FromWriteback;
         }
 
+        if( flags & WriteOption_StaleConfigError ){
+            reservedFlags |= Reserved_StaleConfigError;
+            flags ^= WriteOption_StaleConfigError;
+        }
+
         b.appendNum( reservedFlags );
         b.appendStr( ns );
         b.appendNum( flags );
@@ -1137,6 +1150,11 @@ namespace mongo {
             flags ^= WriteOption_FromWriteback;
         }
 
+        if( flags & WriteOption_StaleConfigError ){
+            reservedFlags |= Reserved_StaleConfigError;
+            flags ^= WriteOption_StaleConfigError;
+        }
+
         b.appendNum( reservedFlags ); // reserved
         b.appendStr( ns );
         b.appendNum( flags );
@@ -113,10 +113,11 @@ namespace mongo {
      * @param secOnly never select a primary if true
      * @param localThresholdMillis the exclusive upper bound of ping time to be
      *     considered as a local node. Local nodes are favored over non-local
-     *     nodes if multiple nodes matches the other criteria.
-     * @param lastHost the last host returned (mainly used for doing round-robin).
-     *     Will be overwritten with the newly returned host if not empty. Should
-     *     never be NULL.
+     *     nodes if multiple nodes matches the other criteria, and among those the
+     *     least loaded node is selected, see ReplicaSetMonitor::Node::expectedLoad.
+     * @param lastHost the last host returned (mainly used for doing round-robin among
+     *     equally loaded nodes). Will be overwritten with the newly returned host if
+     *     not empty. Should never be NULL.
      * @param isPrimarySelected out parameter that is set to true if the returned host
      *     is a primary.
      *
@@ -130,8 +131,6 @@ namespace mongo {
                             int localThresholdMillis,
                             HostAndPort* lastHost /* in/out */,
                             bool* isPrimarySelected) {
-        HostAndPort fallbackHost;
-
         // Implicit: start from index 0 if lastHost doesn't exist anymore
         size_t nextNodeIndex = 0;
 
@@ -144,6 +143,11 @@ namespace mongo {
             }
         }
 
+        // ok candidates in round robin order, starting from the node next to lastHost
+        vector<size_t> candidates;
+        double totalLatency = 0;
+        int latencySamples = 0;
+
         for (size_t itNode = 0; itNode < nodes.size(); ++itNode) {
             nextNodeIndex = (nextNodeIndex + 1) % nodes.size();
             const ReplicaSetMonitor::Node& node = nodes[nextNodeIndex];
@@ -157,28 +161,86 @@ namespace mongo {
                 continue;
             }
 
-            if (node.matchesTag(readPreferenceTag)) {
-                // found an ok candidate; may not be local.
-                fallbackHost = node.addr;
-                *isPrimarySelected = node.ismaster;
+            if (!node.matchesTag(readPreferenceTag)) {
+                continue;
+            }
 
-                if (node.isLocalSecondary(localThresholdMillis)) {
-                    // found a local node.  return early.
-                    LOG(2) << "dbclient_rs _selectNode found local secondary for queries: "
-                           << nextNodeIndex << ", ping time: " << node.pingTimeMillis << endl;
-                    *lastHost = fallbackHost;
-                    return fallbackHost;
-                }
+            candidates.push_back(nextNodeIndex);
+            if (node.latencyMicros > 0) {
+                totalLatency += node.latencyMicros;
+                latencySamples++;
             }
         }
 
-        if (!fallbackHost.empty()) {
-            *lastHost = fallbackHost;
+        if (candidates.empty()) {
+            return HostAndPort();
+        }
+
+        // A node no request completed on yet is assumed as fast as the others on average
+        const double defaultLatency = latencySamples > 0 ? totalLatency / latencySamples : 1;
+
+        // Prefer local nodes, then the least loaded.  Among equally loaded nodes, take the first
+        // local one or else the last other one in round robin order.
+        int best = -1;
+        bool bestIsLocal = false;
+        double bestLoad = 0;
+
+        for (size_t i = 0; i < candidates.size(); i++) {
+            const ReplicaSetMonitor::Node& node = nodes[candidates[i]];
+            const bool isLocal = node.isLocalSecondary(localThresholdMillis);
+            const double load = node.expectedLoad(defaultLatency);
+
+            if (best >= 0) {
+                if (bestIsLocal && !isLocal) {
+                    continue;
+                }
+
+                if (bestIsLocal == isLocal &&
+                        (load > bestLoad || (isLocal && load == bestLoad))) {
+                    continue;
+                }
+            }
+
+            best = candidates[i];
+            bestIsLocal = isLocal;
+            bestLoad = load;
         }
 
-        return fallbackHost;
+        const ReplicaSetMonitor::Node& node = nodes[best];
+        LOG(2) << "dbclient_rs _selectNode found " << (bestIsLocal ? "local " : "")
+               << "node for queries: " << best << ", ping time: " << node.pingTimeMillis
+               << ", latency: " << node.latencyMicros << "us, outstanding: "
+               << node.outstanding << endl;
+
+        *isPrimarySelected = node.ismaster;
+        *lastHost = node.addr;
+        return node.addr;
     }
 
+    /**
+     * Counts a request to a node selected by read preference as in flight with the set's
+     * monitor for as long as this is in scope, and reports its latency if it completed.
+     */
+    class TrackedNodeRequest : boost::noncopyable {
+    public:
+        TrackedNodeRequest(const ReplicaSetMonitorPtr& monitor, const HostAndPort& host) :
+            _monitor(monitor), _host(host), _completed(false) {
+            _monitor->notifyRequestStart(_host);
+        }
+
+        ~TrackedNodeRequest() {
+            _monitor->notifyRequestEnd(_host, _completed ? _timer.micros() : -1);
+        }
+
+        void completed() { _completed = true; }
+
+    private:
+        ReplicaSetMonitorPtr _monitor;
+        HostAndPort _host;
+        bool _completed;
+        Timer _timer;
+    };
+
     /**
      * Extracts the read preference settings from the query document. Note that this method
      * assumes that the query is ok for secondaries so it defaults to
@@ -623,6 +685,38 @@ namespace mongo {
         }
     }
 
+    void ReplicaSetMonitor::notifyRequestStart( const HostAndPort& server ) {
+        scoped_lock lk( _lock );
+        int x = _find_inlock( server );
+        if ( x >= 0 ) {
+            _nodes[x].outstanding++;
+        }
+    }
+
+    void ReplicaSetMonitor::notifyRequestEnd( const HostAndPort& server, long long micros ) {
+        // weight of the latest request in the average latency
+        static const double latencyWeight = 0.2;
+
+        scoped_lock lk( _lock );
+        int x = _find_inlock( server );
+        if ( x < 0 ) {
+            return;
+        }
+
+        Node& node = _nodes[x];
+        if ( node.outstanding > 0 ) {
+            node.outstanding--;
+        }
+
+        if ( micros < 0 ) {
+            return;
+        }
+
+        node.latencyMicros = node.latencyMicros > 0 ?
+            ( 1 - latencyWeight ) * node.latencyMicros + latencyWeight * micros :
+            std::max( micros, 1LL );
+    }
+
     NodeDiff ReplicaSetMonitor::_getHostDiff_inlock( const BSONObj& hostList ){
 
         NodeDiff diff;
@@ -988,6 +1082,9 @@ namespace mongo {
             builder.append("hidden", node.hidden);
             builder.append("secondary", node.secondary);
             builder.append("pingTimeMillis", node.pingTimeMillis);
+            builder.append("latencyMicros", static_cast<long long>(node.latencyMicros));
+            builder.append("outstanding", node.outstanding);
+            builder.append("selected", node.selectedCount);
 
             const BSONElement& tagElem = node.lastIsMaster["tags"];
             if (tagElem.ok() && tagElem.isABSONObj()) {
@@ -1027,8 +1124,16 @@ namespace mongo {
             _check();
 
             scoped_lock lk(_lock);
-            return ReplicaSetMonitor::selectNode(_nodes, preference, tags, _localThresholdMillis,
-                    &_lastReadPrefHost, isPrimarySelected);
+            candidate = ReplicaSetMonitor::selectNode(_nodes, preference, tags,
+                    _localThresholdMillis, &_lastReadPrefHost, isPrimarySelected);
+        }
+
+        if (!candidate.empty()) {
+            scoped_lock lk(_lock);
+            int x = _find_inlock(candidate);
+            if (x >= 0) {
+                _nodes[x].selectedCount++;
+            }
         }
 
         return candidate;
@@ -1297,6 +1402,12 @@ namespace mongo {
     }
 
     DBClientReplicaSet::~DBClientReplicaSet() {
+        try {
+            _endTrackedLazyRequest(false);
+        }
+        catch (const DBException&) {
+            // the set's monitor is gone, so there is nothing left to report to
+        }
     }
 
     ReplicaSetMonitorPtr DBClientReplicaSet::_getMonitor() const {
@@ -1495,9 +1606,11 @@ namespace mongo {
                         break;
                     }
 
+                    TrackedNodeRequest tracked(_getMonitor(), _lastSlaveOkHost);
                     auto_ptr<DBClientCursor> cursor = conn->query(ns, query,
                             nToReturn, nToSkip, fieldsToReturn, queryOptions,
                             batchSize);
+                    tracked.completed();
 
                     return checkSlaveQueryResult(cursor);
                 }
@@ -1531,7 +1644,11 @@ namespace mongo {
                         break;
                     }
 
-                    return conn->findOne(ns,query,fieldsToReturn,queryOptions);
+                    TrackedNodeRequest tracked(_getMonitor(), _lastSlaveOkHost);
+                    BSONObj result = conn->findOne(ns,query,fieldsToReturn,queryOptions);
+                    tracked.completed();
+
+                    return result;
                 }
                 catch (const DBException &dbExcep) {
                     LOG(1) << "can't findone replica set slave " << _lastSlaveOkHost
@@ -1644,6 +1761,9 @@ namespace mongo {
 
     void DBClientReplicaSet::say(Message& toSend, bool isRetry, string* actualServer) {
 
+        // a retry, or a new request, means the response to the last one will not be read
+        _endTrackedLazyRequest(false);
+
         if (!isRetry)
             _lazyState = LazyState();
 
@@ -1677,6 +1797,10 @@ namespace mongo {
                         _lazyState._lastOp = lastOp;
                         _lazyState._slaveOk = slaveOk;
                         _lazyState._lastClient = conn;
+
+                        _getMonitor()->notifyRequestStart(_lastSlaveOkHost);
+                        _lazyState._trackedHost = _lastSlaveOkHost;
+                        _lazyState._sentMicros = curTimeMicros64();
                     }
                     catch (const DBException& DBExcep) {
                         LOG(1) << "can't callLazy replica set slave " << _lastSlaveOkHost
@@ -1713,14 +1837,31 @@ namespace mongo {
 
         // TODO: It would be nice if we could easily wrap a conn error as a result error
         try {
-            return _lazyState._lastClient->recv( m );
+            bool received = _lazyState._lastClient->recv( m );
+            _endTrackedLazyRequest( received );
+            return received;
         }
         catch( DBException& e ){
             log() << "could not receive data from " << _lazyState._lastClient << causedBy( e ) << endl;
+            _endTrackedLazyRequest( false );
             return false;
         }
     }
 
+    void DBClientReplicaSet::_endTrackedLazyRequest( bool completed ) {
+        if ( _lazyState._trackedHost.empty() )
+            return;
+
+        HostAndPort host = _lazyState._trackedHost;
+        _lazyState._trackedHost = HostAndPort();
+
+        long long micros = -1;
+        if ( completed )
+            micros = static_cast<long long>( curTimeMicros64() - _lazyState._sentMicros );
+
+        _getMonitor()->notifyRequestEnd( host, micros );
+    }
+
     void DBClientReplicaSet::checkResponse( const char* data, int nReturned, bool* retry, string* targetHost ){
 
         // For now, do exactly as we did before, so as not to break things.  In general though, we
@@ -1813,7 +1954,13 @@ namespace mongo {
                             *actualServer = conn->getServerAddress();
                         }
 
-                        return conn->call(toSend, response, assertOk);
+                        TrackedNodeRequest tracked(_getMonitor(), _lastSlaveOkHost);
+                        bool ok = conn->call(toSend, response, assertOk);
+                        if (ok) {
+                            tracked.completed();
+                        }
+
+                        return ok;
                     }
                     catch (const DBException& dbExcep) {
                         LOG(1) << "can't call replica set slave " << _lastSlaveOkHost
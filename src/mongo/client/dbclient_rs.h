@@ -62,7 +62,10 @@ namespace mongo {
                 ismaster(false),
                 secondary( false ),
                 hidden( false ),
-                pingTimeMillis( 0 ) {
+                pingTimeMillis( 0 ),
+                latencyMicros( 0 ),
+                outstanding( 0 ),
+                selectedCount( 0 ) {
             }
 
             bool okForSecondaryQueries() const {
@@ -98,6 +101,16 @@ namespace mongo {
                 return pingTimeMillis < threshold;
             }
 
+            /**
+             * @param  defaultLatency  latency (in micros) to assume if no request completed yet
+             * @return expected cost of one more request to this node: its average request
+             *     latency times the requests already in flight to it, plus one
+             */
+            double expectedLoad( double defaultLatency ) const {
+                return ( latencyMicros > 0 ? latencyMicros : defaultLatency ) *
+                       ( outstanding + 1 );
+            }
+
             /**
              * Checks whether this nodes is compatible with the given readPreference and
              * tag. Compatibility check is strict in the sense that secondary preferred
@@ -131,6 +144,16 @@ namespace mongo {
 
             int pingTimeMillis;
 
+            // exponentially weighted moving average of the latency of requests sent to this
+            // node by read preference, 0 until one completes
+            double latencyMicros;
+
+            // requests sent to this node by read preference still waiting for a response
+            int outstanding;
+
+            // number of times this node was selected by read preference
+            long long selectedCount;
+
         };
 
         static const double SOCKET_TIMEOUT_SECS;
@@ -144,11 +167,11 @@ namespace mongo {
          * @param localThresholdMillis the exclusive upper bound of ping time to be
          *     considered as a local node. Local nodes are favored over non-local
          *     nodes if multiple nodes matches the other criteria.
-         * @param lastHost the host used in the last successful request. This is used for
-         *     selecting a different node as much as possible, by doing a simple round
-         *     robin, starting from the node next to this lastHost. This will be overwritten
-         *     with the newly chosen host if not empty, not primary and when preference
-         *     is not Nearest.
+         * @param lastHost the host used in the last successful request. Among equally loaded
+         *     nodes, see Node::expectedLoad, this is used for selecting a different node as
+         *     much as possible, by doing a simple round robin, starting from the node next to
+         *     this lastHost. This will be overwritten with the newly chosen host if not empty,
+         *     not primary and when preference is not Nearest.
          * @param isPrimarySelected out parameter that is set to true if the returned host
          *     is a primary. Cannot be NULL and valid only if returned host is not empty.
          *
@@ -249,6 +272,19 @@ namespace mongo {
          */
         void notifySlaveFailure( const HostAndPort& server );
 
+        /**
+         * Notifies the monitor that a request was sent to a node selected by read preference,
+         * counting it as in flight until #notifyRequestEnd.
+         */
+        void notifyRequestStart( const HostAndPort& server );
+
+        /**
+         * Notifies the monitor that a request to a node selected by read preference ended,
+         * after 'micros', which is added to the node's average latency unless negative
+         * because the request failed.
+         */
+        void notifyRequestEnd( const HostAndPort& server, long long micros );
+
         /**
          * checks for current master and new secondaries
          */
@@ -594,14 +630,25 @@ namespace mongo {
          */
         class LazyState {
         public:
-            LazyState() : _lastClient( NULL ), _lastOp( -1 ), _slaveOk( false ), _retries( 0 ) {}
+            LazyState() : _lastClient( NULL ), _lastOp( -1 ), _slaveOk( false ), _retries( 0 ),
+                          _sentMicros( 0 ) {}
             DBClientConnection* _lastClient;
             int _lastOp;
             bool _slaveOk;
             int _retries;
 
+            // node selected by read preference the request was sent to, while in flight
+            HostAndPort _trackedHost;
+            unsigned long long _sentMicros;
+
         } _lazyState;
 
+        /**
+         * Reports the end of the request said to a node selected by read preference, if any,
+         * to the monitor.
+         */
+        void _endTrackedLazyRequest( bool completed );
+
     };
 
     /**
@@ -123,6 +123,17 @@ namespace mongo {
             nToReturn -= batch.nReturned;
             verify(nToReturn > 0);
         }
+
+        if ( prefetchPending() ) {
+            // _recvPrefetched() checked the reply on the connection that received it
+            _recvPrefetched();
+            this->batch.m = _prefetched;
+            bool retry;
+            string lazyHost;
+            dataReceived( retry, lazyHost, true );
+            return;
+        }
+
         BufBuilder b;
         b.appendNum(opts);
         b.appendStr(ns);
@@ -150,6 +161,120 @@ namespace mongo {
         }
     }
 
+    bool DBClientCursor::prefetchMore() {
+        if ( prefetchPending() )
+            return _prefetchSent;
+
+        if ( ! cursorId || ( opts & ( QueryOption_CursorTailable | QueryOption_Exhaust ) ) )
+            return false;
+
+        // the getMore asks for what is left after the current batch, as requestMore() would
+        int remaining = nToReturn;
+        if ( haveLimit ) {
+            remaining -= batch.nReturned;
+            if ( remaining <= 0 )
+                return false;
+        }
+
+        int savedNToReturn = nToReturn;
+        nToReturn = remaining;
+        int n = nextBatchSize();
+        nToReturn = savedNToReturn;
+
+        BufBuilder b;
+        b.appendNum(opts);
+        b.appendStr(ns);
+        b.appendNum(n);
+        b.appendNum(cursorId);
+
+        Message toSend;
+        toSend.setData(dbGetMore, b.buf(), b.len());
+
+        if ( _client ) {
+            // a replica set connection may not route the getMore to the cursor's member
+            if ( _client->type() != ConnectionString::MASTER )
+                return false;
+            _client->say( toSend );
+        }
+        else {
+            verify( _scopedHost.size() );
+            auto_ptr<ScopedDbConnection> conn( new ScopedDbConnection( _scopedHost ) );
+            if ( conn->get()->type() != ConnectionString::MASTER ) {
+                conn->done();
+                return false;
+            }
+            try {
+                conn->get()->say( toSend );
+            }
+            catch ( ... ) {
+                conn->kill();
+                throw;
+            }
+            _prefetchConn = conn.release();
+        }
+
+        _prefetchSent = true;
+        return true;
+    }
+
+    void DBClientCursor::_recvPrefetched( double timeoutSecs ) {
+        if ( ! _prefetchSent )
+            return;
+
+        _prefetchSent = false;
+        auto_ptr<ScopedDbConnection> conn( _prefetchConn );
+        _prefetchConn = 0;
+
+        DBClientBase* client = conn.get() ? conn->get() : _client;
+        verify( client );
+
+        // only a pooled connection is given a shorter timeout, it's killed if that runs out
+        DBClientConnection* timed = NULL;
+        double oldTimeout = 0;
+        if ( conn.get() && timeoutSecs > 0 ) {
+            timed = dynamic_cast<DBClientConnection*>( client );
+            if ( timed ) {
+                oldTimeout = timed->getSoTimeout();
+                timed->setSoTimeout( timeoutSecs );
+            }
+        }
+
+        auto_ptr<Message> response( new Message() );
+        bool ok = false;
+        try {
+            ok = client->recv( *response );
+        }
+        catch ( ... ) {
+            if ( conn.get() ) conn->kill();
+            throw;
+        }
+
+        if ( timed )
+            timed->setSoTimeout( oldTimeout );
+
+        if ( ! ok ) {
+            if ( conn.get() ) conn->kill();
+            uasserted( 16815, str::stream() << "recv failed for prefetched getMore from "
+                                            << client->getServerAddress() );
+        }
+
+        // watch for "not master" while we still hold the connection, see dataReceived()
+        QueryResult* qr = (QueryResult *) response->singleData();
+        bool retry;
+        string host;
+        client->checkResponse( qr->data(), qr->nReturned, &retry, &host );
+
+        if ( conn.get() ) conn->done();
+        _prefetched = response;
+    }
+
+    bool DBClientCursor::releasePrefetchConnection( double timeoutSecs ) {
+        if ( ! _prefetchConn )
+            return false;
+        _recvPrefetched( timeoutSecs );
+        return true;
+    }
+
     /** with QueryOption_Exhaust, the server just blasts data at us (marked at end with cursorid==0). */
     void DBClientCursor::exhaustReceiveMore() {
         verify( cursorId && batch.pos == batch.nReturned );
@@ -163,7 +288,7 @@ namespace mongo {
         dataReceived();
     }
 
-    void DBClientCursor::dataReceived( bool& retry, string& host ) {
+    void DBClientCursor::dataReceived( bool& retry, string& host, bool responseChecked ) {
 
         QueryResult *qr = (QueryResult *) batch.m->singleData();
         resultFlags = qr->resultFlags();
@@ -190,7 +315,12 @@ namespace mongo {
         batch.pos = 0;
         batch.data = qr->data();
 
-        _client->checkResponse( batch.data, batch.nReturned, &retry, &host ); // watches for "not master"
+        if ( responseChecked ) {
+            retry = false;
+        }
+        else {
+            _client->checkResponse( batch.data, batch.nReturned, &retry, &host ); // watches for "not master"
+        }
 
         if( qr->resultFlags() & ResultFlag_ShardConfigStale ) {
             BSONObj error;
@@ -290,6 +420,9 @@ namespace mongo {
         verify( conn );
         verify( conn->get() );
 
+        // the connection goes back to the pool, so it can't be left with an unread reply
+        _recvPrefetched();
+
         if ( conn->get()->type() == ConnectionString::SET ||
              conn->get()->type() == ConnectionString::SYNC ) {
             if( _lazyHost.size() > 0 )
@@ -314,6 +447,17 @@ namespace mongo {
 
         DESTRUCTOR_GUARD (
 
+        if ( _prefetchConn ) {
+            // don't wait for a reply nobody reads, drop the connection carrying it instead
+            _prefetchConn->kill();
+            delete _prefetchConn;
+            _prefetchConn = 0;
+            _prefetchSent = false;
+        }
+
+        // drain an outstanding getMore so the cursor's connection can be reused
+        _recvPrefetched();
+
         if ( cursorId && _ownCursor && ! inShutdown() ) {
             BufBuilder b;
             b.appendNum( (int)0 ); // reserved
@@ -29,6 +29,7 @@
 namespace mongo {
 
     class AScopedConnection;
+    class ScopedDbConnection;
 
     /** for mock purposes only -- do not create variants of DBClientCursor, nor hang code here 
         @see DBClientMockCursor
@@ -144,7 +145,9 @@ namespace mongo {
             resultFlags(0),
             cursorId(),
             _ownCursor( true ),
-            wasError( false ) {
+            wasError( false ),
+            _prefetchSent( false ),
+            _prefetchConn( 0 ) {
             _finishConsInit();
         }
 
@@ -160,7 +163,9 @@ namespace mongo {
             resultFlags(0),
             cursorId(_cursorId),
             _ownCursor(true),
-            wasError(false) {
+            wasError(false),
+            _prefetchSent(false),
+            _prefetchConn(0) {
             _finishConsInit();
         }
 
@@ -175,6 +180,33 @@ namespace mongo {
 
         void attach( AScopedConnection * conn );
 
+        /**
+         * Sends the getMore for the next batch without waiting for the reply, so the server can
+         * produce it while the current batch is consumed.  The reply is read by more() once the
+         * current batch runs out, so at most one batch is buffered ahead.  Does nothing unless
+         * the cursor is alive, not tailable or exhaust, still has results to return and talks to
+         * a single server.  An attach()ed cursor holds a pooled connection until the reply is
+         * read, see releasePrefetchConnection(); otherwise nothing else may be sent on the
+         * cursor's connection until then.
+         *
+         * @return true if a getMore is outstanding after the call
+         */
+        bool prefetchMore();
+
+        /**
+         * Reads the reply to an outstanding prefetch of an attach()ed cursor now, keeping it as
+         * the next batch, and returns the pooled connection that carried it.  Call before the
+         * cursor is left idle.
+         *
+         * @param timeoutSecs if > 0, how long to wait for the reply before killing the
+         *        connection; the cursor can't continue after that
+         * @return true if a connection was given back
+         */
+        bool releasePrefetchConnection( double timeoutSecs = 0 );
+
+        /** @return true if a prefetched getMore has been sent and not yet made the current batch */
+        bool prefetchPending() const { return _prefetchSent || _prefetched.get(); }
+
         string originalHost() const { return _originalHost; }
 
         string getns() const { return ns; }
@@ -234,11 +266,16 @@ namespace mongo {
         string _scopedHost;
         string _lazyHost;
         bool wasError;
+        bool _prefetchSent; // getMore sent by prefetchMore() and not yet received
+        auto_ptr<Message> _prefetched; // reply received but not yet the current batch
+        ScopedDbConnection* _prefetchConn; // carries the prefetch of an attach()ed cursor
 
         void dataReceived() { bool retry; string lazyHost; dataReceived( retry, lazyHost ); }
-        void dataReceived( bool& retry, string& lazyHost );
+        /** @param responseChecked  true if the connection already checked the reply for errors */
+        void dataReceived( bool& retry, string& lazyHost, bool responseChecked = false );
         void requestMore();
         void exhaustReceiveMore(); // for exhaust
+        void _recvPrefetched( double timeoutSecs = 0 );
 
         // Don't call from a virtual function
         void _assertIfNull() const { uassert(13348, "connection died", this); }
@@ -118,7 +118,10 @@ namespace mongo {
      */
     enum WriteOptions {
         /** logical writeback option */
-        WriteOption_FromWriteback = 1 << 31
+        WriteOption_FromWriteback = 1 << 31,
+
+        /** report a write at a stale shard version as an error instead of queuing a writeback */
+        WriteOption_StaleConfigError = 1 << 30
     };
 
     //
@@ -129,7 +132,8 @@ namespace mongo {
 
     enum ReservedOptions {
         Reserved_InsertOption_ContinueOnError = 1 << 0 ,
-        Reserved_FromWriteback = 1 << 1
+        Reserved_FromWriteback = 1 << 1 ,
+        Reserved_StaleConfigError = 1 << 2
     };
 
     enum ReadPreference {
@@ -21,7 +21,11 @@
 
 #include <boost/thread/thread.hpp>
 
+#include "mongo/base/counter.h"
 #include "mongo/client/dbclientcursor.h"
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/namespacestring.h"
+#include "mongo/db/stats/timer_stats.h"
 #include "mongo/s/type_locks.h"
 #include "mongo/s/type_lockpings.h"
 #include "mongo/util/timer.h"
@@ -73,6 +77,32 @@ namespace mongo {
         return s;
     }
 
+    static Counter64 pingRounds;
+    static ServerStatusMetricField<Counter64> displayPingRounds(
+            "distLock.pings", &pingRounds );
+
+    static Counter64 locksAcquired;
+    static ServerStatusMetricField<Counter64> displayLocksAcquired(
+            "distLock.acquired", &locksAcquired );
+
+    static Counter64 locksAcquiredDirectly;
+    static ServerStatusMetricField<Counter64> displayLocksAcquiredDirectly(
+            "distLock.acquiredDirectly", &locksAcquiredDirectly );
+
+    static Counter64 locksContended;
+    static ServerStatusMetricField<Counter64> displayLocksContended(
+            "distLock.contended", &locksContended );
+
+    // time spent in each attempt to take a lock, and the time waited for a lock until it was
+    // taken or given up on
+    static TimerStats lockTryStats;
+    static ServerStatusMetricField<TimerStats> displayLockTry(
+            "distLock.tryLock", &lockTryStats );
+
+    static TimerStats lockWaitStats;
+    static ServerStatusMetricField<TimerStats> displayLockWait(
+            "distLock.wait", &lockWaitStats );
+
     // Used for disabling the lock pinger during tests
     // Should *always* be true otherwise.
     static bool lockPingerEnabled = true;
@@ -80,6 +110,12 @@ namespace mongo {
     bool isLockPingerEnabled() { return lockPingerEnabled; }
     void setLockPingerEnabled(bool enabled) { lockPingerEnabled = enabled; }
 
+    /**
+     * Pings the config servers on behalf of every process id (see getDistLockProcess() and
+     * getDistLockId()) of this process that has taken a lock on them. There is one ping thread
+     * per config server connection, and it refreshes the entries of all its process ids in
+     * the lockpings collection with a single update.
+     */
     class DistributedLockPinger {
     public:
 
@@ -87,22 +123,53 @@ namespace mongo {
             : _mutex( "DistributedLockPinger" ) {
         }
 
-        void _distLockPingThread( ConnectionString addr,
-                                  const std::string& process,
-                                  unsigned long long sleepTime ) {
+        /**
+         * @return the process ids to ping on 'addr', stopping the ping thread if there are
+         * none left
+         */
+        set<string> _processesToPing( const ConnectionString& addr ) {
+            scoped_lock lk( _mutex );
 
-            setThreadName( "LockPinger" );
+            map< string, set<string> >::iterator i = _processes.find( addr.toString() );
+            verify( i != _processes.end() );
+
+            if ( i->second.empty() || inShutdown() ) {
+                _processes.erase( i );
+                _sleepTimes.erase( addr.toString() );
+                return set<string>();
+            }
+
+            return i->second;
+        }
+
+        unsigned long long _sleepTime( const ConnectionString& addr ) {
+            scoped_lock lk( _mutex );
+            map<string, unsigned long long>::iterator i = _sleepTimes.find( addr.toString() );
+            return i == _sleepTimes.end() ? 0 : i->second;
+        }
 
-            string pingId = pingThreadId( addr, process );
+        void _distLockPingThread( ConnectionString addr ) {
+
+            setThreadName( "LockPinger" );
 
             LOG( DistributedLock::logLvl - 1 ) << "creating distributed lock ping thread for " << addr
-                                               << " and process " << process
-                                               << " (sleeping for " << sleepTime << "ms)" << endl;
+                                               << " (sleeping for " << _sleepTime( addr ) << "ms)" << endl;
+
+            // process ids whose entries are known to exist in the lockpings collection
+            set<string> inserted;
 
             static int loops = 0;
-            while( ! inShutdown() && ! shouldKill( addr, process ) ) {
+            while( true ) {
+
+                set<string> processes = _processesToPing( addr );
+                if ( processes.empty() )
+                    break;
 
-                LOG( DistributedLock::logLvl + 2 ) << "distributed lock pinger '" << pingId << "' about to ping." << endl;
+                unsigned long long sleepTime = _sleepTime( addr );
+
+                LOG( DistributedLock::logLvl + 2 ) << "distributed lock pinger for " << addr
+                                                   << " about to ping " << processes.size()
+                                                   << " process(es)." << endl;
 
                 Date_t pingTime;
 
@@ -111,22 +178,53 @@ namespace mongo {
 
                     pingTime = jsTime();
 
-                    // refresh the entry corresponding to this process in the lockpings collection
-                    conn->update( LockpingsType::ConfigNS,
-                                  BSON( LockpingsType::process(process) ),
-                                  BSON( "$set" << BSON( LockpingsType::ping(pingTime) ) ),
-                                  true );
+                    // refresh the entries corresponding to these processes in the lockpings
+                    // collection, inserting those of processes that are new, then updating the
+                    // rest together
+                    vector<string> known;
+                    string err;
+                    for ( set<string>::const_iterator i = processes.begin(); i != processes.end(); ++i ) {
+                        if ( inserted.count( *i ) ) {
+                            known.push_back( *i );
+                            continue;
+                        }
+
+                        conn->update( LockpingsType::ConfigNS,
+                                      BSON( LockpingsType::process(*i) ),
+                                      BSON( "$set" << BSON( LockpingsType::ping(pingTime) ) ),
+                                      true );
+
+                        err = conn->getLastError();
+                        if ( ! err.empty() )
+                            break;
+                        inserted.insert( *i );
+                    }
+
+                    if ( err.empty() && ! known.empty() ) {
+                        conn->update( LockpingsType::ConfigNS,
+                                      BSON( LockpingsType::process() << BSON( "$in" << known ) ),
+                                      BSON( "$set" << BSON( LockpingsType::ping(pingTime) ) ),
+                                      false, true );
+
+                        BSONObj gle = conn->getLastErrorDetailed();
+                        err = DBClientWithCommands::getLastErrorString( gle );
+                        if ( err.empty() && gle["n"].numberInt() < (int)known.size() ) {
+                            // someone removed entries of ours, insert them again next time
+                            inserted.clear();
+                        }
+                    }
 
-                    string err = conn->getLastError();
                     if ( ! err.empty() ) {
-                        warning() << "pinging failed for distributed lock pinger '" << pingId << "'."
+                        warning() << "pinging failed for distributed lock pinger for " << addr << "."
                                   << causedBy( err ) << endl;
+                        inserted.clear();
                         conn.done();
 
                         // Sleep for normal ping time
                         sleepmillis(sleepTime);
                         continue;
                     }
+                    pingRounds.increment();
 
                     // remove really old entries from the lockpings collection if they're not holding a lock
                     // (this may happen if an instance of a process was taken down and no new instance came up to
@@ -150,7 +248,7 @@ namespace mongo {
                                         LockpingsType::ping() << LT << fourDays ) );
                     err = conn->getLastError();
                     if ( ! err.empty() ) {
-                        warning() << "ping cleanup for distributed lock pinger '" << pingId << " failed."
+                        warning() << "ping cleanup for distributed lock pinger for " << addr << " failed."
                                   << causedBy( err ) << endl;
                         conn.done();
 
@@ -165,8 +263,8 @@ namespace mongo {
                     }
 
                     LOG( DistributedLock::logLvl - ( loops % 10 == 0 ? 1 : 0 ) ) << "cluster " << addr << " pinged successfully at " << pingTime
-                            << " by distributed lock pinger '" << pingId
-                            << "', sleeping for " << sleepTime << "ms" << endl;
+                            << " for " << processes.size() << " process(es)"
+                            << ", sleeping for " << sleepTime << "ms" << endl;
 
                     // Remove old locks, if possible
                     // Make sure no one else is adding to this list at the same time
@@ -174,7 +272,7 @@ namespace mongo {
 
                     int numOldLocks = _oldLockOIDs.size();
                     if( numOldLocks > 0 )
-                        LOG( DistributedLock::logLvl - 1 ) << "trying to delete " << _oldLockOIDs.size() << " old lock entries for process " << process << endl;
+                        LOG( DistributedLock::logLvl - 1 ) << "trying to delete " << _oldLockOIDs.size() << " old lock entries on " << addr << endl;
 
                     bool removed = false;
                     for( list<OID>::iterator i = _oldLockOIDs.begin(); i != _oldLockOIDs.end();
@@ -203,41 +301,34 @@ namespace mongo {
                     }
 
                     if( numOldLocks > 0 && _oldLockOIDs.size() > 0 ){
-                        LOG( DistributedLock::logLvl - 1 ) << "not all old lock entries could be removed for process " << process << endl;
+                        LOG( DistributedLock::logLvl - 1 ) << "not all old lock entries could be removed on " << addr << endl;
                     }
 
                     conn.done();
 
                 }
                 catch ( std::exception& e ) {
-                    warning() << "distributed lock pinger '" << pingId << "' detected an exception while pinging."
+                    warning() << "distributed lock pinger for " << addr << " detected an exception while pinging."
                               << causedBy( e ) << endl;
+                    inserted.clear();
                 }
 
                 sleepmillis(sleepTime);
             }
 
-            warning() << "removing distributed lock ping thread '" << pingId << "'" << endl;
-
-
-            if( shouldKill( addr, process ) )
-                finishKill( addr, process );
-
+            warning() << "removing distributed lock ping thread for " << addr << endl;
         }
 
-        void distLockPingThread( ConnectionString addr,
-                                 long long clockSkew,
-                                 const std::string& processId,
-                                 unsigned long long sleepTime ) {
+        void distLockPingThread( ConnectionString addr, long long clockSkew ) {
             try {
                 jsTimeVirtualThreadSkew( clockSkew );
-                _distLockPingThread( addr, processId, sleepTime );
+                _distLockPingThread( addr );
             }
             catch ( std::exception& e ) {
-                error() << "unexpected error while running distributed lock pinger for " << addr << ", process " << processId << causedBy( e ) << endl;
+                error() << "unexpected error while running distributed lock pinger for " << addr << causedBy( e ) << endl;
             }
             catch ( ... ) {
-                error() << "unknown error while running distributed lock pinger for " << addr << ", process " << processId << endl;
+                error() << "unknown error while running distributed lock pinger for " << addr << endl;
             }
         }
 
@@ -256,20 +347,34 @@ namespace mongo {
             const string& processId = lock.getProcessId();
             string s = pingThreadId( conn, processId );
 
-            // Ignore if we already have a pinging thread for this process.
+            // Ignore if we are already pinging for this process.
             if ( _seen.count( s ) > 0 ) return s;
 
-            // Check our clock skew
-            try {
-                if( lock.isRemoteTimeSkewed() ) {
-                    throw LockException( str::stream() << "clock skew of the cluster " << conn.toString() << " is too far out of bounds to allow distributed locking." , 13650 );
+            // Check our clock skew, which only matters between several config servers
+            if ( conn.type() == ConnectionString::SYNC ) {
+                try {
+                    if( lock.isRemoteTimeSkewed() ) {
+                        throw LockException( str::stream() << "clock skew of the cluster " << conn.toString() << " is too far out of bounds to allow distributed locking." , 13650 );
+                    }
+                }
+                catch( LockException& e) {
+                    throw LockException( str::stream() << "error checking clock skew of cluster " << conn.toString() << causedBy( e ) , 13651);
                 }
-            }
-            catch( LockException& e) {
-                throw LockException( str::stream() << "error checking clock skew of cluster " << conn.toString() << causedBy( e ) , 13651);
             }
 
-            boost::thread t( boost::bind( &DistributedLockPinger::distLockPingThread, this, conn, getJSTimeVirtualThreadSkew(), processId, sleepTime) );
+            // ping as often as the lock with the shortest ping interval needs
+            unsigned long long& connSleepTime = _sleepTimes[ conn.toString() ];
+            if ( connSleepTime == 0 || sleepTime < connSleepTime )
+                connSleepTime = sleepTime;
+
+            map< string, set<string> >::iterator i = _processes.find( conn.toString() );
+            if ( i == _processes.end() ) {
+                _processes[ conn.toString() ].insert( processId );
+                boost::thread t( boost::bind( &DistributedLockPinger::distLockPingThread, this, conn, getJSTimeVirtualThreadSkew() ) );
+            }
+            else {
+                i->second.insert( processId );
+            }
 
             _seen.insert( s );
 
@@ -294,29 +399,19 @@ namespace mongo {
             string pingId = pingThreadId( conn, processId );
 
             verify( _seen.count( pingId ) > 0 );
-            _kill.insert( pingId );
-
-        }
-
-        bool shouldKill( const ConnectionString& conn, const string& processId ) {
-            return _kill.count( pingThreadId( conn, processId ) ) > 0;
-        }
-
-        void finishKill( const ConnectionString& conn, const string& processId ) {
-            // Make sure we're in a consistent state before other threads can see us
-            scoped_lock lk( _mutex );
-
-            string pingId = pingThreadId( conn, processId );
-
-            _kill.erase( pingId );
             _seen.erase( pingId );
 
+            // the ping thread stops once it has no process left to ping
+            map< string, set<string> >::iterator i = _processes.find( conn.toString() );
+            if ( i != _processes.end() )
+                i->second.erase( processId );
         }
 
-        static bool _pingerEnabled;
-
-        set<string> _kill;
+        // "<connection>/<process id>" of each process pinged
         set<string> _seen;
+        // process ids pinged by each connection's ping thread, by connection
+        map< string, set<string> > _processes;
+        map< string, unsigned long long > _sleepTimes;
         mongo::mutex _mutex;
         list<OID> _oldLockOIDs;
 
@@ -538,6 +633,80 @@ namespace mongo {
     // Note:  reenter doesn't actually make this lock re-entrant in the normal sense, since it can still only
     // be unlocked once, instead it is used to verify that the lock is already held.
     bool DistributedLock::lock_try( const string& why , bool reenter, BSONObj * other, double timeout ) {
+        Timer timer;
+        bool gotLock = _lockTry( why, reenter, other, timeout );
+        lockTryStats.record( timer );
+
+        if ( gotLock )
+            locksAcquired.increment();
+        else
+            locksContended.increment();
+
+        return gotLock;
+    }
+
+    bool DistributedLock::_singleConfigServer() const {
+        return _conn.getServers().size() == 1;
+    }
+
+    bool DistributedLock::_lockDirectly( const string& why, BSONObj* other, double timeout ) {
+        // Only taken with one config server, where _conn is a plain MASTER connection. With
+        // three config servers the full protocol goes through a SyncClusterConnection, which
+        // checks every server before a write and fsyncs the write on all of them, so the lock
+        // survives losing one config server. Here the lock lives on the one server only.
+        ScopedDbConnection conn( _conn.getServers()[0].toString(), timeout );
+
+        BSONObj lockDetails = BSON( LocksType::state(2)
+                << LocksType::who(getDistLockId())
+                << LocksType::process(_processId)
+                << "when" << jsTime()
+                << LocksType::why(why)
+                << LocksType::lockID(OID::gen()) );
+
+        // Creates the lock document if there is none yet. If the lock is held the upsert fails
+        // on the duplicate _id and we leave it to the full protocol to decide whether it can be
+        // forced.
+        BSONObj cmd = BSON( "findAndModify" << NamespaceString( LocksType::ConfigNS ).coll
+                         << "query" << BSON( LocksType::name(_name) << LocksType::state(0) )
+                         << "update" << BSON( "$set" << lockDetails )
+                         << "upsert" << true
+                         << "new" << true );
+
+        BSONObj res;
+        bool ok = conn->runCommand( nsToDatabase( LocksType::ConfigNS ), cmd, res );
+
+        if ( ! ok || ! res["value"].isABSONObj() ) {
+            LOG( logLvl ) << "could not take free distributed lock " << _name << " directly: "
+                          << res << endl;
+            conn.done();
+            return false;
+        }
+
+        BSONObj lockObj = res["value"].Obj().getOwned();
+
+        // fsync the lock on this server, as a SyncClusterConnection does on each config server
+        BSONObj err = conn->getLastErrorDetailed( true );
+        string errMsg = DBClientWithCommands::getLastErrorString( err );
+        if ( ! errMsg.empty() ) {
+            conn.done();
+            // Register the lock for deletion, we cannot be sure it will survive
+            distLockPinger.addUnlockOID( lockObj[LocksType::lockID()].OID() );
+            throw LockException( str::stream() << "could not make distributed lock " << _name
+                                 << " durable" << causedBy( errMsg ), 16826 );
+        }
+
+        conn.done();
+
+        // There was no lock to force, so forget about the last one seen
+        resetLastPing();
+
+        *other = lockObj;
+        LOG( logLvl - 1 ) << "distributed lock '" << _name << "/" << _processId
+                          << "' acquired directly, ts : " << lockObj[LocksType::lockID()].OID() << endl;
+        return true;
+    }
+
+    bool DistributedLock::_lockTry( const string& why , bool reenter, BSONObj * other, double timeout ) {
 
         // TODO:  Start pinging only when we actually get the lock?
         // If we don't have a thread pinger, make sure we shouldn't have one
@@ -559,6 +728,16 @@ namespace mongo {
         if ( other == NULL )
             other = &dummyOther;
 
+        // A single config server changes the lock document atomically, so a free lock can be
+        // taken with one update and the state 1 / state 2 protocol below is only needed to
+        // force a lock or to keep several config servers consistent
+        if ( ! reenter && _singleConfigServer() ) {
+            if ( _lockDirectly( why, other, timeout ) ) {
+                locksAcquiredDirectly.increment();
+                return true;
+            }
+        }
+
         ScopedDbConnection conn(_conn.toString(), timeout );
 
         BSONObjBuilder queryBuilder;
@@ -1132,6 +1311,8 @@ namespace mongo {
             sleepmillis(std::min(_lockTryIntervalMillis, timeRemainingMillis));
         }
 
+        lockWaitStats.record( timer );
+
         if (_acquired) {
             verify(!_other.isEmpty());
             return true;
@@ -63,6 +63,11 @@ namespace mongo {
      *
      * To be maintained, each taken lock needs to be revalidated ("pinged") within a pre-established amount of time. This
      * class does this maintenance automatically once a DistributedLock object was constructed.
+     *
+     * With a single config server a free lock is taken with one findAndModify. With three config
+     * servers every lock goes through the state 1 / state 2 protocol over a SyncClusterConnection,
+     * and only the pings are batched. In both cases a held lock can only be forced once its
+     * holder's ping is older than the lock timeout; there is no shorter lease.
      */
     class DistributedLock {
     public:
@@ -184,6 +189,17 @@ namespace mongo {
         void setLastPing( const PingData& pd ){ lastPings.setLastPing( _conn, _name, pd ); }
         PingData getLastPing(){ return lastPings.getLastPing( _conn, _name ); }
 
+        bool _lockTry( const string& why, bool reenter, BSONObj* other, double timeout );
+
+        /** @return true if the lock is kept on a single config server */
+        bool _singleConfigServer() const;
+
+        /**
+         * Takes the lock if it is free with a single findAndModify on the only config server.
+         * @return false if the lock is held, in which case it may still be forced
+         */
+        bool _lockDirectly( const string& why, BSONObj* other, double timeout );
+
         // May or may not exist, depending on startup
         mongo::mutex _mutex;
         string _threadId;
@@ -18,10 +18,13 @@
 
 #include "pch.h"
 
+#include "mongo/base/counter.h"
 #include "mongo/client/connpool.h"
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/client/parallel.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/dbmessage.h"
+#include "mongo/db/stats/timer_stats.h"
 #include "mongo/s/chunk.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/config.h"
@@ -33,6 +36,22 @@ namespace mongo {
 
     LabeledLevel pc( "pcursor", 2 );
 
+    // The getMores merged cursors sent to shards after the first batch, and the time spent
+    // waiting for them
+    static TimerStats shardGetMoreStats;
+    static ServerStatusMetricField<TimerStats> displayShardGetMores( "cursor.shardGetMore.wait",
+                                                                    &shardGetMoreStats );
+    // How many of those batches were prefetched while the previous one was being merged
+    static Counter64 shardGetMorePrefetched;
+    static ServerStatusMetricField<Counter64> displayShardGetMorePrefetched(
+                                                    "cursor.shardGetMore.prefetched",
+                                                    &shardGetMorePrefetched );
+    // How many prefetch connections were given back early because their cursor sat idle
+    static Counter64 shardGetMorePrefetchReleased;
+    static ServerStatusMetricField<Counter64> displayShardGetMorePrefetchReleased(
+                                                    "cursor.shardGetMore.prefetchReleased",
+                                                    &shardGetMorePrefetchReleased );
+
     // --------  ClusteredCursor -----------
 
     ClusteredCursor::ClusteredCursor( const QuerySpec& q ) {
@@ -611,6 +630,9 @@ namespace mongo {
 
         stateB.append( "count", count );
         stateB.append( "done", done );
+        stateB.append( "batches", batches );
+        stateB.append( "prefetchedBatches", prefetchedBatches );
+        stateB.append( "waitMillis", waitMicros / 1000 );
 
         return stateB.obj().getOwned();
     }
@@ -735,7 +757,19 @@ namespace mongo {
                 /* TODO: Undo SERVER-5797. This try-catch is a temporary hack until
                  * secondaries can properly handle shard versioning
                  */
-                if ( state->conn->setVersion() ) {
+                if ( manager && ShardConnection::shardVersionAsRequestMetadata &&
+                        _staleNSMap.find( ns ) == _staleNSMap.end() &&
+                        versionManager.isVersionableCB( state->conn->getRawConn() ) ) {
+                    // The version goes out with the query, so the shard checks it against
+                    // its own without a setShardVersion round trip first. Once the namespace
+                    // was found stale, retries set it explicitly instead, since a shard
+                    // refuses a request version until a setShardVersion initializes it.
+                    state->versionMetadata =
+                            versionManager.requestShardVersionCB( state->conn.get(), shard );
+                    LOG( pc ) << "sending remote version with query as "
+                              << state->versionMetadata << endl;
+                }
+                else if ( state->conn->setVersion() ) {
                     // It's actually okay if we set the version here, since either the
                     // manager will be verified as compatible, or if the manager doesn't
                     // exist, we don't care about version consistency
@@ -900,11 +934,16 @@ namespace mongo {
                 // Setup cursor
                 if( ! state->cursor ){
 
+                    BSONObj query = state->versionMetadata.isEmpty() ? _qSpec.query() :
+                            VersionManager::attachShardVersion( _qSpec.query(),
+                                                                state->versionMetadata,
+                                                                isCommand() );
+
                     // Do a sharded query if this is not a primary shard *and* this is a versioned query,
                     // or if the number of shards to query is > 1
                     if( ( isVersioned() && ! primary ) || _qShards.size() > 1 ){
 
-                        state->cursor.reset( new DBClientCursor( state->conn->get(), ns, _qSpec.query(),
+                        state->cursor.reset( new DBClientCursor( state->conn->get(), ns, query,
                                                                  isCommand() ? 1 : 0, // nToReturn (0 if query indicates multi)
                                                                  0, // nToSkip
                                                                  // Does this need to be a ptr?
@@ -927,7 +966,7 @@ namespace mongo {
                     else{
 
                         // Non-sharded
-                        state->cursor.reset( new DBClientCursor( state->conn->get(), ns, _qSpec.query(),
+                        state->cursor.reset( new DBClientCursor( state->conn->get(), ns, query,
                                                                  _qSpec.ntoreturn(), // nToReturn
                                                                  _qSpec.ntoskip(), // nToSkip
                                                                  // Does this need to be a ptr?
@@ -1596,12 +1635,62 @@ namespace mongo {
         }
 
         for ( int i=0; i<_numServers; i++ ) {
-            if ( _cursors[i].more() )
+            if ( _cursorMore( i ) )
                 return true;
         }
         return false;
     }
 
+    bool ParallelSortClusteredCursor::_cursorMore( int i ) {
+        DBClientCursor* raw = _cursors[i].raw();
+        if ( ! raw || raw->moreInCurrentBatch() )
+            return _cursors[i].more();
+
+        // may block on the network, unless the next batch was prefetched and has arrived
+        bool prefetched = raw->prefetchPending();
+        Message* lastBatch = raw->getMessage();
+        Timer t;
+        bool more = _cursors[i].more();
+
+        if ( raw->getMessage() == lastBatch )
+            return more;
+
+        long long micros = t.micros();
+        shardGetMoreStats.recordMillis( micros / 1000 );
+        if ( prefetched )
+            shardGetMorePrefetched.increment();
+
+        if ( _cursors[i].rawMData() ) {
+            PCStatePtr state = _cursors[i].rawMData()->pcState;
+            state->batches++;
+            if ( prefetched ) state->prefetchedBatches++;
+            state->waitMicros += micros;
+        }
+        return more;
+    }
+
+    void ParallelSortClusteredCursor::_prefetch( int i ) {
+        DBClientCursor* raw = _cursors[i].raw();
+        if ( ! raw || raw->prefetchPending() )
+            return;
+
+        try {
+            raw->prefetchMore();
+        }
+        catch ( DBException& e ) {
+            // the getMore is retried without prefetching when the batch runs out
+            LOG(1) << "could not prefetch from " << raw->originalHost() << causedBy( e ) << endl;
+        }
+    }
+
+    void ParallelSortClusteredCursor::releasePrefetchConnections( double timeoutSecs ) {
+        for ( int i = 0; i < _numServers; i++ ) {
+            DBClientCursor* raw = _cursors[i].raw();
+            if ( raw && raw->releasePrefetchConnection( timeoutSecs ) )
+                shardGetMorePrefetchReleased.increment();
+        }
+    }
+
     BSONObj ParallelSortClusteredCursor::next() {
         BSONObj best = BSONObj();
         int bestFrom = -1;
@@ -1613,7 +1702,7 @@ namespace mongo {
 
             int i = ( j + _lastFrom + 1 ) % _numServers;
 
-            if ( ! _cursors[i].more() ){
+            if ( ! _cursorMore( i ) ){
                 if( _cursors[i].rawMData() )
                     _cursors[i].rawMData()->pcState->done = true;
                 continue;
@@ -1644,6 +1733,10 @@ namespace mongo {
         if( _cursors[bestFrom].rawMData() )
             _cursors[bestFrom].rawMData()->pcState->count++;
 
+        // Keep a getMore in flight on every server we merge from, so a server whose batch runs
+        // out has usually answered already instead of each getMore waiting on the one before.
+        _prefetch( bestFrom );
+
         return best;
     }
 
@@ -90,6 +90,13 @@ namespace mongo {
 
         virtual void explain(BSONObjBuilder& b) = 0;
 
+        /**
+         * gives back any pooled connection held for prefetching, before the cursor sits idle
+         * @param timeoutSecs if > 0, bounds the wait for each prefetched reply, see
+         *        DBClientCursor::releasePrefetchConnection()
+         */
+        virtual void releasePrefetchConnections( double timeoutSecs = 0 ) {}
+
     protected:
 
         virtual void _init() = 0;
@@ -266,7 +273,7 @@ namespace mongo {
     public:
 
         ParallelConnectionState() :
-            count( 0 ), done( false ) { }
+            count( 0 ), done( false ), batches( 0 ), prefetchedBatches( 0 ), waitMicros( 0 ) { }
 
         ShardConnectionPtr conn;
         DBClientCursorPtr cursor;
@@ -275,10 +282,19 @@ namespace mongo {
         ChunkManagerPtr manager;
         ShardPtr primary;
 
+        // The shard version sent with the query instead of set on the connection, if any
+        BSONObj versionMetadata;
+
         // Cursor status information
         long long count;
         bool done;
 
+        // getMore statistics: batches received after the first, how many of them were
+        // prefetched, and the time spent blocked waiting for them
+        long long batches;
+        long long prefetchedBatches;
+        long long waitMicros;
+
         BSONObj toBSON() const;
 
         string toString() const {
@@ -343,6 +359,7 @@ namespace mongo {
         virtual bool more();
         virtual BSONObj next();
         virtual string type() const { return "ParallelSort"; }
+        virtual void releasePrefetchConnections( double timeoutSecs = 0 );
 
         void fullInit();
         void startInit();
@@ -393,6 +410,12 @@ namespace mongo {
         int _needToSkip;
 
     private:
+        /** more() on the cursor of server 'i', recording how long a getMore blocked */
+        bool _cursorMore( int i );
+
+        /** start fetching the next batch of server 'i' while the merge consumes the current one */
+        void _prefetch( int i );
+
         /**
          * Setups the shard version of the connection. When using a replica
          * set connection and the primary cannot be reached, the version
@@ -73,55 +73,97 @@ namespace mongo {
         _conns.clear();
     }
 
+    Counter64 SyncClusterConnection::prepareCount;
+    Counter64 SyncClusterConnection::prepareMillis;
+    Counter64 SyncClusterConnection::commitCount;
+    Counter64 SyncClusterConnection::commitMillis;
+
     bool SyncClusterConnection::prepare( string& errmsg ) {
         _lastErrors.clear();
-        return fsync( errmsg );
+        _commitTimer.reset();
+
+        // Only checks that every server is up: the write is fsynced with its getlasterror, so
+        // the one fsync of each write is the one in _checkLast()
+        bool ok = _commandOnAll( BSON( "ping" << 1 ), "prepare", errmsg );
+
+        prepareCount.increment();
+        prepareMillis.increment( _commitTimer.millis() );
+        return ok;
     }
 
     bool SyncClusterConnection::fsync( string& errmsg ) {
+        return _commandOnAll( BSON( "fsync" << 1 ), "fsync", errmsg );
+    }
+
+    bool SyncClusterConnection::_commandOnAll( const BSONObj& cmd, const string& what, string& errmsg ) {
+        vector<BSONObj> results;
+        vector<string> errors;
+        _commandOnAll( cmd, &results, &errors );
+
         bool ok = true;
         errmsg = "";
         for ( size_t i=0; i<_conns.size(); i++ ) {
-            BSONObj res;
-            try {
-                if ( _conns[i]->simpleCommand( "admin" , &res , "fsync" ) )
-                    continue;
-            }
-            catch ( DBException& e ) {
-                errmsg += e.toString();
-            }
-            catch ( std::exception& e ) {
-                errmsg += e.what();
-            }
-            catch ( ... ) {
-                warning() << "unknown exception in SyncClusterConnection::fsync" << endl;
-            }
+            if ( errors[i].empty() && isOk( results[i] ) )
+                continue;
             ok = false;
-            errmsg += " " + _conns[i]->toString() + ":" + res.toString();
+            errmsg += errors[i] + " " + _conns[i]->toString() + ":" + results[i].toString();
         }
+
+        if ( ! ok )
+            LOG(1) << "SyncClusterConnection " << what << " failed: " << errmsg << endl;
         return ok;
     }
 
-    void SyncClusterConnection::_checkLast() {
-        _lastErrors.clear();
-        vector<string> errors;
+    void SyncClusterConnection::_commandOnAll( const BSONObj& cmd,
+                                               vector<BSONObj>* results,
+                                               vector<string>* errors ) {
+        results->assign( _conns.size(), BSONObj() );
+        errors->assign( _conns.size(), "" );
 
+        // Send the command to every server before reading any reply, so the servers run it
+        // at the same time and the whole round takes as long as the slowest server
+        vector< shared_ptr<DBClientCursor> > cursors( _conns.size() );
         for ( size_t i=0; i<_conns.size(); i++ ) {
-            BSONObj res;
-            string err;
             try {
-                if ( ! _conns[i]->runCommand( "admin" , BSON( "getlasterror" << 1 << "fsync" << 1 ) , res ) )
-                    err = "cmd failed: ";
+                cursors[i].reset( new DBClientCursor( _conns[i], "admin.$cmd", cmd, -1, 0, 0, 0, 0 ) );
+                cursors[i]->initLazy();
             }
             catch ( std::exception& e ) {
-                err += e.what();
+                (*errors)[i] = e.what();
+                cursors[i].reset();
+            }
+        }
+
+        for ( size_t i=0; i<_conns.size(); i++ ) {
+            if ( ! cursors[i] )
+                continue;
+            try {
+                bool retry = false;
+                if ( ! cursors[i]->initLazyFinish( retry ) || ! cursors[i]->more() ) {
+                    (*errors)[i] = "cmd failed: no reply";
+                    continue;
+                }
+                (*results)[i] = cursors[i]->nextSafe().getOwned();
+                if ( ! isOk( (*results)[i] ) )
+                    (*errors)[i] = "cmd failed: ";
+            }
+            catch ( std::exception& e ) {
+                (*errors)[i] = e.what();
             }
             catch ( ... ) {
-                err += "unknown failure";
+                (*errors)[i] = "unknown failure";
             }
-            _lastErrors.push_back( res.getOwned() );
-            errors.push_back( err );
         }
+    }
+
+    void SyncClusterConnection::_checkLast() {
+        _lastErrors.clear();
+        vector<string> errors;
+
+        _commandOnAll( BSON( "getlasterror" << 1 << "fsync" << 1 ), &_lastErrors, &errors );
+
+        commitCount.increment();
+        commitMillis.increment( _commitTimer.millis() );
 
         verify( _lastErrors.size() == errors.size() && _lastErrors.size() == _conns.size() );
 
@@ -351,12 +393,10 @@ namespace mongo {
             throw UserException( 16744, assertMsg + errmsg );
         }
 
-        // We still want one getlasterror per document, even if they're batched.
+        // Send the batch as one message to each server. Every document is still attempted
+        // even if an earlier one fails, as if they had been inserted one by one.
         for ( size_t i=0; i<_conns.size(); i++ ) {
-            for ( vector<BSONObj>::const_iterator it = v.begin(); it != v.end(); ++it ) {
-                _conns[i]->insert( ns, *it, flags );
-                _conns[i]->getLastErrorDetailed();
-            }
+            _conns[i]->insert( ns, v, flags | InsertOption_ContinueOnError );
         }
 
         // We issue a final getlasterror, but this time with an fsync.
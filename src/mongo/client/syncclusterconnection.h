@@ -19,9 +19,11 @@
 #pragma once
 
 
+#include "mongo/base/counter.h"
 #include "mongo/bson/bsonelement.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/client/dbclientinterface.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -29,10 +31,11 @@ namespace mongo {
      * This is a connection to a cluster of servers that operate as one
      * for super high durability.
      *
-     * Write operations are two-phase.  First, all nodes are asked to fsync. If successful
-     * everywhere, the write is sent everywhere and then followed by an fsync.  There is no
-     * rollback if a problem occurs during the second phase.  Naturally, with all these fsyncs,
-     * these operations will be quite slow -- use sparingly.
+     * Write operations are two-phase.  First, all nodes are checked to be up. If they are,
+     * the write is sent everywhere and then followed by an fsync.  There is no rollback if a
+     * problem occurs during the second phase.  Each phase is sent to all nodes before any reply
+     * is read, so it takes as long as the slowest node rather than the sum of them, but with
+     * the fsyncs these operations are still slow -- use sparingly.
      *
      * Read operations are sent to a single random node.
      *
@@ -58,6 +61,7 @@ namespace mongo {
         ~SyncClusterConnection();
 
         /**
+         * Starts a write.
          * @return true if all servers are up and ready for writes
          */
         bool prepare( string& errmsg );
@@ -111,6 +115,13 @@ namespace mongo {
 
         virtual bool lazySupported() const { return false; }
 
+        // Number and total time of prepare phases, and of whole writes from the start of the
+        // prepare phase to the end of the getlasterror/fsync that commits the write
+        static Counter64 prepareCount;
+        static Counter64 prepareMillis;
+        static Counter64 commitCount;
+        static Counter64 commitMillis;
+
     protected:
         virtual void _auth(const BSONObj& params);
 
@@ -122,6 +133,15 @@ namespace mongo {
                                                 const BSONObj *fieldsToReturn, int queryOptions, int batchSize );
         int _lockType( const string& name );
         void _checkLast();
+
+        /**
+         * Runs 'cmd' on every server at the same time.
+         * @param errors empty for servers where the command worked
+         */
+        void _commandOnAll( const BSONObj& cmd, vector<BSONObj>* results, vector<string>* errors );
+
+        /** @return true if 'cmd' worked on every server, otherwise what failed in 'errmsg' */
+        bool _commandOnAll( const BSONObj& cmd, const string& what, string& errmsg );
         void _connect( const std::string& host );
 
         string _address;
@@ -133,6 +153,9 @@ namespace mongo {
         vector<BSONObj> _lastErrors;
 
         double _socketTimeout;
+
+        // started by prepare()
+        Timer _commitTimer;
     };
 
     class UpdateNotTheSame : public UserException {
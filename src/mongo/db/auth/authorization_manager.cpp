@@ -225,6 +225,7 @@ namespace {
         internalActions.addAction(ActionType::replSetFresh);
         internalActions.addAction(ActionType::replSetGetRBID);
         internalActions.addAction(ActionType::replSetHeartbeat);
+        internalActions.addAction(ActionType::replSetUpdatePosition);
         internalActions.addAction(ActionType::writebacklisten);
         internalActions.addAction(ActionType::writeBacksQueued);
         internalActions.addAction(ActionType::_migrateClone);
@@ -27,6 +27,7 @@
 #include "mongo/db/index_update.h"
 #include "mongo/db/json.h"
 #include "mongo/db/pdfile.h"
+#include "mongo/db/repl/oplog_start_index.h"
 #include "mongo/scripting/engine.h"
 #include "mongo/util/hashtab.h"
 #include "mongo/util/mmap.h"
@@ -335,6 +336,9 @@ namespace mongo {
         DEV verify( this == nsdetails(ns) );
         verify( cappedLastDelRecLastExtent().isValid() );
 
+        // Sampled oplog positions may be reused by newer ops after truncation.
+        OplogStartIndex::get().invalidate( ns );
+
         // We iteratively remove the newest document until the newest document
         // is 'end', then we remove 'end' if requested.
         bool foundLast = false;
@@ -446,6 +450,7 @@ namespace mongo {
         // Clear all references to this namespace.
         ClientCursor::invalidate( ns );
         NamespaceDetailsTransient::resetCollection( ns );
+        OplogStartIndex::get().invalidate( ns );
 
         // Get a writeable reference to 'this' and reset all pertinent
         // attributes.
@@ -105,6 +105,10 @@ namespace mongo {
     static TimerStats gleWtimeStats;
     static ServerStatusMetricField<TimerStats> displayGleLatency( "getLastError.wtime", &gleWtimeStats );
 
+    static TimerHistogram gleWtimeHistogram;
+    static ServerStatusMetricField<TimerHistogram> displayGleLatencyHistogram( "getLastError.wtimeHistogram",
+                                                                               &gleWtimeHistogram );
+
     static Counter64 gleWtimeouts;
     static ServerStatusMetricField<Counter64> gleWtimeoutsDisplay( "getLastError.wtimeouts", &gleWtimeouts );
 
@@ -253,6 +257,7 @@ namespace mongo {
 
                     if ( timeout > 0 && timer.millis() >= timeout ) {
                         gleWtimeouts.increment();
+                        gleWtimeHistogram.recordMillis( timer.millis() );
                         result.append( "wtimeout" , true );
                         errmsg = "timed out waiting for slaves";
                         result.append( "waited" , timer.millis() );
@@ -263,12 +268,19 @@ namespace mongo {
 
                     verify( sprintf( buf , "w block pass: %lld" , ++passes ) < 30 );
                     c.curop()->setMessage( buf );
-                    sleepmillis(1);
+
+                    // wake up when a slave reaches op; the bound is only so that interrupts,
+                    // step downs and the timeout are noticed
+                    int waitMillis = 100;
+                    if ( timeout > 0 )
+                        waitMillis = std::max( 1, std::min( waitMillis, timeout - timer.millis() ) );
+                    awaitReplicationProgress( op, e, waitMillis );
                     killCurrentOp.checkForInterrupt();
                 }
 
                 result.append("writtenTo", getHostsWrittenTo(op));
                 int myMillis = timer.recordMillis();
+                gleWtimeHistogram.recordMillis( myMillis );
                 result.appendNumber( "wtime" , myMillis );
             }
 
@@ -24,8 +24,10 @@
 #include <boost/filesystem/operations.hpp>
 #include <fstream>
 
+#include "mongo/base/counter.h"
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/btreecursor.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/db.h"
 #include "mongo/db/json.h"
 #include "mongo/db/ops/delete.h"
@@ -36,12 +38,27 @@
 #include "mongo/db/query_runner.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/write_concern.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/d_logic.h"
 
 namespace mongo {
 
     const BSONObj reverseNaturalObj = BSON( "$natural" << -1 );
 
+    // Maximum number of documents removeRange deletes per acquisition of the write lock.
+    MONGO_EXPORT_SERVER_PARAMETER( removeRangeBatchSize, int, 64 );
+
+    // Limit on the rate at which removeRange deletes documents, 0 for no limit.
+    MONGO_EXPORT_SERVER_PARAMETER( removeRangeMaxBytesPerSec, int, 0 );
+
+    //The documents and bytes deleted by range deletion
+    static Counter64 removeRangeDocsDeleted;
+    static ServerStatusMetricField<Counter64> displayRemoveRangeDocs( "record.removeRange.docs",
+                                                                      &removeRangeDocsDeleted );
+    static Counter64 removeRangeBytesDeleted;
+    static ServerStatusMetricField<Counter64> displayRemoveRangeBytes( "record.removeRange.bytes",
+                                                                       &removeRangeBytesDeleted );
+
     void Helpers::ensureIndex(const char *ns, BSONObj keyPattern, bool unique, const char *name) {
         NamespaceDetails *d = nsdetails(ns);
         if( d == 0 )
@@ -251,87 +268,116 @@ namespace mongo {
         Client& c = cc();
 
         long long numDeleted = 0;
+        long long bytesDeleted = 0;
         PageFaultRetryableSection pgrs;
         
         long long millisWaitingForReplication = 0;
+        long long millisThrottled = 0;
+        bool done = false;
 
-        while ( 1 ) {
+        while ( ! done ) {
             try {
 
                 Client::WriteContext ctx(ns);
 
-                scoped_ptr<Cursor> c;
-                
-                {
-                    NamespaceDetails* nsd = nsdetails( ns );
-                    if ( ! nsd )
+                // Delete up to removeRangeBatchSize documents per acquisition of the write lock,
+                // giving the lock up early once the batch has held it for as long as a yield
+                // would allow.
+                const int batchSize = std::max( 1, removeRangeBatchSize );
+                const unsigned long long maxBatchMicros = Client::recommendedYieldMicros();
+                Timer batchTime;
+
+                for ( int batchDeleted = 0; batchDeleted < batchSize; batchDeleted++ ) {
+
+                    if ( batchDeleted > 0 && batchTime.micros() > maxBatchMicros )
                         break;
-                    
-                    const KeyPattern& keyPattern = chunk.keyPattern;
-
-                    int ii = nsd->findIndexByKeyPattern( keyPattern.toBSON() );
-                    verify( ii >= 0 );
-                    
-                    IndexDetails& i = nsd->idx( ii );
-
-                    // Extend min to get (min, MinKey, MinKey, ....)
-                    BSONObj newMin =
-                            Helpers::toKeyFormat( keyPattern.extendRangeBound( min, false ) );
-                    // If upper bound is included, extend max to get (max, MaxKey, MaxKey, ...)
-                    // If not included, extend max to get (max, MinKey, MinKey, ....)
-                    BSONObj newMax =
-                            Helpers::toKeyFormat( keyPattern.extendRangeBound(max, maxInclusive) );
-                    
-                    c.reset( BtreeCursor::make( nsd, i, newMin, newMax, maxInclusive, 1 ) );
-                }
-                
-                if ( ! c->ok() ) {
-                    // we're done
-                    break;
-                }
-                
-                DiskLoc rloc = c->currLoc();
-                BSONObj obj = c->current();
 
-                // this is so that we don't have to handle this cursor in the delete code
-                c.reset(0);
+                    scoped_ptr<Cursor> c;
 
-                if (fromMigrate && onlyRemoveOrphanedDocs) {
+                    {
+                        NamespaceDetails* nsd = nsdetails( ns );
+                        if ( ! nsd ) {
+                            done = true;
+                            break;
+                        }
 
-                    // Do a final check in the write lock to make absolutely sure that our
-                    // collection hasn't been modified in a way that invalidates our migration
-                    // cleanup.
+                        const KeyPattern& keyPattern = chunk.keyPattern;
 
-                    // We should never be able to turn off the sharding state once enabled, but
-                    // in the future we might want to.
-                    verify(shardingState.enabled());
+                        int ii = nsd->findIndexByKeyPattern( keyPattern.toBSON() );
+                        verify( ii >= 0 );
 
-                    // In write lock, so will be the most up-to-date version
-                    ShardChunkManagerPtr managerNow = shardingState.getShardChunkManager(ns);
+                        IndexDetails& i = nsd->idx( ii );
 
-                    if (!managerNow || managerNow->belongsToMe(obj)) {
+                        // Extend min to get (min, MinKey, MinKey, ....)
+                        BSONObj newMin =
+                                Helpers::toKeyFormat( keyPattern.extendRangeBound( min, false ) );
+                        // If upper bound is included, extend max to get (max, MaxKey, MaxKey, ...)
+                        // If not included, extend max to get (max, MinKey, MinKey, ....)
+                        BSONObj newMax = Helpers::toKeyFormat(
+                                keyPattern.extendRangeBound( max, maxInclusive ) );
 
-                        warning() << "aborting migration cleanup for chunk "
-                                  << min << " to " << max
-                                  << (managerNow ? (string)" at document " + obj.toString() : "")
-                                  << ", collection " << ns << " has changed " << endl;
+                        c.reset( BtreeCursor::make( nsd, i, newMin, newMax, maxInclusive, 1 ) );
+                    }
 
+                    if ( ! c->ok() ) {
+                        // we're done
+                        done = true;
                         break;
                     }
+
+                    DiskLoc rloc = c->currLoc();
+                    BSONObj obj = c->current();
+
+                    // this is so that we don't have to handle this cursor in the delete code
+                    c.reset(0);
+
+                    if (fromMigrate && onlyRemoveOrphanedDocs) {
+
+                        // Do a final check in the write lock to make absolutely sure that our
+                        // collection hasn't been modified in a way that invalidates our
+                        // migration cleanup.
+
+                        // We should never be able to turn off the sharding state once enabled,
+                        // but in the future we might want to.
+                        verify(shardingState.enabled());
+
+                        // In write lock, so will be the most up-to-date version
+                        ShardChunkManagerPtr managerNow = shardingState.getShardChunkManager(ns);
+
+                        if (!managerNow || managerNow->belongsToMe(obj)) {
+
+                            warning() << "aborting migration cleanup for chunk "
+                                      << min << " to " << max
+                                      << (managerNow ? (string)" at document " + obj.toString() : "")
+                                      << ", collection " << ns << " has changed " << endl;
+
+                            done = true;
+                            break;
+                        }
+                    }
+
+                    if ( callback )
+                        callback->goingToDelete( obj );
+
+                    int objSize = obj.objsize();
+                    logOp( "d" , ns.c_str() , rloc.obj()["_id"].wrap() , 0 , 0 , fromMigrate );
+                    theDataFileMgr.deleteRecord(ns.c_str() , rloc.rec(), rloc);
+                    numDeleted++;
+                    bytesDeleted += objSize;
+                    removeRangeDocsDeleted.increment();
+                    removeRangeBytesDeleted.increment( objSize );
                 }
-                
-                if ( callback )
-                    callback->goingToDelete( obj );
-                
-                logOp( "d" , ns.c_str() , rloc.obj()["_id"].wrap() , 0 , 0 , fromMigrate );
-                theDataFileMgr.deleteRecord(ns.c_str() , rloc.rec(), rloc);
-                numDeleted++;
             }
             catch( PageFaultException& e ) {
+                // documents deleted before the fault stay deleted, the batch restarts from the
+                // (new) start of the range once the page is in memory
                 e.touch();
                 continue;
             }
 
+            if ( done )
+                break;
+
             Timer secondaryThrottleTime;
 
             if ( secondaryThrottle && numDeleted > 0 ) {
@@ -343,9 +389,24 @@ namespace mongo {
             
             if ( ! Lock::isLocked() ) {
                 int micros = ( 2 * Client::recommendedYieldMicros() ) - secondaryThrottleTime.micros();
+                const int yieldMicros = micros;
+
+                // Stay within the bytes/sec budget: sleep until the bytes deleted so far would
+                // have been allowed at the configured rate.
+                const int maxBytesPerSec = removeRangeMaxBytesPerSec;
+                if ( maxBytesPerSec > 0 ) {
+                    long long budgetMicros = ( bytesDeleted * 1000 * 1000 ) / maxBytesPerSec;
+                    long long aheadMicros = budgetMicros - rangeRemoveTimer.micros();
+                    if ( aheadMicros > micros )
+                        micros = static_cast<int>( std::min( aheadMicros, 1000LL * 1000 ) );
+                }
+
                 if ( micros > 0 ) {
                     LOG(1) << "Helpers::removeRangeUnlocked going to sleep for " << micros << " micros" << endl;
                     sleepmicros( micros );
+
+                    // only the sleep beyond the usual yield is due to the bytes/sec budget
+                    millisThrottled += ( micros - std::max( yieldMicros, 0 ) ) / 1000;
                 }
             }
                 
@@ -356,7 +417,9 @@ namespace mongo {
                   << millisWaitingForReplication << "ms" << endl;
         
         LOG(1) << "end removal of " << min << " to " << max << " in " << ns
-               << " (took " << rangeRemoveTimer.millis() << "ms)" << endl;
+               << " (took " << rangeRemoveTimer.millis() << "ms, deleted " << numDeleted
+               << " documents, " << bytesDeleted << " bytes, throttled for "
+               << millisThrottled << "ms)" << endl;
 
         return numDeleted;
     }
@@ -250,6 +250,9 @@ namespace mongo {
         if ( !_ancillaryInfo._oldPlan.isEmpty() ) {
             bob.append( "oldPlan", _ancillaryInfo._oldPlan );
         }
+        if ( !_ancillaryInfo._oplogStart.isEmpty() ) {
+            bob.append( "oplogStart", _ancillaryInfo._oplogStart );
+        }
         bob.append( "server", server() );
         
         return bob.obj();
@@ -137,6 +137,8 @@ namespace mongo {
         /* Additional information describing the query. */
         struct AncillaryInfo {
             BSONObj _oldPlan;
+            /* Timing of the FindingStartCursor search for an oplogReplay query. */
+            BSONObj _oplogStart;
         };
         void setAncillaryInfo( const AncillaryInfo &ancillaryInfo );
         
@@ -369,6 +369,9 @@ namespace mongo {
         bool shouldLog = logLevel >= 1;
 
         if ( op == dbQuery ) {
+            ShardRequestVersionBlock requestVersion( m );
+            if ( requestVersion.handleRejected( m , &dbresponse ) )
+                return;
             if ( handlePossibleShardedMessage( m , &dbresponse ) )
                 return;
             receivedQuery(c , dbresponse, m );
@@ -739,7 +742,8 @@ namespace mongo {
         return ok;
     }
 
-    void checkAndInsert(const char *ns, /*modifies*/BSONObj& js) { 
+    /** checks and inserts js, without logging the insert */
+    static void checkAndInsertUnlogged(const char *ns, /*modifies*/BSONObj& js) {
         uassert( 10059 , "object to insert too large", js.objsize() <= BSONObjMaxUserSize);
         {
             // check no $ modifiers.  note we only check top level.  (scanning deep would be quite expensive)
@@ -758,23 +762,70 @@ namespace mongo {
                                         // operation might not support interrupts.
                                         cc().curop()->parent() == NULL,
                                         false);
+    }
+
+    void checkAndInsert(const char *ns, /*modifies*/BSONObj& js) { 
+        checkAndInsertUnlogged(ns, js);
         logOp("i", ns, js);
     }
 
+    // Inserted documents are logged in batches of up to this many bytes.  A batch is also logged
+    // as soon as a group commit is due, so a commit never holds an insert without its oplog entry.
+    // The batch refers to the documents in place, without copies.
+    static const int insertLogBatchBytes = 1024 * 1024;
+
     NOINLINE_DECL void insertMulti(bool keepGoing, const char *ns, vector<BSONObj>& objs, CurOp& op) {
+        vector<BSONObj> unlogged;
+        int unloggedBytes = 0;
+        // true once a document of 'unlogged' points into its record rather than the message
+        bool unloggedInRecords = false;
+        // a background index build yields the write lock, so nothing may be left unlogged
+        // while one runs: index inserts are logged one at a time
+        const bool logEachInsert = NamespaceString(ns).coll == "system.indexes";
         size_t i;
-        for (i=0; i<objs.size(); i++){
-            try {
-                checkAndInsert(ns, objs[i]);
-                getDur().commitIfNeeded();
-            } catch (const UserException&) {
-                if (!keepGoing || i == objs.size()-1){
-                    globalOpCounters.incInsertInWriteLock(i);
-                    throw;
+        try {
+            for (i=0; i<objs.size(); i++){
+                try {
+                    const char* received = objs[i].objdata();
+                    checkAndInsertUnlogged(ns, objs[i]);
+                    unlogged.push_back(objs[i]);
+                    unloggedBytes += objs[i].objsize();
+                    // objs[i] now points into its record if an _id was added
+                    if (objs[i].objdata() != received)
+                        unloggedInRecords = true;
+                } catch (const UserException&) {
+                    if (!keepGoing || i == objs.size()-1){
+                        logInsertBatch(ns, unlogged);
+                        globalOpCounters.incInsertInWriteLock(i);
+                        throw;
+                    }
+                    // otherwise ignore and keep going
+                }
+
+                // the next insert into a capped collection may overwrite a record that
+                // 'unlogged' points into, so the batch is logged before it
+                if (logEachInsert || unloggedBytes >= insertLogBatchBytes ||
+                        getDur().aCommitIsNeeded() ||
+                        (unloggedInRecords && nsdetails(ns)->isCapped())) {
+                    logInsertBatch(ns, unlogged);
+                    unlogged.clear();
+                    unloggedBytes = 0;
+                    unloggedInRecords = false;
                 }
-                // otherwise ignore and keep going
+                getDur().commitIfNeeded();
             }
         }
+        catch (const UserException&) {
+            throw;
+        }
+        catch (...) {
+            // anything inserted must still reach the oplog
+            logInsertBatch(ns, unlogged);
+            throw;
+        }
+
+        logInsertBatch(ns, unlogged);
+        getDur().commitIfNeeded();
 
         globalOpCounters.incInsertInWriteLock(i);
         op.debug().ninserted = i;
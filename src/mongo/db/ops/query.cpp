@@ -519,9 +519,10 @@ namespace mongo {
     QueryResponseBuilder *QueryResponseBuilder::make( const ParsedQuery &parsedQuery,
                                                      const shared_ptr<Cursor> &cursor,
                                                      const QueryPlanSummary &queryPlan,
-                                                     const BSONObj &oldPlan ) {
+                                                     const ExplainQueryInfo::AncillaryInfo &
+                                                     ancillaryInfo ) {
         auto_ptr<QueryResponseBuilder> ret( new QueryResponseBuilder( parsedQuery, cursor ) );
-        ret->init( queryPlan, oldPlan );
+        ret->init( queryPlan, ancillaryInfo );
         return ret.release();
     }
     
@@ -533,9 +534,10 @@ namespace mongo {
     _buf( 32768 ) { // TODO be smarter here
     }
     
-    void QueryResponseBuilder::init( const QueryPlanSummary &queryPlan, const BSONObj &oldPlan ) {
+    void QueryResponseBuilder::init( const QueryPlanSummary &queryPlan,
+                                     const ExplainQueryInfo::AncillaryInfo &ancillaryInfo ) {
         _chunkManager = newChunkManager();
-        _explain = newExplainRecordingStrategy( queryPlan, oldPlan );
+        _explain = newExplainRecordingStrategy( queryPlan, ancillaryInfo );
         _builder = newResponseBuildStrategy( queryPlan );
         _builder->resetBuf();
     }
@@ -605,12 +607,11 @@ namespace mongo {
     }
 
     shared_ptr<ExplainRecordingStrategy> QueryResponseBuilder::newExplainRecordingStrategy
-    ( const QueryPlanSummary &queryPlan, const BSONObj &oldPlan ) const {
+    ( const QueryPlanSummary &queryPlan,
+      const ExplainQueryInfo::AncillaryInfo &ancillaryInfo ) const {
         if ( !_parsedQuery.isExplain() ) {
             return shared_ptr<ExplainRecordingStrategy>( new NoExplainStrategy() );
         }
-        ExplainQueryInfo::AncillaryInfo ancillaryInfo;
-        ancillaryInfo._oldPlan = oldPlan;
         if ( _queryOptimizerCursor ) {
             return shared_ptr<ExplainRecordingStrategy>
             ( new QueryOptimizerCursorExplainStrategy( ancillaryInfo, _queryOptimizerCursor ) );
@@ -687,9 +688,12 @@ namespace mongo {
         const ParsedQuery &pq( *pq_shared );
         shared_ptr<Cursor> cursor;
         QueryPlanSummary queryPlan;
+        ExplainQueryInfo::AncillaryInfo ancillaryInfo;
+        ancillaryInfo._oldPlan = oldPlan;
         
         if ( pq.hasOption( QueryOption_OplogReplay ) ) {
-            cursor = FindingStartCursor::getCursor( ns.c_str(), query, order );
+            cursor = FindingStartCursor::getCursor( ns.c_str(), query, order,
+                                                    &ancillaryInfo._oplogStart );
         }
         else {
             cursor = getOptimizedCursor( ns.c_str(),
@@ -703,7 +707,7 @@ namespace mongo {
         verify( cursor );
         
         scoped_ptr<QueryResponseBuilder> queryResponseBuilder
-                ( QueryResponseBuilder::make( pq, cursor, queryPlan, oldPlan ) );
+                ( QueryResponseBuilder::make( pq, cursor, queryPlan, ancillaryInfo ) );
         bool saveClientCursor = false;
         OpTime slaveReadTill;
         ClientCursor::Holder ccPointer( new ClientCursor( QueryOption_NoCursorTimeout, cursor,
@@ -271,7 +271,7 @@ namespace mongo {
         static QueryResponseBuilder *make( const ParsedQuery &parsedQuery,
                                           const shared_ptr<Cursor> &cursor,
                                           const QueryPlanSummary &queryPlan,
-                                          const BSONObj &oldPlan );
+                                          const ExplainQueryInfo::AncillaryInfo &ancillaryInfo );
         /** @return true if the current iterate matches and is added. */
         bool addMatch();
         /** Note that a yield occurred. */
@@ -295,11 +295,13 @@ namespace mongo {
 
     private:
         QueryResponseBuilder( const ParsedQuery &parsedQuery, const shared_ptr<Cursor> &cursor );
-        void init( const QueryPlanSummary &queryPlan, const BSONObj &oldPlan );
+        void init( const QueryPlanSummary &queryPlan,
+                   const ExplainQueryInfo::AncillaryInfo &ancillaryInfo );
 
         ShardChunkManagerPtr newChunkManager() const;
         shared_ptr<ExplainRecordingStrategy> newExplainRecordingStrategy
-        ( const QueryPlanSummary &queryPlan, const BSONObj &oldPlan ) const;
+        ( const QueryPlanSummary &queryPlan,
+          const ExplainQueryInfo::AncillaryInfo &ancillaryInfo ) const;
         shared_ptr<ResponseBuildStrategy> newResponseBuildStrategy
         ( const QueryPlanSummary &queryPlan );
         /**
@@ -1739,7 +1739,7 @@ namespace mongo {
     /* special version of insert for transaction logging -- streamlined a bit.
        assumes ns is capped and no indexes
     */
-    Record* DataFileMgr::fast_oplog_insert(NamespaceDetails *d, const char *ns, int len) {
+    Record* DataFileMgr::fast_oplog_insert(NamespaceDetails *d, const char *ns, int len, DiskLoc* locOut) {
         verify( d );
         RARELY verify( d == nsdetails(ns) );
         DEV verify( d == nsdetails(ns) );
@@ -1789,6 +1789,8 @@ namespace mongo {
             s->nrecords++;
         }
 
+        if ( locOut )
+            *locOut = loc;
         return r;
     }
 
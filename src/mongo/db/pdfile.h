@@ -166,8 +166,9 @@ namespace mongo {
         /* special version of insert for transaction logging -- streamlined a bit.
            assumes ns is capped and no indexes
            no _id field check
+           @param loc if not null, set to the location of the new record
         */
-        Record* fast_oplog_insert(NamespaceDetails *d, const char *ns, int len);
+        Record* fast_oplog_insert(NamespaceDetails *d, const char *ns, int len, DiskLoc* loc = 0);
 
         static Extent* getExtent(const DiskLoc& dl);
         static Record* getRecord(const DiskLoc& dl);
@@ -333,6 +333,19 @@ namespace mongo {
             const ShardOutput& shardOutput,
             const intrusive_ptr<ExpressionContext>& pExpCtx);
 
+        /**
+          Get one source for each shard that returned results, iterating over
+          that shard's output alone.
+
+          This lets a consumer merge the shards' output rather than reading it
+          one shard after another through this source; it may only be called
+          before this source has been iterated, and this source must not be
+          iterated afterwards.
+
+          @returns the sources, in shard order
+         */
+        vector<intrusive_ptr<DocumentSource> > getShardSources();
+
     protected:
         // virtuals from DocumentSource
         virtual void sourceToBson(BSONObjBuilder *pBuilder, bool explain) const;
@@ -866,11 +879,13 @@ namespace mongo {
         virtual GetDepsReturn getDependencies(set<string>& deps) const;
 
         // Virtuals for SplittableDocumentSource
-        // All work for sort is done in router currently if there is no limit.
-        // If there is a limit, the $sort/$limit combination is performed on the
-        // shards, then the results are resorted and limited on mongos
-        virtual intrusive_ptr<DocumentSource> getShardSource() { return limitSrc ? this : NULL; }
-        virtual intrusive_ptr<DocumentSource> getRouterSource() { return this; }
+        // The $sort (and $limit, if any) is performed on the shards, then the
+        // presorted results from the shards are merged and limited on mongos
+        virtual intrusive_ptr<DocumentSource> getShardSource() { return this; }
+        virtual intrusive_ptr<DocumentSource> getRouterSource() {
+            mergePresorted = true;
+            return this;
+        }
 
         /**
           Add sort key field.
@@ -937,11 +952,22 @@ namespace mongo {
         void populate();
         bool populated;
 
+        /*
+          Set on the router half of a split pipeline: the source is expected
+          to be the presorted output of the shards, which is merged rather
+          than sorted again if the source allows that.
+         */
+        bool mergePresorted;
+
         // These are called by populate()
         void populateAll();  // no limit
         void populateOne();  // limit == 1
         void populateTopK(); // limit > 1
 
+        // k-way merge of the shards' presorted output, see mergePresorted
+        void populateMerge(const vector<intrusive_ptr<DocumentSource> >& shardSources);
+        void mergeNext();
+
         /* these two parallel each other */
         typedef vector<intrusive_ptr<ExpressionFieldPath> > SortPaths;
         SortPaths vSortKey;
@@ -973,6 +999,28 @@ namespace mongo {
 
         deque<KeyAndDoc> documents;
 
+        /*
+          While merging, the next document of each shard that has any left,
+          kept as a heap with the best document on top.
+         */
+        struct MergeSource {
+            MergeSource(const KeyAndDoc& current, const intrusive_ptr<DocumentSource>& source):
+                current(current), source(source) {}
+            KeyAndDoc current;
+            intrusive_ptr<DocumentSource> source;
+        };
+        class MergeComparator {
+        public:
+            explicit MergeComparator(const DocumentSourceSort& source): _source(source) {}
+            bool operator()(const MergeSource& lhs, const MergeSource& rhs) const {
+                return (_source.compare(lhs.current, rhs.current) > 0);
+            }
+        private:
+            const DocumentSourceSort& _source;
+        };
+        vector<MergeSource> mergeHeap;
+        long long mergedCount;
+
         intrusive_ptr<DocumentSourceLimit> limitSrc;
     };
     inline void swap(DocumentSourceSort::KeyAndDoc& l, DocumentSourceSort::KeyAndDoc& r) {
@@ -21,6 +21,27 @@
 
 namespace mongo {
 
+namespace {
+    /* check a shard's response and return the result array from it */
+    BSONElement getResultArray(const DocumentSourceCommandShards::ShardOutput::value_type& output) {
+        const BSONObj& resultObj = output.second;
+
+        uassert(16390, str::stream() << "sharded pipeline failed on shard " <<
+                                    output.first.getName() << ": " <<
+                                    resultObj.toString(),
+                resultObj["ok"].trueValue());
+
+        /* grab the result array out of the shard server's response */
+        BSONElement resultArray = resultObj["result"];
+        massert(16391, str::stream() << "no result array? shard:" <<
+                                    output.first.getName() << ": " <<
+                                    resultObj.toString(),
+                resultArray.type() == Array);
+
+        return resultArray;
+    }
+}
+
     DocumentSourceCommandShards::~DocumentSourceCommandShards() {
     }
 
@@ -82,6 +103,21 @@ namespace mongo {
         return pSource;
     }
 
+    vector<intrusive_ptr<DocumentSource> > DocumentSourceCommandShards::getShardSources() {
+        verify(unstarted);
+
+        vector<intrusive_ptr<DocumentSource> > sources;
+        for (; iterator != listEnd; ++iterator) {
+            BSONElement resultArray = getResultArray(*iterator);
+            if (resultArray.embeddedObject().isEmpty())
+                continue;
+
+            sources.push_back(DocumentSourceBsonArray::create(&resultArray, pExpCtx));
+        }
+
+        return sources;
+    }
+
     void DocumentSourceCommandShards::getNextDocument() {
         if (unstarted) {
             unstarted = false;
@@ -97,20 +133,8 @@ namespace mongo {
                     return;
                 }
 
-                /* grab the next command result */
-                BSONObj resultObj = iterator->second;
-
-                uassert(16390, str::stream() << "sharded pipeline failed on shard " <<
-                                            iterator->first.getName() << ": " <<
-                                            resultObj.toString(),
-                        resultObj["ok"].trueValue());
-
-                /* grab the result array out of the shard server's response */
-                BSONElement resultArray = resultObj["result"];
-                massert(16391, str::stream() << "no result array? shard:" <<
-                                            iterator->first.getName() << ": " <<
-                                            resultObj.toString(),
-                        resultArray.type() == Array);
+                /* grab the result array out of the next command result */
+                BSONElement resultArray = getResultArray(*iterator);
 
                 // done with error checking, don't need the shard name anymore
                 ++iterator;
@@ -51,6 +51,9 @@ namespace mongo {
         if (!documents.empty())
             documents.pop_front(); // this way we release memory as we go
 
+        if (documents.empty() && !mergeHeap.empty())
+            mergeNext();
+
         return !documents.empty();
     }
 
@@ -70,6 +73,10 @@ namespace mongo {
             if (explain && limitSrc) {
                 insides.appendNumber("limit", limitSrc->getLimit());
             }
+
+            if (mergePresorted) {
+                insides.append("mergePresorted", true);
+            }
             insides.doneFast();
             sortObj.doneFast();
         }
@@ -90,12 +97,15 @@ namespace mongo {
 
     void DocumentSourceSort::dispose() {
         documents.clear();
+        mergeHeap.clear();
         pSource->dispose();
     }
 
     DocumentSourceSort::DocumentSourceSort(const intrusive_ptr<ExpressionContext> &pExpCtx)
         : SplittableDocumentSource(pExpCtx)
         , populated(false)
+        , mergePresorted(false)
+        , mergedCount(0)
     {}
 
     long long DocumentSourceSort::getLimit() const {
@@ -196,6 +206,16 @@ namespace mongo {
         /* make sure we've got a sort key */
         verify(vSortKey.size());
 
+        if (mergePresorted) {
+            DocumentSourceCommandShards* pShards =
+                dynamic_cast<DocumentSourceCommandShards*>(pSource);
+            if (pShards) {
+                populateMerge(pShards->getShardSources());
+                populated = true;
+                return;
+            }
+        }
+
         if (!limitSrc)
             populateAll();
         else if (limitSrc->getLimit() == 1)
@@ -275,6 +295,49 @@ namespace mongo {
         documents.insert(documents.begin(), heap.begin(), heap.end());
     }
 
+    void DocumentSourceSort::populateMerge(
+            const vector<intrusive_ptr<DocumentSource> >& shardSources) {
+        // Each shard already sorted (and limited) its output, so only the first
+        // document of every shard needs to be compared to find the next one.
+        for (size_t i = 0; i < shardSources.size(); i++) {
+            if (shardSources[i]->eof())
+                continue;
+
+            mergeHeap.push_back(MergeSource(KeyAndDoc(shardSources[i]->getCurrent(), vSortKey),
+                                            shardSources[i]));
+        }
+
+        // after this, mergeHeap.front() is the best document
+        std::make_heap(mergeHeap.begin(), mergeHeap.end(), MergeComparator(*this));
+
+        mergeNext();
+    }
+
+    void DocumentSourceSort::mergeNext() {
+        if (limitSrc && mergedCount >= limitSrc->getLimit()) {
+            mergeHeap.clear();
+            return;
+        }
+
+        if (mergeHeap.empty())
+            return;
+
+        MergeComparator comp (*this);
+        std::pop_heap(mergeHeap.begin(), mergeHeap.end(), comp);
+
+        MergeSource& best = mergeHeap.back();
+        documents.push_back(best.current);
+        mergedCount++;
+
+        if (best.source->advance()) {
+            best.current = KeyAndDoc(best.source->getCurrent(), vSortKey);
+            std::push_heap(mergeHeap.begin(), mergeHeap.end(), comp);
+        }
+        else {
+            mergeHeap.pop_back();
+        }
+    }
+
     DocumentSourceSort::KeyAndDoc::KeyAndDoc(const Document& d, const SortPaths& sp) :doc(d) {
         if (sp.size() == 1) {
             key = sp[0]->evaluate(d);
@@ -19,6 +19,7 @@
 #include "mongo/db/client.h"
 #include "mongo/db/commands/fsync.h"
 #include "mongo/db/commands/server_status.h"
+#include "mongo/db/dbhelpers.h"
 #include "mongo/db/repl/bgsync.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/rs_sync.h"
@@ -63,6 +64,11 @@ namespace replset {
     static int bufferMaxSizeGauge = 256*1024*1024;
     static ServerStatusMetricField<int> displayBufferMaxSize( "repl.buffer.maxSizeBytes",
                                                                 &bufferMaxSizeGauge );
+    //The replSetUpdatePosition commands sent to the sync target
+    static Counter64 positionReportsStats;
+    static ServerStatusMetricField<Counter64> displayPositionReports(
+                                                    "repl.network.positionReports",
+                                                    &positionReportsStats );
 
 
     BackgroundSyncInterface::~BackgroundSyncInterface() {}
@@ -80,7 +86,8 @@ namespace replset {
                                        _currentSyncTarget(NULL),
                                        _oplogMarkerTarget(NULL),
                                        _oplogMarker(true /* doHandshake */),
-                                       _consumedOpTime(0, 0) {
+                                       _consumedOpTime(0, 0),
+                                       _targetTakesPositions(false) {
     }
 
     BackgroundSync* BackgroundSync::get() {
@@ -140,12 +147,15 @@ namespace replset {
             try {
                 {
                     boost::unique_lock<boost::mutex> lock(_lastOpMutex);
-                    while (_consumedOpTime == theReplSet->lastOpTimeWritten) {
+                    while (_consumedOpTime == theReplSet->lastOpTimeWritten &&
+                           _pendingPositions.empty()) {
                         _lastOpCond.wait(lock);
                     }
                 }
 
-                markOplog();
+                if (!reportPositions()) {
+                    markOplog();
+                }
             }
             catch (DBException &e) {
                 clearTarget = true;
@@ -195,32 +205,140 @@ namespace replset {
         _oplogMarker.more();
     }
 
-    bool BackgroundSync::hasCursor() {
-        {
-            // prevent writers from blocking readers during fsync
-            SimpleMutex::scoped_lock fsynclk(filesLockedFsync); 
-            // we don't need the local write lock yet, but it's needed by OplogReader::connect
-            // so we take it preemptively to avoid deadlocking.
-            Lock::DBWrite lk("local");
+    bool BackgroundSync::connectOplogNotifier() {
+        // prevent writers from blocking readers during fsync
+        SimpleMutex::scoped_lock fsynclk(filesLockedFsync); 
+        // we don't need the local write lock yet, but it's needed by OplogReader::connect
+        // so we take it preemptively to avoid deadlocking.
+        Lock::DBWrite lk("local");
 
-            boost::unique_lock<boost::mutex> lock(_mutex);
+        boost::unique_lock<boost::mutex> lock(_mutex);
 
-            if (!_oplogMarkerTarget || _currentSyncTarget != _oplogMarkerTarget) {
-                if (!_currentSyncTarget) {
-                    return false;
-                }
+        if (!_oplogMarkerTarget || _currentSyncTarget != _oplogMarkerTarget) {
+            if (!_currentSyncTarget) {
+                return false;
+            }
+
+            log() << "replset setting oplog notifier to " << _currentSyncTarget->fullName() << rsLog;
+            _oplogMarkerTarget = _currentSyncTarget;
+            _targetTakesPositions = true;
+
+            _oplogMarker.resetConnection();
+
+            if (!_oplogMarker.connect(_oplogMarkerTarget->fullName())) {
+                LOG(1) << "replset could not connect to " << _oplogMarkerTarget->fullName() << rsLog;
+                _oplogMarkerTarget = NULL;
+                return false;
+            }
+        }
+
+        if (_me.isEmpty()) {
+            // local.me is written by the handshake in OplogReader::connect
+            BSONObj me;
+            if (Helpers::getSingleton("local.me", me)) {
+                _me = me.getOwned();
+            }
+        }
+        return true;
+    }
+
+    bool BackgroundSync::reportPositions() {
+        if (!connectOplogNotifier()) {
+            sleepsecs(1);
+            return true;
+        }
+
+        if (!syncTargetTakesPositions()) {
+            percolatePendingPositions();
+            return false;
+        }
 
-                log() << "replset setting oplog notifier to " << _currentSyncTarget->fullName() << rsLog;
-                _oplogMarkerTarget = _currentSyncTarget;
+        if (_me.isEmpty()) {
+            // queued positions wait until local.me is readable
+            return false;
+        }
 
-                _oplogMarker.resetConnection();
+        const OpTime lastOpTimeWritten = theReplSet->lastOpTimeWritten;
+        map<mongo::OID, BSONObj> positions;
+        {
+            boost::unique_lock<boost::mutex> lock(_lastOpMutex);
+            positions.swap(_pendingPositions);
+        }
 
-                if (!_oplogMarker.connect(_oplogMarkerTarget->fullName())) {
-                    LOG(1) << "replset could not connect to " << _oplogMarkerTarget->fullName() << rsLog;
-                    _oplogMarkerTarget = NULL;
-                    return false;
+        BSONObjBuilder cmd;
+        cmd.append("replSetUpdatePosition", 1);
+        BSONArrayBuilder optimes(cmd.subarrayStart("optimes"));
+        {
+            BSONObjBuilder self(optimes.subobjStart());
+            self.append(_me["_id"]);
+            self.appendTimestamp("optime", lastOpTimeWritten.asDate());
+            self.append("memberId", theReplSet->selfId());
+            self.append("config", theReplSet->myConfig().asBson());
+            self.done();
+        }
+        for (map<mongo::OID, BSONObj>::const_iterator i = positions.begin();
+             i != positions.end(); ++i) {
+            optimes.append(i->second);
+        }
+        optimes.done();
+
+        BSONObj res;
+        bool ok = _oplogMarker.conn()->runCommand("admin", cmd.obj(), res);
+        if (!ok) {
+            {
+                // keep the positions for the next attempt unless newer ones arrived meanwhile
+                boost::unique_lock<boost::mutex> lock(_lastOpMutex);
+                _pendingPositions.insert(positions.begin(), positions.end());
+            }
+            if (str::contains(res["errmsg"].str(), "no such")) {
+                log() << "replset sync target does not support replSetUpdatePosition, "
+                      << "tracking its oplog instead" << rsLog;
+                {
+                    boost::unique_lock<boost::mutex> lock(_mutex);
+                    _targetTakesPositions = false;
                 }
+                percolatePendingPositions();
+                return false;
             }
+            uasserted(16849, str::stream() << "replSetUpdatePosition failed: " << res);
+        }
+
+        positionReportsStats.increment();
+        _consumedOpTime = lastOpTimeWritten;
+        return true;
+    }
+
+    void BackgroundSync::percolatePendingPositions() {
+        map<mongo::OID, BSONObj> positions;
+        {
+            boost::unique_lock<boost::mutex> lock(_lastOpMutex);
+            positions.swap(_pendingPositions);
+        }
+
+        // GhostSync::percolate() skipped these while the target took positions
+        for (map<mongo::OID, BSONObj>::const_iterator i = positions.begin();
+             i != positions.end(); ++i) {
+            BSONObj rid = BSON("_id" << i->first);
+            OpTime last = i->second["optime"]._opTime();
+            theReplSet->ghost->send(boost::bind(&GhostSync::percolate, theReplSet->ghost,
+                                                rid, last));
+        }
+    }
+
+    void BackgroundSync::forwardSlavePosition(const mongo::OID& rid, const BSONObj& position) {
+        boost::unique_lock<boost::mutex> lock(_lastOpMutex);
+        _pendingPositions[rid] = position.getOwned();
+        _lastOpCond.notify_all();
+    }
+
+    bool BackgroundSync::syncTargetTakesPositions() {
+        boost::unique_lock<boost::mutex> lock(_mutex);
+        return _oplogMarkerTarget && _targetTakesPositions;
+    }
+
+    bool BackgroundSync::hasCursor() {
+        if (!connectOplogNotifier()) {
+            return false;
         }
 
         if (!_oplogMarker.haveCursor()) {
@@ -51,7 +51,10 @@ namespace replset {
 
     /**
      * notifierThread() uses lastOpTimeWritten to inform the sync target where this member is
-     * currently synced to.
+     * currently synced to.  It sends replSetUpdatePosition commands carrying this member's
+     * position along with those reported by members chained through it, so the primary learns
+     * every member's position within one round trip per hop.  If the sync target does not know
+     * the command it falls back to tailing the target's oplog (markOplog()).
      *
      * Lock order:
      * 1. rslock
@@ -89,6 +92,13 @@ namespace replset {
         OplogReader _oplogMarker; // not locked, only used by notifier thread
         OpTime _consumedOpTime; // not locked, only used by notifier thread
 
+        // positions of members chained through this one, keyed by rid, waiting to be sent to
+        // the sync target; protected by _lastOpMutex
+        map<mongo::OID, BSONObj> _pendingPositions;
+        // whether _oplogMarkerTarget accepts replSetUpdatePosition; protected by _mutex
+        bool _targetTakesPositions;
+        BSONObj _me; // not locked, only used by notifier thread
+
         BackgroundSync();
         BackgroundSync(const BackgroundSync& s);
         BackgroundSync operator=(const BackgroundSync& s);
@@ -113,6 +123,12 @@ namespace replset {
         // tells the sync target where this member is synced to
         void markOplog();
         bool hasCursor();
+        // connects _oplogMarker to the current sync target
+        bool connectOplogNotifier();
+        // sends pending positions to the sync target; returns false if it needs markOplog()
+        bool reportPositions();
+        // hands pending positions to GhostSync when the sync target doesn't take them
+        void percolatePendingPositions();
 
         bool isAssumingPrimary();
 
@@ -138,6 +154,13 @@ namespace replset {
         // For monitoring
         BSONObj getCounters();
 
+        // Queue a position reported by a chained member, formatted as an element of the
+        // replSetUpdatePosition "optimes" array, to be forwarded to the sync target
+        void forwardSlavePosition(const mongo::OID& rid, const BSONObj& position);
+
+        // true if positions reach the sync target through replSetUpdatePosition
+        bool syncTargetTakesPositions();
+
         // Wait for replication to finish and buffer to be applied so that the member can become
         // primary.
         void stopReplicationAndFlushBuffer();
@@ -58,7 +58,8 @@ namespace mongo {
             connect();
         }
 
-        void setTimeout(time_t timeout) {
+        /** @param timeout socket timeout in seconds; may be fractional */
+        void setTimeout(double timeout) {
             connInfo->setTimeout(timeout);
         }
 
@@ -87,7 +88,8 @@ namespace mongo {
                 cc(new DBClientConnection(/*reconnect*/ true,
                                           /*replicaSet*/ 0,
                                           /*timeout*/ ReplSetConfig::DEFAULT_HB_TIMEOUT)),
-                connected(false) {
+                connected(false),
+                _timeout(ReplSetConfig::DEFAULT_HB_TIMEOUT) {
                 cc->_logLevel = 2;
             }
 
@@ -96,17 +98,17 @@ namespace mongo {
                 mp.tag |= ScopedConn::keepOpen;
             }
 
-            void setTimeout(time_t timeout) {
+            void setTimeout(double timeout) {
                 _timeout = timeout;
                 cc->setSoTimeout(_timeout);
             }
 
-            int getTimeout() {
+            double getTimeout() {
                 return _timeout;
             }
 
         private:
-            int _timeout;
+            double _timeout;
         } *connInfo;
         typedef map<string,ScopedConn::ConnectionInfo*> M;
         static M& _map;
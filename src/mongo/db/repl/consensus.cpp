@@ -174,7 +174,13 @@ namespace mongo {
 
     static const int VETO = -10000;
 
-    const time_t LeaseTime = 30;
+    /**
+     * How long a yea vote binds us to its candidate: three election timeouts, which is 30 seconds
+     * with the default settings.  An election that takes longer than this is ignored.
+     */
+    static time_t leaseTime(const ReplSetConfig& config) {
+        return std::max((3 * config.getElectionTimeout() + 999) / 1000, 1);
+    }
 
     SimpleMutex Consensus::lyMutex("ly");
 
@@ -182,7 +188,7 @@ namespace mongo {
         SimpleMutex::scoped_lock lk(lyMutex);
         LastYea &L = this->ly.ref(lk);
         time_t now = time(0);
-        if( L.when + LeaseTime >= now && L.who != memberId ) {
+        if( L.when + leaseTime(rs.config()) >= now && L.who != memberId ) {
             LOG(1) << "replSet not voting yea for " << memberId <<
                    " voted for " << L.who << ' ' << now-L.when << " secs ago" << rsLog;
             throw VoteException();
@@ -392,7 +398,9 @@ namespace mongo {
             }
             else {
                 verify( !rs.lockedByMe() ); // bad to go to sleep locked
-                unsigned ms = ((unsigned) rand()) % 1000 + 50;
+                // up to half a heartbeat interval, so we have likely heard from the others by then
+                unsigned window = std::max(rs.config().getHeartbeatInterval() / 2, 1);
+                unsigned ms = ((unsigned) rand()) % window + 50;
                 DEV log() << "replSet tie " << nTies << " sleeping a little " << ms << "ms" << rsLog;
                 sleptLast = true;
                 sleepmillis(ms);
@@ -433,7 +441,7 @@ namespace mongo {
                 if( tally*2 <= totalVotes() ) {
                     log() << "replSet couldn't elect self, only received " << tally << " votes" << rsLog;
                 }
-                else if( time(0) - start > 30 ) {
+                else if( time(0) - start > leaseTime(rs.config()) ) {
                     // defensive; should never happen as we have timeouts on connection and operation for our conn
                     log() << "replSet too much time passed during our election, ignoring result" << rsLog;
                 }
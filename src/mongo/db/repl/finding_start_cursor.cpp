@@ -19,8 +19,10 @@
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/cursor.h"
 #include "mongo/db/matcher.h"
+#include "mongo/db/namespacestring.h"
 #include "mongo/db/query_plan.h"
 #include "mongo/db/queryutil.h"
+#include "mongo/db/repl/oplog_start_index.h"
 
 namespace mongo {
 
@@ -38,7 +40,9 @@ namespace mongo {
     FindingStartCursor::FindingStartCursor( const QueryPlan &qp ) :
     _qp( qp ),
     _findingStart( true ),
-    _findingStartMode() {
+    _findingStartMode(),
+    _nscanned(),
+    _usedStartIndex() {
     }
     
     void FindingStartCursor::next() {
@@ -48,6 +52,7 @@ namespace mongo {
             destroyClientCursor();
             return;
         }
+        ++_nscanned;
         switch( _findingStartMode ) {
             // Initial mode: scan backwards from end of collection
             case Initial: {
@@ -158,6 +163,38 @@ namespace mongo {
         shared_ptr<Cursor> c = _qp.newCursor();
         return !c->ok() || _matcher->matchesCurrent( c.get() );
     }
+
+    bool FindingStartCursor::startFromIndex() {
+        if ( !NamespaceString::oplog( _qp.ns() ) ) {
+            return false;
+        }
+        const FieldRange &tsRange = _qp.multikeyFrs().range( "ts" );
+        if ( tsRange.empty() ) {
+            return false;
+        }
+        BSONElement tsMin = tsRange.min();
+        if ( tsMin.type() != Timestamp && tsMin.type() != Date ) {
+            return false;
+        }
+        // The oldest op bounds which index entries still refer to live records.
+        shared_ptr<Cursor> oldestCursor = _qp.newCursor();
+        verify( oldestCursor->ok() );
+        BSONElement oldest = oldestCursor->current()[ "ts" ];
+        if ( oldest.type() != Timestamp && oldest.type() != Date ) {
+            return false;
+        }
+        DiskLoc start = OplogStartIndex::get().findStartBefore( _qp.ns(), _qp.nsd(),
+                                                                tsMin._opTime(),
+                                                                oldest._opTime() );
+        if ( start.isNull() ) {
+            return false;
+        }
+        // Every op before 'start' is older than the ts bound, so scan forward from it.
+        createClientCursor( start );
+        _findingStartMode = InExtent;
+        _usedStartIndex = true;
+        return true;
+    }
     
     void FindingStartCursor::init() {
         BSONElement tsElt = _qp.originalQuery()[ "ts" ];
@@ -171,6 +208,9 @@ namespace mongo {
             _findingStart = false;
             return;
         }
+        if ( startFromIndex() ) {
+            return;
+        }
         // Use a ClientCursor here so we can release db mutex while scanning
         // oplog (can take quite a while with large oplogs).
         shared_ptr<Cursor> c = _qp.newReverseCursor();
@@ -179,7 +219,9 @@ namespace mongo {
         _findingStartMode = Initial;
     }
     
-    shared_ptr<Cursor> FindingStartCursor::getCursor( const char *ns, const BSONObj &query, const BSONObj &order ) {
+    shared_ptr<Cursor> FindingStartCursor::getCursor( const char *ns, const BSONObj &query,
+                                                      const BSONObj &order, BSONObj *stats ) {
+        Timer timer;
         NamespaceDetails *d = nsdetails(ns);
         if ( !d ) {
             return shared_ptr<Cursor>( new BasicCursor( DiskLoc() ) );
@@ -200,6 +242,11 @@ namespace mongo {
         shared_ptr<Cursor> ret = finder->cursor();
         shared_ptr<CoveredIndexMatcher> matcher( new CoveredIndexMatcher( query, BSONObj() ) );
         ret->setMatcher( matcher );
+        if ( stats ) {
+            *stats = BSON( "usedStartIndex" << finder->usedStartIndex() <<
+                           "nscanned" << finder->nscanned() <<
+                           "millis" << timer.millis() );
+        }
         return ret;
     }
     
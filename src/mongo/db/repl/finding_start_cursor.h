@@ -64,13 +64,21 @@ namespace mongo {
             }
         }
         
+        /** @return the number of oplog records examined while finding the first matching op. */
+        long long nscanned() const { return _nscanned; }
+
+        /** @return true if the search started from an OplogStartIndex entry. */
+        bool usedStartIndex() const { return _usedStartIndex; }
+
         /**
          * @return a BasicCursor constructed using a FindingStartCursor with the provided query and
          * order parameters.
+         * @param stats if not null, set to a summary of the search for explain output.
          * @yields the db lock.
          * @asserts on yield recovery failure.
          */
-        static shared_ptr<Cursor> getCursor( const char *ns, const BSONObj &query, const BSONObj &order );
+        static shared_ptr<Cursor> getCursor( const char *ns, const BSONObj &query,
+                                             const BSONObj &order, BSONObj *stats = 0 );
 
         /**
          * @return the first record of the first nonempty extent preceding the extent containing
@@ -98,6 +106,8 @@ namespace mongo {
         ClientCursor::Holder _findingStartCursor;
         shared_ptr<Cursor> _c;
         ClientCursor::YieldData _yieldData;
+        long long _nscanned;
+        bool _usedStartIndex;
         static int _initialTimeout;
 
         /** @return the first record of the extent containing @param rec. */
@@ -108,6 +118,11 @@ namespace mongo {
             _findingStartCursor.reset( 0 );
         }
         bool firstDocMatchesOrEmpty() const;
+        /**
+         * Position the search at an OplogStartIndex entry preceding the query's ts bound.
+         * @return false if no usable entry exists.
+         */
+        bool startFromIndex();
     };
 
 }
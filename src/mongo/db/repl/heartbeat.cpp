@@ -217,12 +217,17 @@ namespace mongo {
         int tries;
         const int threshold;
     public:
-        ReplSetHealthPollTask(const HostAndPort& hh, const HeartbeatInfo& mm)
+        ReplSetHealthPollTask(const HostAndPort& hh, const HeartbeatInfo& mm,
+                              const ReplSetConfig& config)
             : h(hh), m(mm), tries(s_try_offset), threshold(15),
-              _timeout(ReplSetConfig::DEFAULT_HB_TIMEOUT) {
+              _timeout(config.getElectionTimeout() / 1000.0),
+              _interval(config.getHeartbeatInterval()),
+              _lastFailed(false) {
 
-            if (theReplSet) {
-                _timeout = theReplSet->config().getHeartbeatTimeout();
+            // the election timeout bounds how long we wait for a heartbeat response
+            const int hbTimeout = config.getHeartbeatTimeout();
+            if (hbTimeout > 0 && hbTimeout < _timeout) {
+                _timeout = hbTimeout;
             }
 
             // doesn't need protection, all health tasks are created in a single thread
@@ -231,6 +236,17 @@ namespace mongo {
 
         string name() const { return "rsHealthPoll"; }
 
+        /**
+         * After a failed heartbeat, poll again sooner than the regular interval so that a member
+         * that went down is confirmed (and one that blipped is seen up again) quickly.
+         */
+        unsigned pauseMillis(unsigned millis) {
+            if (_lastFailed) {
+                return std::min(millis, std::max(millis / 4, 1U));
+            }
+            return millis;
+        }
+
         void setUp() { }
 
         void doWork() {
@@ -253,6 +269,7 @@ namespace mongo {
                     mem.ping = (unsigned int)((old.ping * .8) + (mem.ping * .2));
                 }
 
+                _lastFailed = !ok;
                 if( ok ) {
                     up(info, mem);
                 }
@@ -264,9 +281,11 @@ namespace mongo {
                 }
             }
             catch(DBException& e) {
+                _lastFailed = true;
                 down(mem, e.what());
             }
             catch(...) {
+                _lastFailed = true;
                 down(mem, "replSet unexpected exception in ReplSetHealthPollTask");
             }
             m = mem;
@@ -320,13 +339,13 @@ namespace mongo {
             time_t totalSecs = mem.ping / 1000;
 
             // if that didn't work and we have more time, lower timeout and try again
-            if (!ok && totalSecs < _timeout) {
+            if (!ok && mem.ping < _timeout * 1000) {
                 log() << "replset info " << h.toString() << " heartbeat failed, retrying" << rsLog;
 
                 // lower timeout to remaining ping time
                 {
                     ScopedConn conn(h.toString());
-                    conn.setTimeout(_timeout - totalSecs);
+                    conn.setTimeout(_timeout - mem.ping / 1000.0);
                 }
 
                 int checkpoint = timer.millis();
@@ -383,10 +402,11 @@ namespace mongo {
         }
 
         void down(HeartbeatInfo& mem, string msg) {
-            // if we've received a heartbeat from this member within the last two seconds, don't
-            // change its state to down (if it's already down, leave it down since we don't have
-            // any info about it other than it's heartbeating us)
-            if (m.lastHeartbeatRecv+2 >= time(0)) {
+            // if we've received a heartbeat from this member within the last heartbeat interval,
+            // don't change its state to down (if it's already down, leave it down since we don't
+            // have any info about it other than it's heartbeating us)
+            const time_t recentSecs = std::max((_interval + 999) / 1000, 1);
+            if (m.lastHeartbeatRecv + recentSecs >= time(0)) {
                 log() << "replset info " << h.toString()
                       << " just heartbeated us, but our heartbeat failed: " << msg
                       << ", not changing state" << rsLog;
@@ -458,8 +478,14 @@ namespace mongo {
             }
         }
 
-        // Heartbeat timeout
-        time_t _timeout;
+        // Heartbeat timeout, in seconds
+        double _timeout;
+
+        // Pause between heartbeats, in milliseconds
+        int _interval;
+
+        // Whether the last heartbeat failed
+        bool _lastFailed;
     };
 
     void HeartbeatInfo::recvHeartbeat() {
@@ -479,9 +505,9 @@ namespace mongo {
 
     void ReplSetImpl::startHealthTaskFor(Member *m) {
         DEV log() << "starting rsHealthPoll for " << m->fullName() << endl;
-        ReplSetHealthPollTask *task = new ReplSetHealthPollTask(m->h(), m->hbinfo());
+        ReplSetHealthPollTask *task = new ReplSetHealthPollTask(m->h(), m->hbinfo(), config());
         healthTasks.insert(task);
-        task::repeat(task, 2000);
+        task::repeat(task, config().getHeartbeatInterval());
     }
 
     void startSyncThread();
@@ -33,6 +33,7 @@
 #include "mongo/db/ops/update.h"
 #include "mongo/db/ops/delete.h"
 #include "mongo/db/repl/bgsync.h"
+#include "mongo/db/repl/oplog_start_index.h"
 #include "mongo/db/repl/replication_server_status.h"
 #include "mongo/db/repl/rs.h"
 #include "mongo/db/repl/write_concern.h"
@@ -59,6 +60,7 @@ namespace mongo {
         localDB = 0;
         localOplogMainDetails = 0;
         rsOplogDetails = 0;
+        OplogStartIndex::get().invalidateAll();
         resetSlaveCache();
     }
 
@@ -87,8 +89,10 @@ namespace mongo {
             Client::Context ctx(logns , localDB);
             {
                 int len = op.objsize();
-                Record *r = theDataFileMgr.fast_oplog_insert(rsOplogDetails, logns, len);
+                DiskLoc loc;
+                Record *r = theDataFileMgr.fast_oplog_insert(rsOplogDetails, logns, len, &loc);
                 memcpy(getDur().writingPtr(r->data(), len), op.objdata(), len);
+                OplogStartIndex::get().noteInsert(logns, ts, loc, len);
             }
             /* todo: now() has code to handle clock skew.  but if the skew server to server is large it will get unhappy.
                      this code (or code in now() maybe) should be improved.
@@ -108,35 +112,110 @@ namespace mongo {
         OpTime::setLast( ts );
     }
 
-    /** given a BSON object, create a new one at dst which is the existing (partial) object
-        with a new object element appended at the end with fieldname "o".
+    /** Writes an oplog entry straight into the record allocated for it.  The size of the entry
+        is computed up front from its fields, so the entry is never built in a temporary buffer
+        and copied; each field, including the (possibly large) "o" object, is copied exactly
+        once, into the memory mapped file.
 
-        @param partial already build object with everything except the o member.  e.g. something like:
-               { ts:..., ns:..., os2:... }
-        @param o a bson object to be added with fieldname "o"
-        @dst   where to put the newly built combined object.  e.g. ends up as something like:
-               { ts:..., ns:..., os2:..., o:... }
+        replica set entries look like { ts:..., h:..., v:..., op:..., ns:..., fromMigrate:...,
+        b:..., o2:..., o:... }; master/slave entries have no h and v fields.
     */
-    void append_O_Obj(char *dst, const BSONObj& partial, const BSONObj& o) {
-        const int size1 = partial.objsize() - 1;  // less the EOO char
-        const int oOfs = size1+3;                 // 3 = byte BSONOBJTYPE + byte 'o' + byte \0
+    class OplogEntryWriter {
+    public:
+        OplogEntryWriter(bool rs, const char *opstr, const char *ns, BSONObj *o2, bool *bb,
+                         bool fromMigrate)
+            : _rs(rs), _opstr(opstr), _ns(ns), _opstrLen(strlen(opstr)), _nsLen(strlen(ns)),
+              _o2(o2), _bb(bb), _fromMigrate(fromMigrate) {
+        }
 
-        void *p = getDur().writingPtr(dst, oOfs+o.objsize()+1);
+        /** @return the size of the entry logging 'obj' */
+        int size(const BSONObj& obj) const {
+            int len = 4;                                    // object size
+            len += 1 + 3 + 8;                               // ts
+            if (_rs) {
+                len += 1 + 2 + 8;                           // h
+                len += 1 + 2 + 4;                           // v
+            }
+            len += 1 + 3 + 4 + _opstrLen + 1;               // op
+            len += 1 + 3 + 4 + _nsLen + 1;                  // ns
+            if (_fromMigrate)
+                len += 1 + 12 + 1;                          // fromMigrate
+            if (_bb)
+                len += 1 + 2 + 1;                           // b
+            if (_o2)
+                len += 1 + 3 + _o2->objsize();              // o2
+            len += 1 + 2 + obj.objsize();                   // o
+            len += 1;                                       // EOO
+            return len;
+        }
 
-        memcpy(p, partial.objdata(), size1);
+        /** write the entry logging 'obj', of size 'len' as returned by size(), to 'dst' */
+        void write(char *dst, int len, const BSONObj& obj, const OpTime& ts, long long h) const {
+            char *start = static_cast<char *>(getDur().writingPtr(dst, len));
+            char *p = start;
+            p = put(p, len);
+            p = putName(p, Timestamp, "ts", 2);
+            p = put(p, ts.asDate());
+            if (_rs) {
+                p = putName(p, NumberLong, "h", 1);
+                p = put(p, h);
+                p = putName(p, NumberInt, "v", 1);
+                p = put(p, OPLOG_VERSION);
+            }
+            p = putString(p, "op", _opstr, _opstrLen);
+            p = putString(p, "ns", _ns, _nsLen);
+            if (_fromMigrate) {
+                p = putName(p, Bool, "fromMigrate", 11);
+                *p++ = 1;
+            }
+            if (_bb) {
+                p = putName(p, Bool, "b", 1);
+                *p++ = *_bb ? 1 : 0;
+            }
+            if (_o2) {
+                p = putName(p, Object, "o2", 2);
+                p = putBytes(p, _o2->objdata(), _o2->objsize());
+            }
+            p = putName(p, Object, "o", 1);
+            p = putBytes(p, obj.objdata(), obj.objsize());
+            *p++ = EOO;
+            verify(p - start == len);
+        }
 
-        // adjust overall bson object size for the o: field
-        *(static_cast<unsigned*>(p)) += o.objsize() + 1/*fieldtype byte*/ + 2/*"o" fieldname*/;
+        static const int OPLOG_VERSION = 2;
 
-        char *b = static_cast<char *>(p);
-        b += size1;
-        *b++ = (char) Object;
-        *b++ = 'o'; // { o : ... }
-        *b++ = 0;   // null terminate "o" fieldname
-        memcpy(b, o.objdata(), o.objsize());
-        b += o.objsize();
-        *b = EOO;
-    }
+    private:
+        template<typename T>
+        static char* put(char *p, T value) {
+            memcpy(p, &value, sizeof(T));
+            return p + sizeof(T);
+        }
+
+        static char* putBytes(char *p, const char *data, int len) {
+            memcpy(p, data, len);
+            return p + len;
+        }
+
+        static char* putName(char *p, BSONType type, const char *name, int nameLen) {
+            *p++ = static_cast<char>(type);
+            return putBytes(p, name, nameLen + 1);
+        }
+
+        static char* putString(char *p, const char *name, const char *value, int valueLen) {
+            p = putName(p, String, name, strlen(name));
+            p = put(p, valueLen + 1);
+            return putBytes(p, value, valueLen + 1);
+        }
+
+        const bool _rs;
+        const char *_opstr;
+        const char *_ns;
+        const int _opstrLen;
+        const int _nsLen;
+        BSONObj *_o2;
+        bool *_bb;
+        const bool _fromMigrate;
+    };
 
     /* we write to local.oplog.rs:
          { ts : ..., h: ..., v: ..., op: ..., etc }
@@ -155,14 +234,10 @@ namespace mongo {
          if not null, specifies a boolean to pass along to the other side as b: param.
          used for "justOne" or "upsert" flags on 'd', 'u'
 
+       objs/nObjs: one entry with the same opstr, ns, o2 and b is logged for each of the nObjs
+       objects, under a single acquisition of the local lock and of the OpTime mutex.
     */
-
-    // global is safe as we are in write lock. we put the static outside the function to avoid the implicit mutex 
-    // the compiler would use if inside the function.  the reason this is static is to avoid a malloc/free for this
-    // on every logop call.
-    static BufBuilder logopbufbuilder(8*1024);
-    static const int OPLOG_VERSION = 2;
-    static void _logOpRS(const char *opstr, const char *ns, const char *logNS, const BSONObj& obj, BSONObj *o2, bool *bb, bool fromMigrate ) {
+    static void _logOpsRS(const char *opstr, const char *ns, const char *logNS, const BSONObj *objs, size_t nObjs, BSONObj *o2, bool *bb, bool fromMigrate ) {
         Lock::DBWrite lk1("local");
 
         if ( strncmp(ns, "local.", 6) == 0 ) {
@@ -173,76 +248,62 @@ namespace mongo {
 
         mutex::scoped_lock lk2(OpTime::m);
 
-        const OpTime ts = OpTime::now(lk2);
-        long long hashNew;
         if( theReplSet ) {
             massert(13312, "replSet error : logOp() but not primary?", theReplSet->box.getState().primary());
-            hashNew = (theReplSet->lastH * 131 + ts.asLL()) * 17 + theReplSet->selfId();
         }
         else {
             // must be initiation
             verify( *ns == 0 );
-            hashNew = 0;
         }
 
-        /* we jump through a bunch of hoops here to avoid copying the obj buffer twice --
-           instead we do a single copy to the destination position in the memory mapped file.
-        */
-
-        logopbufbuilder.reset();
-        BSONObjBuilder b(logopbufbuilder);
-        b.appendTimestamp("ts", ts.asDate());
-        b.append("h", hashNew);
-        b.append("v", OPLOG_VERSION);
-        b.append("op", opstr);
-        b.append("ns", ns);
-        if (fromMigrate) 
-            b.appendBool("fromMigrate", true);
-        if ( bb )
-            b.appendBool("b", *bb);
-        if ( o2 )
-            b.append("o2", *o2);
-        BSONObj partial = b.done();
-        int posz = partial.objsize();
-        int len = posz + obj.objsize() + 1 + 2 /*o:*/;
-
-        Record *r;
         DEV verify( logNS == 0 );
-        {
-            const char *logns = rsoplog;
-            if ( rsOplogDetails == 0 ) {
-                Client::Context ctx(logns , dbpath);
-                localDB = ctx.db();
-                verify( localDB );
-                rsOplogDetails = nsdetails(logns);
-                massert(13347, "local.oplog.rs missing. did you drop it? if so restart server", rsOplogDetails);
-            }
-            Client::Context ctx(logns , localDB);
-            r = theDataFileMgr.fast_oplog_insert(rsOplogDetails, logns, len);
-            /* todo: now() has code to handle clock skew.  but if the skew server to server is large it will get unhappy.
-                     this code (or code in now() maybe) should be improved.
-                     */
+        const char *logns = rsoplog;
+        if ( rsOplogDetails == 0 ) {
+            Client::Context ctx(logns , dbpath);
+            localDB = ctx.db();
+            verify( localDB );
+            rsOplogDetails = nsdetails(logns);
+            massert(13347, "local.oplog.rs missing. did you drop it? if so restart server", rsOplogDetails);
+        }
+        Client::Context ctx(logns , localDB);
+
+        const OplogEntryWriter writer(true, opstr, ns, o2, bb, fromMigrate);
+        OpTime ts;
+        long long hashNew = theReplSet ? theReplSet->lastH : 0;
+        for ( size_t i = 0; i < nObjs; i++ ) {
+            ts = OpTime::now(lk2);
             if( theReplSet ) {
-                if( !(theReplSet->lastOpTimeWritten<ts) ) {
-                    log() << "replSet ERROR possible failover clock skew issue? " << theReplSet->lastOpTimeWritten << ' ' << ts << rsLog;
-                    log() << "replSet " << theReplSet->isPrimary() << rsLog;
-                }
-                theReplSet->lastOpTimeWritten = ts;
-                theReplSet->lastH = hashNew;
-                ctx.getClient()->setLastOp( ts );
+                hashNew = (hashNew * 131 + ts.asLL()) * 17 + theReplSet->selfId();
             }
-        }
 
-        append_O_Obj(r->data(), partial, obj);
+            // allocate the record and build the entry in place
+            const int len = writer.size(objs[i]);
+            DiskLoc loc;
+            Record *r = theDataFileMgr.fast_oplog_insert(rsOplogDetails, logns, len, &loc);
+            writer.write(r->data(), len, objs[i], ts, hashNew);
+            OplogStartIndex::get().noteInsert(logns, ts, loc, len);
 
-        if ( logLevel >= 6 ) {
-            LOG( 6 ) << "logOp:" << BSONObj::make(r) << endl;
+            if ( logLevel >= 6 ) {
+                LOG( 6 ) << "logOp:" << BSONObj::make(r) << endl;
+            }
+        }
+
+        /* todo: now() has code to handle clock skew.  but if the skew server to server is large it will get unhappy.
+                 this code (or code in now() maybe) should be improved.
+                 */
+        if( theReplSet && nObjs ) {
+            if( !(theReplSet->lastOpTimeWritten<ts) ) {
+                log() << "replSet ERROR possible failover clock skew issue? " << theReplSet->lastOpTimeWritten << ' ' << ts << rsLog;
+                log() << "replSet " << theReplSet->isPrimary() << rsLog;
+            }
+            theReplSet->lastOpTimeWritten = ts;
+            theReplSet->lastH = hashNew;
+            ctx.getClient()->setLastOp( ts );
         }
     }
 
-    static void _logOpOld(const char *opstr, const char *ns, const char *logNS, const BSONObj& obj, BSONObj *o2, bool *bb, bool fromMigrate ) {
+    static void _logOpsOld(const char *opstr, const char *ns, const char *logNS, const BSONObj *objs, size_t nObjs, BSONObj *o2, bool *bb, bool fromMigrate ) {
         Lock::DBWrite lk("local");
-        static BufBuilder bufbuilder(8*1024); // todo there is likely a mutex on this constructor
 
         if ( strncmp(ns, "local.", 6) == 0 ) {
             if ( strncmp(ns, "local.slaves", 12) == 0 ) {
@@ -253,32 +314,14 @@ namespace mongo {
 
         mutex::scoped_lock lk2(OpTime::m);
 
-        const OpTime ts = OpTime::now(lk2);
         Client::Context context("", 0);
 
-        /* we jump through a bunch of hoops here to avoid copying the obj buffer twice --
-           instead we do a single copy to the destination position in the memory mapped file.
-        */
-
-        bufbuilder.reset();
-        BSONObjBuilder b(bufbuilder);
-        b.appendTimestamp("ts", ts.asDate());
-        b.append("op", opstr);
-        b.append("ns", ns);
-        if (fromMigrate) 
-            b.appendBool("fromMigrate", true);
-        if ( bb )
-            b.appendBool("b", *bb);
-        if ( o2 )
-            b.append("o2", *o2);
-        BSONObj partial = b.done(); // partial is everything except the o:... part.
-
-        int po_sz = partial.objsize();
-        int len = po_sz + obj.objsize() + 1 + 2 /*o:*/;
-
-        Record *r;
+        NamespaceDetails *d;
+        bool mainOplog = false;
+        scoped_ptr<Client::Context> ctx;
         if( logNS == 0 ) {
             logNS = "local.oplog.$main";
+            mainOplog = true;
             if ( localOplogMainDetails == 0 ) {
                 Client::Context ctx(logNS , dbpath);
                 localDB = ctx.db();
@@ -286,33 +329,65 @@ namespace mongo {
                 localOplogMainDetails = nsdetails(logNS);
                 verify( localOplogMainDetails );
             }
-            Client::Context ctx(logNS , localDB);
-            r = theDataFileMgr.fast_oplog_insert(localOplogMainDetails, logNS, len);
+            ctx.reset( new Client::Context(logNS , localDB) );
+            d = localOplogMainDetails;
         }
         else {
-            Client::Context ctx(logNS, dbpath);
-            verify( nsdetails( logNS ) );
-            // first we allocate the space, then we fill it below.
-            r = theDataFileMgr.fast_oplog_insert( nsdetails( logNS ), logNS, len);
+            ctx.reset( new Client::Context(logNS, dbpath) );
+            d = nsdetails( logNS );
+            verify( d );
         }
 
-        append_O_Obj(r->data(), partial, obj);
+        const OplogEntryWriter writer(false, opstr, ns, o2, bb, fromMigrate);
+        OpTime ts;
+        for ( size_t i = 0; i < nObjs; i++ ) {
+            ts = OpTime::now(lk2);
+
+            // first we allocate the space, then we build the entry in it
+            const int len = writer.size(objs[i]);
+            DiskLoc loc;
+            Record *r = theDataFileMgr.fast_oplog_insert(d, logNS, len, &loc);
+            writer.write(r->data(), len, objs[i], ts, 0);
+            if ( mainOplog ) {
+                OplogStartIndex::get().noteInsert(logNS, ts, loc, len);
+            }
 
-        context.getClient()->setLastOp( ts );
+            LOG( 6 ) << "logging op:" << BSONObj::make(r) << endl;
+        }
 
-        LOG( 6 ) << "logging op:" << BSONObj::make(r) << endl;
+        if ( nObjs ) {
+            context.getClient()->setLastOp( ts );
+        }
     } 
 
+    static void _logOpsUninitialized(const char *opstr, const char *ns, const char *logNS, const BSONObj *objs, size_t nObjs, BSONObj *o2, bool *bb, bool fromMigrate ) {
+        _logOpUninitialized(opstr, ns, logNS, BSONObj(), o2, bb, fromMigrate);
+    }
+
+    static void _logOpRS(const char *opstr, const char *ns, const char *logNS, const BSONObj& obj, BSONObj *o2, bool *bb, bool fromMigrate ) {
+        _logOpsRS(opstr, ns, logNS, &obj, 1, o2, bb, fromMigrate);
+    }
+
+    static void _logOpOld(const char *opstr, const char *ns, const char *logNS, const BSONObj& obj, BSONObj *o2, bool *bb, bool fromMigrate ) {
+        _logOpsOld(opstr, ns, logNS, &obj, 1, o2, bb, fromMigrate);
+    }
+
     static void (*_logOp)(const char *opstr, const char *ns, const char *logNS, const BSONObj& obj, BSONObj *o2, bool *bb, bool fromMigrate ) = _logOpOld;
+    static void (*_logOps)(const char *opstr, const char *ns, const char *logNS, const BSONObj *objs, size_t nObjs, BSONObj *o2, bool *bb, bool fromMigrate ) = _logOpsOld;
     void newReplUp() {
         replSettings.master = true;
         _logOp = _logOpRS;
+        _logOps = _logOpsRS;
     }
     void newRepl() {
         replSettings.master = true;
         _logOp = _logOpUninitialized;
+        _logOps = _logOpsUninitialized;
+    }
+    void oldRepl() {
+        _logOp = _logOpOld;
+        _logOps = _logOpsOld;
     }
-    void oldRepl() { _logOp = _logOpOld; }
 
     void logKeepalive() {
         _logOp("n", "", 0, BSONObj(), 0, 0, false);
@@ -345,6 +420,19 @@ namespace mongo {
         logOpForSharding( opstr , ns , obj , patt , fullObj );
     }
 
+    void logInsertBatch(const char* ns, const vector<BSONObj>& objs, bool fromMigrate) {
+        if ( objs.empty() )
+            return;
+
+        if ( replSettings.master ) {
+            _logOps("i", ns, 0, &objs[0], objs.size(), 0, 0, fromMigrate);
+        }
+
+        for ( vector<BSONObj>::const_iterator i = objs.begin(); i != objs.end(); ++i ) {
+            logOpForSharding( "i" , ns , *i , 0 , 0 );
+        }
+    }
+
     void createOplog() {
         Lock::GlobalWrite lk;
 
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <vector>
+
 namespace mongo {
 
     class BSONObj;
@@ -58,6 +60,11 @@ namespace mongo {
                 BSONObj *patt = NULL, bool *b = NULL, bool fromMigrate = false,
                 const BSONObj* fullObj = NULL );
 
+    /** Log an insert of each of 'objs' into 'ns', like calling logOp("i", ns, obj) for each
+        of them, but taking the oplog lock and writing the entries in a single pass. */
+    void logInsertBatch( const char *ns, const std::vector<BSONObj>& objs,
+                         bool fromMigrate = false );
+
     // Log an empty no-op operation to the local oplog
     void logKeepalive();
 
@@ -0,0 +1,144 @@
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "mongo/pch.h"
+
+#include "mongo/db/repl/oplog_start_index.h"
+
+#include <limits>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/namespace_details.h"
+#include "mongo/db/pdfile.h"
+#include "mongo/db/server_parameters.h"
+
+namespace mongo {
+
+    // Approximate number of oplog bytes written between two sampled entries.
+    MONGO_EXPORT_SERVER_PARAMETER( oplogStartIndexSampleBytes, int, 1024 * 1024 );
+
+    // Upper bound on the entries kept per namespace; the oldest entries are dropped first.
+    MONGO_EXPORT_SERVER_PARAMETER( oplogStartIndexMaxEntries, int, 256 * 1024 );
+
+    OplogStartIndex::OplogStartIndex() : _mutex( "OplogStartIndex" ) {
+        for ( int i = 0; i < NumOplogs; i++ ) {
+            resetSampling( i );
+        }
+    }
+
+    OplogStartIndex& OplogStartIndex::get() {
+        static OplogStartIndex index;
+        return index;
+    }
+
+    int OplogStartIndex::oplogIndex( const StringData& ns ) {
+        static const char* const oplogs[NumOplogs] = { "local.oplog.rs", "local.oplog.$main" };
+        for ( int i = 0; i < NumOplogs; i++ ) {
+            if ( ns == oplogs[i] ) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    OplogStartIndex::NsEntries& OplogStartIndex::nsEntries( const StringData& ns ) {
+        const int i = oplogIndex( ns );
+        if ( i >= 0 ) {
+            return _oplogs[i];
+        }
+        return _namespaces[ ns.toString() ];
+    }
+
+    void OplogStartIndex::resetSampling( int i ) {
+        _bytesSinceSample[i].store( std::numeric_limits<int>::max() );
+    }
+
+    void OplogStartIndex::noteInsert( const StringData& ns, const OpTime& ts, const DiskLoc& loc,
+                                      int len ) {
+        const int i = oplogIndex( ns );
+        if ( i < 0 ) {
+            return;
+        }
+        if ( _bytesSinceSample[i].addAndFetch( len ) < oplogStartIndexSampleBytes ) {
+            return;
+        }
+
+        SimpleMutex::scoped_lock lk( _mutex );
+        _bytesSinceSample[i].store( 0 );
+        EntryMap& entries = _oplogs[i].entries;
+        entries[ ts ] = loc;
+        while ( entries.size() > static_cast<size_t>( oplogStartIndexMaxEntries ) ) {
+            entries.erase( entries.begin() );
+        }
+    }
+
+    DiskLoc OplogStartIndex::findStartBefore( const StringData& ns, NamespaceDetails* d,
+                                              const OpTime& ts, const OpTime& oldest ) {
+        SimpleMutex::scoped_lock lk( _mutex );
+        NsEntries& entriesOfNs = nsEntries( ns );
+        EntryMap& entries = entriesOfNs.entries;
+
+        // Entries older than the oldest op may refer to overwritten records.
+        entries.erase( entries.begin(), entries.lower_bound( oldest ) );
+
+        if ( !entriesOfNs.seeded || entries.empty() ) {
+            seedFromExtents( d, &entriesOfNs );
+        }
+
+        EntryMap::const_iterator i = entries.lower_bound( ts );
+        if ( i == entries.begin() ) {
+            return DiskLoc();
+        }
+        --i;
+        return i->second;
+    }
+
+    void OplogStartIndex::invalidate( const StringData& ns ) {
+        SimpleMutex::scoped_lock lk( _mutex );
+        const int i = oplogIndex( ns );
+        if ( i < 0 ) {
+            _namespaces.erase( ns.toString() );
+            return;
+        }
+        _oplogs[i] = NsEntries();
+        resetSampling( i );
+    }
+
+    void OplogStartIndex::invalidateAll() {
+        SimpleMutex::scoped_lock lk( _mutex );
+        for ( int i = 0; i < NumOplogs; i++ ) {
+            _oplogs[i] = NsEntries();
+            resetSampling( i );
+        }
+        _namespaces.clear();
+    }
+
+    void OplogStartIndex::seedFromExtents( NamespaceDetails* d, NsEntries* nsEntries ) {
+        nsEntries->seeded = true;
+        for ( DiskLoc ext = d->firstExtent; !ext.isNull(); ext = ext.ext()->xnext ) {
+            DiskLoc first = ext.ext()->firstRecord;
+            if ( first.isNull() ) {
+                continue;
+            }
+            BSONElement tsElt = first.obj()[ "ts" ];
+            if ( tsElt.type() != Timestamp && tsElt.type() != Date ) {
+                continue;
+            }
+            nsEntries->entries.insert( make_pair( tsElt._opTime(), first ) );
+        }
+    }
+
+} // namespace mongo
@@ -0,0 +1,119 @@
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/db/diskloc.h"
+#include "mongo/db/repl/optime.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/concurrency/mutex.h"
+
+namespace mongo {
+
+    class NamespaceDetails;
+
+    /**
+     * A sparse, in memory index from oplog optime to record location, used by FindingStartCursor
+     * to jump close to the first op matching an oplogReplay query instead of scanning backward
+     * through the oplog.
+     *
+     * Entries are sampled by logOp() roughly every 'oplogStartIndexSampleBytes' of oplog written,
+     * and the first record of every extent is added lazily when a namespace is first consulted
+     * (or has no live entries left), so the index is useful immediately after startup.  Only the
+     * oplogs logOp() writes are sampled; other capped collections queried with oplogReplay only
+     * get the extent entries.
+     *
+     * An entry is only trusted if its optime is not older than the oldest op still in the oplog:
+     * records are only ever removed from the old end of a capped collection, so any entry at least
+     * as new as the oldest op still refers to a live record.  Removing ops from the new end
+     * (cappedTruncateAfter during rollback, emptyCappedCollection during initial sync) must call
+     * invalidate().
+     *
+     * All methods are thread safe.
+     */
+    class OplogStartIndex {
+        MONGO_DISALLOW_COPYING(OplogStartIndex);
+    public:
+        OplogStartIndex();
+
+        /**
+         * Record that the op 'ts' of 'len' bytes was written at 'loc' in the oplog 'ns'.  Only
+         * takes the mutex for the sampled ops.
+         */
+        void noteInsert( const StringData& ns, const OpTime& ts, const DiskLoc& loc, int len );
+
+        /**
+         * @return the location of the newest indexed op of 'ns' strictly older than 'ts' and no
+         * older than 'oldest', or a null DiskLoc if there is no such op.  Entries older than
+         * 'oldest' are discarded.  Seeds the index from the extents of 'd' if necessary.
+         * Caller must hold at least a read lock on 'ns'.
+         */
+        DiskLoc findStartBefore( const StringData& ns, NamespaceDetails* d,
+                                 const OpTime& ts, const OpTime& oldest );
+
+        /** Discard all entries for 'ns'. */
+        void invalidate( const StringData& ns );
+
+        /** Discard all entries. */
+        void invalidateAll();
+
+        /** The index shared by logOp() and FindingStartCursor. */
+        static OplogStartIndex& get();
+
+    private:
+        typedef std::map<OpTime, DiskLoc> EntryMap;
+
+        struct NsEntries {
+            NsEntries() : seeded() {}
+            EntryMap entries;
+            bool seeded;
+        };
+
+        typedef std::map<std::string, NsEntries> NsMap;
+
+        // local.oplog.rs and local.oplog.$main
+        static const int NumOplogs = 2;
+
+        /** @return the position of 'ns' in _oplogs, or -1 if logOp() doesn't write it */
+        static int oplogIndex( const StringData& ns );
+
+        /** @return the entries of 'ns'.  Requires _mutex. */
+        NsEntries& nsEntries( const StringData& ns );
+
+        /** Makes the next op noted in the oplog at 'i' a sampled one. */
+        void resetSampling( int i );
+
+        /** Add the first record of every extent of 'd' to 'nsEntries'.  Requires _mutex. */
+        static void seedFromExtents( NamespaceDetails* d, NsEntries* nsEntries );
+
+        SimpleMutex _mutex;
+
+        // entries of the oplogs, by oplogIndex()
+        NsEntries _oplogs[NumOplogs];
+
+        // bytes noted in each oplog since its last sampled entry, updated without _mutex
+        AtomicInt64 _bytesSinceSample[NumOplogs];
+
+        // other capped collections queried with oplogReplay
+        NsMap _namespaces;
+    };
+
+} // namespace mongo
@@ -24,6 +24,7 @@
 #include "mongo/db/cmdline.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/dbwebserver.h"
+#include "mongo/db/repl/bgsync.h"
 #include "mongo/db/repl/health.h"
 #include "mongo/db/repl/replication_server_status.h"  // replSettings
 #include "mongo/db/repl/rs.h"
@@ -393,6 +394,61 @@ namespace mongo {
         }
     } cmdReplSetSyncFrom;
 
+    class CmdReplSetUpdatePosition: public ReplSetCommand {
+    public:
+        virtual void help( stringstream &help ) const {
+            help << "internal, not for general use\n";
+            help << "{ replSetUpdatePosition : 1, optimes : [ { _id : <rid>, optime : <ts>,"
+                    " memberId : <id>, config : <member config> }, ... ] }\n";
+            help << "Report the positions of this member and the members chained through it.";
+        }
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::replSetUpdatePosition);
+            out->push_back(Privilege(AuthorizationManager::SERVER_RESOURCE_NAME, actions));
+        }
+        CmdReplSetUpdatePosition() : ReplSetCommand("replSetUpdatePosition") { }
+        virtual bool run(const string&,
+                         BSONObj& cmdObj,
+                         int,
+                         string& errmsg,
+                         BSONObjBuilder& result,
+                         bool fromRepl) {
+            if (!check(errmsg, result)) {
+                return false;
+            }
+            if (cmdObj["optimes"].type() != Array) {
+                errmsg = "optimes must be an array";
+                return false;
+            }
+
+            const bool primary = theReplSet->isPrimary();
+            BSONObjIterator i(cmdObj["optimes"].Obj());
+            while (i.more()) {
+                BSONObj entry = i.next().Obj();
+                BSONElement ts = entry["optime"];
+                if (entry["_id"].type() != jstOID || ts.type() != Timestamp ||
+                    !entry["memberId"].isNumber() || entry["config"].type() != Object) {
+                    errmsg = str::stream() << "invalid position entry: " << entry;
+                    return false;
+                }
+
+                const OID rid = entry["_id"].OID();
+                BSONObj ridObj = BSON("_id" << rid);
+                theReplSet->registerSlave(ridObj, entry["memberId"].numberInt());
+                theReplSet->ghost->noteReportsPosition(rid);
+                updateSlavePosition(ridObj, entry["config"].Obj(), ts._opTime());
+
+                if (!primary) {
+                    replset::BackgroundSync::get()->forwardSlavePosition(rid, entry);
+                }
+            }
+            return true;
+        }
+    } cmdReplSetUpdatePosition;
+
     using namespace bson;
     using namespace mongoutils::html;
     extern void fillRsLog(stringstream&);
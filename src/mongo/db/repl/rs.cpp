@@ -577,6 +577,13 @@ namespace mongo {
             additive = false;
         }
 
+        // Heartbeat tasks only pick up their timing when they are started.
+        if (reconf && (config().getHeartbeatInterval() != c.getHeartbeatInterval() ||
+                       config().getHeartbeatTimeout() != c.getHeartbeatTimeout() ||
+                       config().getElectionTimeout() != c.getElectionTimeout())) {
+            additive = false;
+        }
+
         _cfg = new ReplSetConfig(c);
         dassert( &config() == _cfg ); // config() is same thing but const, so we use that when we can for clarity below
         verify( config().ok() );
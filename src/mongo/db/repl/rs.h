@@ -114,11 +114,14 @@ namespace mongo {
 
     class GhostSync : public task::Server {
         struct GhostSlave : boost::noncopyable {
-            GhostSlave() : last(0), slave(0), init(false) { }
+            GhostSlave() : last(0), slave(0), init(false), reportsPosition(false) { }
             OplogReader reader;
             OpTime last;
             Member* slave;
             bool init;
+            // the slave sends replSetUpdatePosition, so its position is forwarded by the
+            // notifier thread rather than percolated
+            bool reportsPosition;
         };
         /**
          * This is a cache of ghost slaves
@@ -151,6 +154,7 @@ namespace mongo {
         void percolate(const BSONObj& rid, const OpTime& last);
         void associateSlave(const BSONObj& rid, const int memberId);
         void updateSlave(const mongo::OID& id, const OpTime& last);
+        void noteReportsPosition(const mongo::OID& id);
         void clearCache();
     };
 
@@ -34,6 +34,7 @@ namespace mongo {
 
     mongo::mutex ReplSetConfig::groupMx("RS tag group");
     const int ReplSetConfig::DEFAULT_HB_TIMEOUT = 10;
+    const int ReplSetConfig::DEFAULT_HB_INTERVAL_MILLIS = 2000;
 
     void logOpInitiate(const bo&);
 
@@ -143,6 +144,16 @@ namespace mongo {
             empty = false;
         }
 
+        if (_heartbeatInterval != DEFAULT_HB_INTERVAL_MILLIS) {
+            settings << "heartbeatIntervalMillis" << _heartbeatInterval;
+            empty = false;
+        }
+
+        if (_electionTimeout != 0) {
+            settings << "electionTimeoutMillis" << _electionTimeout;
+            empty = false;
+        }
+
         if (!_chainingAllowed) {
             settings << "chainingAllowed" << _chainingAllowed;
             empty = false;
@@ -582,6 +593,18 @@ namespace mongo {
                 _heartbeatTimeout = timeout;
             }
 
+            if (settings.hasField("heartbeatIntervalMillis")) {
+                int interval = settings["heartbeatIntervalMillis"].numberInt();
+                uassert(16812, "Heartbeat interval must be positive", interval > 0);
+                _heartbeatInterval = interval;
+            }
+
+            if (settings.hasField("electionTimeoutMillis")) {
+                int timeout = settings["electionTimeoutMillis"].numberInt();
+                uassert(16813, "Election timeout must be positive", timeout > 0);
+                _electionTimeout = timeout;
+            }
+
             // If the config explicitly sets chaining to false, turn it off.
             if (settings.hasField("chainingAllowed") &&
                 !settings["chainingAllowed"].trueValue()) {
@@ -601,6 +624,17 @@ namespace mongo {
         return _heartbeatTimeout;
     }
 
+    int ReplSetConfig::getHeartbeatInterval() const {
+        return _heartbeatInterval;
+    }
+
+    int ReplSetConfig::getElectionTimeout() const {
+        if (_electionTimeout != 0) {
+            return _electionTimeout;
+        }
+        return (_heartbeatTimeout > 0 ? _heartbeatTimeout : DEFAULT_HB_TIMEOUT) * 1000;
+    }
+
     static inline void configAssert(bool expr) {
         uassert(13122, "bad repl set config?", expr);
     }
@@ -610,7 +644,9 @@ namespace mongo {
         _chainingAllowed(true),
         _majority(-1),
         _ok(false),
-        _heartbeatTimeout(DEFAULT_HB_TIMEOUT) {
+        _heartbeatTimeout(DEFAULT_HB_TIMEOUT),
+        _heartbeatInterval(DEFAULT_HB_INTERVAL_MILLIS),
+        _electionTimeout(0) {
     }
 
     ReplSetConfig* ReplSetConfig::make(BSONObj cfg, bool force) {
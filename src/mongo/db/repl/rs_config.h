@@ -170,6 +170,24 @@ namespace mongo {
          */
         static const int DEFAULT_HB_TIMEOUT;
 
+        /**
+         * Get the pause between heartbeats to each member, in milliseconds.
+         */
+        int getHeartbeatInterval() const;
+
+        /**
+         * Default interval: 2 seconds
+         */
+        static const int DEFAULT_HB_INTERVAL_MILLIS;
+
+        /**
+         * Get the election timeout, in milliseconds.  A heartbeat that has not been answered
+         * within this time fails, so a member that stops responding is considered down and an
+         * election can start.  Election pacing (vote leases, tie breaking) scales with it.
+         * Defaults to the heartbeat timeout.
+         */
+        int getElectionTimeout() const;
+
         /**
          * Returns if replication chaining is allowed.
          */
@@ -198,6 +216,16 @@ namespace mongo {
          */
         int _heartbeatTimeout;
 
+        /**
+         * The pause between heartbeats, in milliseconds
+         */
+        int _heartbeatInterval;
+
+        /**
+         * The election timeout, in milliseconds, or 0 if not set
+         */
+        int _electionTimeout;
+
         /**
          * This is a logical grouping of servers.  It is pointed to by a set of
          * servers with a certain tag.
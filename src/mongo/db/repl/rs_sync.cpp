@@ -817,6 +817,14 @@ namespace replset {
         }
     }
 
+    void GhostSync::noteReportsPosition(const mongo::OID& rid) {
+        rwlock lk( _lock , false );
+        MAP::iterator i = _ghostCache.find( rid );
+        if ( i != _ghostCache.end() ) {
+            i->second->reportsPosition = true;
+        }
+    }
+
     void GhostSync::updateSlave(const mongo::OID& rid, const OpTime& last) {
         rwlock lk( _lock , false );
         MAP::iterator i = _ghostCache.find( rid );
@@ -854,6 +862,12 @@ namespace replset {
         }
         verify(slave->slave);
 
+        if (slave->reportsPosition &&
+            replset::BackgroundSync::get()->syncTargetTakesPositions()) {
+            // the notifier thread forwards this slave's replSetUpdatePosition reports
+            return;
+        }
+
         const Member *target = replset::BackgroundSync::get()->getSyncTarget();
         if (!target || rs->box.getState().primary()
             // we are currently syncing from someone who's syncing from us
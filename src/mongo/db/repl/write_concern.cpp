@@ -21,6 +21,7 @@
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/repl/is_master.h"
+#include "mongo/db/repl/oplog.h"
 #include "mongo/util/background.h"
 #include "mongo/util/mongoutils/str.h"
 
@@ -103,8 +104,6 @@ namespace mongo {
                     db.update( NS , i->first , i->second , true );
                 }
                 _currentlyUpdatingCache = false;
-
-                _threadsWaitingForReplication.notify_all();
             }
         }
 
@@ -135,16 +134,35 @@ namespace mongo {
                 go();
             }
             
-            _threadsWaitingForReplication.notify_all();
+            _notifyWaiters_inlock( last );
         }
 
         bool opReplicatedEnough( OpTime op , BSONElement w ) {
+            scoped_lock mylk(_mutex);
+            return _opReplicatedEnough_inlock( op, w );
+        }
+
+        /**
+         * Block until a slave update may have replicated op to w servers, or until
+         * maxMillisToWait elapses.  Returns immediately if op is already replicated enough.
+         */
+        void awaitReplicationProgress( OpTime& op, BSONElement w, int maxMillisToWait ) {
+            boost::condition waiter;
+            scoped_lock mylk(_mutex);
+            if ( _opReplicatedEnough_inlock( op, w ) )
+                return;
+            WaiterMap::iterator i = _waiters.insert( make_pair( op, &waiter ) );
+            waiter.timed_wait( mylk.boost(), boost::posix_time::milliseconds( maxMillisToWait ) );
+            _waiters.erase( i );
+        }
+
+        bool _opReplicatedEnough_inlock( OpTime& op , BSONElement w ) {
             RARELY {
                 REPLDEBUG( "looking for : " << op << " w=" << w );
             }
 
             if (w.isNumber()) {
-                return replicatedToNum(op, w.numberInt());
+                return _replicatedToNum_inlock(op, w.numberInt());
             }
 
             uassert( 16250 , "w has to be a string or a number" , w.type() == String );
@@ -157,7 +175,7 @@ namespace mongo {
             if (wStr == "majority") {
                 // use the entire set, including arbiters, to prevent writing
                 // to a majority of the set but not a majority of voters
-                return replicatedToNum(op, theReplSet->config().getMajority());
+                return _replicatedToNum_inlock(op, theReplSet->config().getMajority());
             }
 
             map<string,ReplSetConfig::TagRule*>::const_iterator it = theReplSet->config().rules.find(wStr);
@@ -168,13 +186,17 @@ namespace mongo {
         }
 
         bool replicatedToNum(OpTime& op, int w) {
+            scoped_lock mylk(_mutex);
+            return _replicatedToNum_inlock( op, w );
+        }
+
+        bool _replicatedToNum_inlock(OpTime& op, int w) {
             massert( 16805, "replicatedToNum called but not master anymore", _isMaster() );
 
             if ( w <= 1 )
                 return true;
 
             w--; // now this is the # of slaves i need
-            scoped_lock mylk(_mutex);
             return _replicatedToNum_slaves_locked( op, w );
         }
 
@@ -192,9 +214,13 @@ namespace mongo {
             boost::xtime_get(&xt, MONGO_BOOST_TIME_UTC);
             xt.sec += maxSecondsToWait;
             
+            boost::condition waiter;
             scoped_lock mylk(_mutex);
             while ( ! _replicatedToNum_slaves_locked( op, w ) ) {
-                if ( ! _threadsWaitingForReplication.timed_wait( mylk.boost() , xt ) ) {
+                WaiterMap::iterator i = _waiters.insert( make_pair( op, &waiter ) );
+                bool notified = waiter.timed_wait( mylk.boost() , xt );
+                _waiters.erase( i );
+                if ( ! notified ) {
                     massert(noLongerMasterAssertCode,
                             "waitForReplication called but not master anymore", _isMaster());
                     return false;
@@ -205,6 +231,17 @@ namespace mongo {
             return true;
         }
 
+        /**
+         * Wake the threads waiting for ops no newer than 'last', the only ones a slave reaching
+         * 'last' can satisfy.
+         */
+        void _notifyWaiters_inlock( const OpTime& last ) {
+            WaiterMap::iterator end = _waiters.upper_bound( last );
+            for ( WaiterMap::iterator i = _waiters.begin(); i != end; ++i ) {
+                i->second->notify_one();
+            }
+        }
+
         bool _replicatedToNum_slaves_locked(OpTime& op, int numSlaves ) {
             for ( map<Ident,OpTime>::iterator i=_slaves.begin(); i!=_slaves.end(); i++) {
                 OpTime s = i->second;
@@ -242,7 +279,10 @@ namespace mongo {
 
         // need to be careful not to deadlock with this
         mutable mongo::mutex _mutex;
-        boost::condition _threadsWaitingForReplication;
+
+        // threads blocked until replication reaches an optime, keyed by that optime
+        typedef multimap<OpTime,boost::condition*> WaiterMap;
+        WaiterMap _waiters;
 
         map<Ident,OpTime> _slaves;
         bool _dirty;
@@ -284,6 +324,12 @@ namespace mongo {
         }
     }
 
+    void updateSlavePosition( const BSONObj& rid , const BSONObj& config , OpTime lastOp ) {
+        if ( lastOp.isNull() )
+            return;
+        slaveTracking.update( rid , config , rsoplog , lastOp );
+    }
+
     bool opReplicatedEnough( OpTime op , BSONElement w ) {
         return slaveTracking.opReplicatedEnough( op , w );
     }
@@ -296,6 +342,10 @@ namespace mongo {
         return slaveTracking.waitForReplication( op, w, maxSecondsToWait );
     }
 
+    void awaitReplicationProgress( OpTime op , BSONElement w , int maxMillisToWait ) {
+        slaveTracking.awaitReplicationProgress( op, w, maxMillisToWait );
+    }
+
     vector<BSONObj> getHostsWrittenTo(OpTime& op) {
         return slaveTracking.getHostsAtOp(op);
     }
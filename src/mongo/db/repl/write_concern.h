@@ -31,12 +31,22 @@ namespace mongo {
 
     void updateSlaveLocation( CurOp& curop, const char * oplog_ns , OpTime lastOp );
 
+    /** Record a replica set member's position reported through replSetUpdatePosition. */
+    void updateSlavePosition( const BSONObj& rid , const BSONObj& config , OpTime lastOp );
+
     /** @return true if op has made it to w servers */
     bool opReplicatedEnough( OpTime op , int w );
     bool opReplicatedEnough( OpTime op , BSONElement w );
 
     bool waitForReplication( OpTime op , int w , int maxSecondsToWait );
 
+    /**
+     * Block until a slave position update may have replicated op to the servers described by w,
+     * or until maxMillisToWait elapses.  Returns immediately if op is already replicated enough.
+     * Callers re-check opReplicatedEnough() afterwards.
+     */
+    void awaitReplicationProgress( OpTime op , BSONElement w , int maxMillisToWait );
+
     std::vector<BSONObj> getHostsWrittenTo(OpTime& op);
 
     void resetSlaveCache();
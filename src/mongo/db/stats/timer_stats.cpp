@@ -17,6 +17,8 @@
 
 #include "mongo/db/stats/timer_stats.h"
 
+#include "mongo/util/mongoutils/str.h"
+
 namespace mongo {
 
     TimerHolder::TimerHolder( TimerStats* stats )
@@ -59,4 +61,45 @@ namespace mongo {
         return b.obj();
 
     }
+
+    Histogram::Options TimerHistogram::options() {
+        Histogram::Options opts;
+        opts.numBuckets = 16;
+        opts.bucketSize = 1;
+        opts.exponential = true;
+        return opts;
+    }
+
+    TimerHistogram::TimerHistogram() : _histogram( options() ) {
+    }
+
+    void TimerHistogram::recordMillis( int millis ) {
+        scoped_spinlock lk( _lock );
+        _histogram.insert( millis < 0 ? 0 : millis );
+    }
+
+    int TimerHistogram::record( const Timer& timer ) {
+        int millis = timer.millis();
+        recordMillis( millis );
+        return millis;
+    }
+
+    BSONObj TimerHistogram::getReport() const {
+        const uint32_t numBuckets = _histogram.getBucketsNum();
+        vector<long long> counts( numBuckets );
+        {
+            scoped_spinlock lk( _lock );
+            for ( uint32_t i = 0; i < numBuckets; i++ ) {
+                counts[i] = _histogram.getCount( i );
+            }
+        }
+        BSONObjBuilder b(256);
+        for ( uint32_t i = 0; i < numBuckets - 1; i++ ) {
+            string name = mongoutils::str::stream() << "<=" << _histogram.getBoundary( i );
+            b.appendNumber( name, counts[i] );
+        }
+        string overflow = mongoutils::str::stream() << ">" << _histogram.getBoundary( numBuckets - 2 );
+        b.appendNumber( overflow, counts[numBuckets - 1] );
+        return b.obj();
+    }
 }
@@ -19,6 +19,7 @@
 
 #include "mongo/db/jsobj.h"
 #include "mongo/util/concurrency/spin_lock.h"
+#include "mongo/util/histogram.h"
 #include "mongo/util/timer.h"
 
 namespace mongo {
@@ -47,6 +48,31 @@ namespace mongo {
         long long _totalMillis;
     };
 
+    /**
+     * Holds the distribution of timings in milliseconds
+     * buckets double in width: <=1, <=2, <=4, ... ms
+     */
+    class TimerHistogram {
+    public:
+        TimerHistogram();
+
+        void recordMillis( int millis );
+
+        /**
+         * @return number of millis
+         */
+        int record( const Timer& timer );
+
+        BSONObj getReport() const;
+        operator BSONObj() const { return getReport(); }
+
+    private:
+        static Histogram::Options options();
+
+        mutable SpinLock _lock;
+        Histogram _histogram;
+    };
+
     /**
      * Holds an instance of a Timer such that we the time is recorded
      * when the TimerHolder goes out of scope
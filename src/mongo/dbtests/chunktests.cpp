@@ -32,6 +32,7 @@ namespace mongo {
         }
         void setSingleChunkForShards( const vector<BSONObj> &splitPoints ) {
             ChunkMap &chunkMap = const_cast<ChunkMap&>( _chunkMap );
+            ChunkRoutingTable &routingTable = const_cast<ChunkRoutingTable&>( _routingTable );
             ChunkRangeManager &chunkRanges = const_cast<ChunkRangeManager&>( _chunkRanges );
             set<Shard> &shards = const_cast<set<Shard>&>( _shards );
             
@@ -49,6 +50,7 @@ namespace mongo {
                 chunkMap[ mySplitPoints[ i ] ] = chunk;
             }
             
+            routingTable.reloadAll( chunkMap );
             chunkRanges.reloadAll( chunkMap );
         }
     };
@@ -236,6 +238,111 @@ namespace ChunkTests {
             }
         };
 
+        /** Keys are routed to the chunk whose [min, max) range contains them. */
+        class FindIntersectingChunk {
+        public:
+            void run() {
+                ChunkManager chunkManager;
+                chunkManager.setShardKey( BSON( "a" << 1 ) );
+
+                vector<BSONObj> splitPoints;
+                for ( int i = 0; i < 100; ++i ) {
+                    splitPoints.push_back( BSON( "a" << i * 10 ) );
+                }
+                chunkManager.setSingleChunkForShards( splitPoints );
+                ASSERT_EQUALS( 101, chunkManager.numChunks() );
+
+                ASSERT_EQUALS( "0", chunkManager.findIntersectingChunk( BSON( "a" << MINKEY ) )->
+                                        getShard().getName() );
+                ASSERT_EQUALS( "0", chunkManager.findIntersectingChunk( BSON( "a" << -5 ) )->
+                                        getShard().getName() );
+                for ( int i = 0; i < 1000; i += 7 ) {
+                    // {a: i} is in [ {a: (i / 10) * 10}, {a: (i / 10 + 1) * 10} )
+                    string expected = BSONObjBuilder::numStr( i / 10 + 1 );
+                    ChunkPtr chunk = chunkManager.findIntersectingChunk( BSON( "a" << i ) );
+                    ASSERT_EQUALS( expected, chunk->getShard().getName() );
+                    ASSERT( chunk->containsPoint( BSON( "a" << i ) ) );
+                }
+                ASSERT_EQUALS( "100", chunkManager.findIntersectingChunk( BSON( "a" << 5000 ) )->
+                                          getShard().getName() );
+            }
+        };
+
+        /** Routing keys never order two shard key values the other way round from BSON. */
+        class RoutingKeyOrder {
+        public:
+            void run() {
+                vector<BSONObj> values;
+                values.push_back( BSON( "a" << MINKEY ) );
+                values.push_back( BSON( "a" << BSONNULL ) );
+                values.push_back( BSON( "a" << std::numeric_limits<double>::quiet_NaN() ) );
+                values.push_back( BSON( "a" << -std::numeric_limits<double>::infinity() ) );
+                values.push_back( BSON( "a" << -1e300 ) );
+                values.push_back( BSON( "a" << -5LL ) );
+                values.push_back( BSON( "a" << -0.5 ) );
+                values.push_back( BSON( "a" << -0.0 ) );
+                values.push_back( BSON( "a" << 0 ) );
+                values.push_back( BSON( "a" << 0 << "b" << 1 ) );
+                values.push_back( BSON( "a" << 1 ) );
+                values.push_back( BSON( "a" << 1LL << "b" << 2 ) );
+                values.push_back( BSON( "a" << 1.5 ) );
+                values.push_back( BSON( "a" << ( 1LL << 62 ) ) );
+                values.push_back( BSON( "a" << ( 1LL << 62 ) + 1 ) );
+                values.push_back( BSON( "a" << std::numeric_limits<double>::infinity() ) );
+                values.push_back( BSON( "a" << "" ) );
+                values.push_back( BSON( "a" << "abc" ) );
+                values.push_back( BSON( "a" << BSON( "x" << 1 ) ) );
+                values.push_back( BSON( "a" << OID() ) );
+                values.push_back( BSON( "a" << true ) );
+                values.push_back( BSON( "a" << MAXKEY ) );
+
+                for ( unsigned i = 0; i < values.size(); ++i ) {
+                    for ( unsigned j = 0; j < values.size(); ++j ) {
+                        if ( ChunkRoutingTable::routingKey( values[i] ) <
+                             ChunkRoutingTable::routingKey( values[j] ) ) {
+                            ASSERT( values[i].woCompare( values[j] ) < 0 );
+                        }
+                    }
+                }
+
+                ASSERT( ChunkRoutingTable::routingKey( values[4] ) <
+                        ChunkRoutingTable::routingKey( values[5] ) );
+                ASSERT_EQUALS( ChunkRoutingTable::routingKey( values[7] ),
+                               ChunkRoutingTable::routingKey( values[8] ) );
+            }
+        };
+
+        /** Compound keys sharing their first field are routed by the rest of the key. */
+        class FindIntersectingChunkCompound {
+        public:
+            void run() {
+                ChunkManager chunkManager;
+                chunkManager.setShardKey( BSON( "a" << 1 << "b" << 1 ) );
+
+                vector<BSONObj> splitPoints;
+                for ( int i = 0; i < 10; ++i ) {
+                    splitPoints.push_back( BSON( "a" << 5 << "b" << i * 10 ) );
+                }
+                chunkManager.setSingleChunkForShards( splitPoints );
+
+                ASSERT_EQUALS( "0", chunkManager.findIntersectingChunk(
+                                        BSON( "a" << 4 << "b" << 1000 ) )->getShard().getName() );
+                ASSERT_EQUALS( "0", chunkManager.findIntersectingChunk(
+                                        BSON( "a" << 5 << "b" << -1 ) )->getShard().getName() );
+                for ( int i = 0; i < 100; i += 3 ) {
+                    string expected = BSONObjBuilder::numStr( i / 10 + 1 );
+                    BSONObj point = BSON( "a" << 5 << "b" << i );
+                    ChunkPtr chunk = chunkManager.findIntersectingChunk( point );
+                    ASSERT_EQUALS( expected, chunk->getShard().getName() );
+                    ASSERT( chunk->containsPoint( point ) );
+                }
+                ASSERT_EQUALS( "10", chunkManager.findIntersectingChunk(
+                                         BSON( "a" << 6 << "b" << 0 ) )->getShard().getName() );
+                ASSERT_EQUALS( "10", chunkManager.findIntersectingChunk(
+                                         BSON( "a" << "x" << "b" << 0 ) )->getShard().getName() );
+            }
+        };
+
     } // namespace ChunkManagerTests
     
     class All : public Suite {
@@ -264,6 +371,9 @@ namespace ChunkTests {
             add<ChunkManagerTests::InequalityThenUnsatisfiable>();
             add<ChunkManagerTests::OrEqualityUnsatisfiableInequality>();
             add<ChunkManagerTests::InMultiShard>();
+            add<ChunkManagerTests::FindIntersectingChunk>();
+            add<ChunkManagerTests::RoutingKeyOrder>();
+            add<ChunkManagerTests::FindIntersectingChunkCompound>();
         }
     } myall;
     
@@ -83,6 +83,125 @@ namespace CommandTests {
         };
     }
 
+    namespace SplitVector {
+        /** 20000 documents with x from 0 to 19999, split every 2000 keys. */
+        class Base {
+        public:
+            Base() {
+                db.dropCollection( ns() );
+                db.ensureIndex( ns(), BSON( "x" << 1 ) );
+                for ( int i = 0; i < N; i++ ) {
+                    db.insert( ns(), BSON( "_id" << i << "x" << i ) );
+                }
+                BSONObj stats;
+                ASSERT( db.runCommand( "unittests", BSON( "collstats" << "splitvector" ), stats ) );
+                _avgObjSize = stats["size"].numberLong() / stats["count"].numberLong();
+            }
+            ~Base() {
+                db.dropCollection( ns() );
+            }
+
+        protected:
+            static const char* ns() { return "unittests.splitvector"; }
+            static const int N = 20000;
+            static const int KeysPerChunk = 2000;
+
+            /** @return the x values of the split keys splitVector picks for [min, max) */
+            vector<int> splitPoints( int min, int max, const BSONObj& options, BSONObj* res ) {
+                BSONObjBuilder cmd;
+                cmd.append( "splitVector", ns() );
+                cmd.append( "keyPattern", BSON( "x" << 1 ) );
+                cmd.append( "min", BSON( "x" << min ) );
+                cmd.append( "max", BSON( "x" << max ) );
+                cmd.append( "maxChunkSizeBytes", 2 * KeysPerChunk * _avgObjSize );
+                cmd.appendElements( options );
+                ASSERT( db.runCommand( "admin", cmd.obj(), *res ) );
+
+                vector<int> points;
+                BSONObjIterator it( res->getObjectField( "splitKeys" ) );
+                while ( it.more() ) {
+                    points.push_back( it.next().Obj()["x"].numberInt() );
+                }
+                return points;
+            }
+
+            DBDirectClient db;
+
+        private:
+            long long _avgObjSize;
+        };
+
+        /** Sampled split points give chunks close to the size the exact scan gives. */
+        class SampledMatchesScan : public Base {
+        public:
+            void run() {
+                BSONObj exactRes;
+                vector<int> exact = splitPoints( 0, N, BSONObj(), &exactRes );
+                ASSERT_EQUALS( N, exactRes["keysExamined"].numberInt() );
+                ASSERT( exactRes["sample"].eoo() );
+                ASSERT_EQUALS( static_cast<size_t>( N / KeysPerChunk - 1 ), exact.size() );
+
+                BSONObj sampledRes;
+                vector<int> sampled = splitPoints( 0, N, BSON( "sampleSize" << 4000 ), &sampledRes );
+                BSONObj sample = sampledRes["sample"].Obj();
+                ASSERT_EQUALS( 4000, sample["size"].numberInt() );
+                ASSERT( sample["bucketsRead"].numberLong() > 0 );
+                ASSERT( sampledRes["keysExamined"].eoo() );
+
+                // the key count estimate is within 10%
+                long long estimatedKeys = sample["estimatedKeys"].numberLong();
+                ASSERT( estimatedKeys > N * 9 / 10 );
+                ASSERT( estimatedKeys < N * 11 / 10 );
+
+                // ~400 samples per chunk gives each chunk size an error of about 5%, allow 30%
+                double error = sample["expectedChunkSizeError"].numberDouble();
+                ASSERT( error > 0.02 );
+                ASSERT( error < 0.1 );
+
+                ASSERT( sampled.size() + 1 >= exact.size() );
+                ASSERT( sampled.size() <= exact.size() + 1 );
+                int prev = 0;
+                for ( size_t i = 0; i < sampled.size(); i++ ) {
+                    int chunkKeys = sampled[i] - prev;
+                    ASSERT( chunkKeys > KeysPerChunk * 7 / 10 );
+                    ASSERT( chunkKeys < KeysPerChunk * 13 / 10 );
+                    prev = sampled[i];
+                }
+            }
+        };
+
+        /** A range holding fewer keys than the sample size is scanned exactly. */
+        class SmallRangeScans : public Base {
+        public:
+            void run() {
+                BSONObj exactRes;
+                vector<int> exact = splitPoints( 1000, 7000, BSONObj(), &exactRes );
+
+                BSONObj sampledRes;
+                vector<int> sampled = splitPoints( 1000, 7000, BSON( "sampleSize" << 10000 ),
+                                                   &sampledRes );
+                ASSERT( sampledRes["sample"].eoo() );
+                ASSERT_EQUALS( 6000, sampledRes["keysExamined"].numberInt() );
+                ASSERT( exact == sampled );
+            }
+        };
+
+        /** A forced sampled split lands near the middle of the range. */
+        class SampledForce : public Base {
+        public:
+            void run() {
+                BSONObj res;
+                vector<int> points = splitPoints( 0, N / 2,
+                                                  BSON( "force" << true << "sampleSize" << 2000 ),
+                                                  &res );
+                ASSERT( ! res["sample"].eoo() );
+                ASSERT( ! points.empty() );
+                ASSERT( points[0] > N / 4 * 8 / 10 );
+                ASSERT( points[0] < N / 4 * 12 / 10 );
+            }
+        };
+    }
+
     class All : public Suite {
     public:
         All() : Suite( "commands" ) {
@@ -91,6 +210,9 @@ namespace CommandTests {
         void setupTests() {
             add< FileMD5::Type0 >();
             add< FileMD5::Type2 >();
+            add< SplitVector::SampledMatchesScan >();
+            add< SplitVector::SmallRangeScans >();
+            add< SplitVector::SampledForce >();
         }
 
     } all;
@@ -1141,7 +1141,7 @@ namespace DocumentSourceTests {
                     sort()->addToBsonArray(&arr, false);
                     ASSERT_EQUALS(arr.arr(), BSON_ARRAY(BSON("$sort" << BSON("a" << 1))));
 
-                    ASSERT(sort()->getShardSource() == NULL);
+                    ASSERT(sort()->getShardSource() != NULL);
                     ASSERT(sort()->getRouterSource() != NULL);
                 }
 
@@ -1421,6 +1421,46 @@ namespace DocumentSourceTests {
             BSONObj sortSpec() { return BSON( "a.b" << 1 ); }
         };
 
+        /** The router half of a split sort merges the shards' presorted output. */
+        class MergePresorted : public Base {
+        public:
+            void run() {
+                DocumentSourceCommandShards::ShardOutput shardOutput;
+                shardOutput[ Shard( "shard0", "localhost:30000" ) ] =
+                        fromjson( "{ok:1,result:[{a:1},{a:4},{a:7}]}" );
+                shardOutput[ Shard( "shard1", "localhost:30001" ) ] =
+                        fromjson( "{ok:1,result:[]}" );
+                shardOutput[ Shard( "shard2", "localhost:30002" ) ] =
+                        fromjson( "{ok:1,result:[{a:2},{a:3},{a:8},{a:9}]}" );
+                shardOutput[ Shard( "shard3", "localhost:30003" ) ] =
+                        fromjson( "{ok:1,result:[{a:5},{a:6}]}" );
+
+                createSort( BSON( "a" << 1 ) );
+                if ( limit() > 0 ) {
+                    ASSERT( sort()->coalesce( mongo::DocumentSourceLimit::create( ctx(),
+                                                                                  limit() ) ) );
+                }
+                intrusive_ptr<DocumentSource> merger = sort()->getRouterSource();
+                merger->setSource( DocumentSourceCommandShards::create( shardOutput,
+                                                                        ctx() ).get() );
+
+                int expected = 1;
+                for ( bool hasNext = !merger->eof(); hasNext; hasNext = merger->advance() ) {
+                    ASSERT_EQUALS( expected, merger->getCurrent()->getField( "a" ).getInt() );
+                    expected++;
+                }
+                ASSERT_EQUALS( ( limit() > 0 ? limit() : 9 ) + 1, expected );
+                assertExhausted();
+            }
+        protected:
+            virtual int limit() const { return 0; }
+        };
+
+        /** A limit stops the merge early. */
+        class MergePresortedWithLimit : public MergePresorted {
+            int limit() const { return 5; }
+        };
+
         /** Dependant field paths. */
         class Dependencies : public Base {
         public:
@@ -1839,6 +1879,8 @@ namespace DocumentSourceTests {
             add<DocumentSourceSort::MissingObjectWithinArray>();
             add<DocumentSourceSort::ExtractArrayValues>();
             add<DocumentSourceSort::Dependencies>();
+            add<DocumentSourceSort::MergePresorted>();
+            add<DocumentSourceSort::MergePresortedWithLimit>();
 
             add<DocumentSourceUnwind::EofInit>();
             add<DocumentSourceUnwind::AdvanceInit>();
@@ -1414,6 +1414,87 @@ namespace mongo_test {
         ASSERT_EQUALS("b", lastHost.host());
     }
 
+    TEST(ReplSetMonitorReadPref, SecondaryOnlyPicksLowerLatency) {
+        vector<ReplicaSetMonitor::Node> nodes =
+                NodeSetFixtures::getThreeMemberWithTags();
+        TagSet tags(TagSetFixtures::getDefaultSet());
+        HostAndPort lastHost = nodes[2].addr;
+
+        nodes[0].latencyMicros = 5000;
+        nodes[2].latencyMicros = 1000;
+
+        bool isPrimarySelected = false;
+        HostAndPort host = ReplicaSetMonitor::selectNode(nodes,
+            mongo::ReadPreference_SecondaryOnly, &tags, 3, &lastHost,
+            &isPrimarySelected);
+
+        ASSERT(!isPrimarySelected);
+        ASSERT_EQUALS("c", host.host());
+        ASSERT_EQUALS("c", lastHost.host());
+    }
+
+    TEST(ReplSetMonitorReadPref, SecondaryOnlyPicksFewerOutstanding) {
+        vector<ReplicaSetMonitor::Node> nodes =
+                NodeSetFixtures::getThreeMemberWithTags();
+        TagSet tags(TagSetFixtures::getDefaultSet());
+        HostAndPort lastHost = nodes[0].addr;
+
+        nodes[0].latencyMicros = 1000;
+        nodes[2].latencyMicros = 1000;
+        nodes[2].outstanding = 3;
+
+        bool isPrimarySelected = false;
+        HostAndPort host = ReplicaSetMonitor::selectNode(nodes,
+            mongo::ReadPreference_SecondaryOnly, &tags, 3, &lastHost,
+            &isPrimarySelected);
+
+        ASSERT(!isPrimarySelected);
+        ASSERT_EQUALS("a", host.host());
+        ASSERT_EQUALS("a", lastHost.host());
+    }
+
+    TEST(ReplSetMonitorReadPref, SecondaryOnlyUnsampledNodeUsesAverageLatency) {
+        vector<ReplicaSetMonitor::Node> nodes =
+                NodeSetFixtures::getThreeMemberWithTags();
+        TagSet tags(TagSetFixtures::getDefaultSet());
+        HostAndPort lastHost = nodes[2].addr;
+
+        // a has no latency yet, so it counts as 2000us with one outstanding request
+        nodes[0].outstanding = 1;
+        nodes[2].latencyMicros = 2000;
+        nodes[2].outstanding = 2;
+
+        bool isPrimarySelected = false;
+        HostAndPort host = ReplicaSetMonitor::selectNode(nodes,
+            mongo::ReadPreference_SecondaryOnly, &tags, 3, &lastHost,
+            &isPrimarySelected);
+
+        ASSERT(!isPrimarySelected);
+        ASSERT_EQUALS("a", host.host());
+        ASSERT_EQUALS("a", lastHost.host());
+    }
+
+    TEST(ReplSetMonitorReadPref, SecondaryPreferredLocalBeforeLeastLoaded) {
+        vector<ReplicaSetMonitor::Node> nodes =
+                NodeSetFixtures::getThreeMemberWithTags();
+        TagSet tags(TagSetFixtures::getDefaultSet());
+        HostAndPort lastHost = nodes[2].addr;
+
+        nodes[0].pingTimeMillis = 1;
+        nodes[0].latencyMicros = 9000;
+        nodes[2].pingTimeMillis = 10;
+        nodes[2].latencyMicros = 1000;
+
+        bool isPrimarySelected = false;
+        HostAndPort host = ReplicaSetMonitor::selectNode(nodes,
+            mongo::ReadPreference_SecondaryPreferred, &tags, 3, &lastHost,
+            &isPrimarySelected);
+
+        ASSERT(!isPrimarySelected);
+        ASSERT_EQUALS("a", host.host());
+        ASSERT_EQUALS("a", lastHost.host());
+    }
+
     TEST(TagSet, CopyConstructor) {
         TagSet* copy;
 
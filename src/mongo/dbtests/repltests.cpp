@@ -182,6 +182,47 @@ namespace ReplTests {
         }
     };
 
+    /** logInsertBatch() writes the same entries as logging each insert with logOp(). */
+    class LogInsertBatch : public Base {
+    public:
+        void run() {
+            ASSERT_EQUALS( 1, opCount() );
+            vector<BSONObj> objs;
+            objs.push_back( BSON( "_id" << 1 ) );
+            objs.push_back( BSON( "_id" << 2 << "a" << "b" ) );
+            objs.push_back( BSON( "_id" << 3 << "c" << BSON( "d" << 4 ) ) );
+            {
+                Lock::GlobalWrite lk;
+                logInsertBatch( ns(), objs, true );
+            }
+            ASSERT_EQUALS( 4, opCount() );
+
+            Lock::GlobalWrite lk;
+            Client::Context ctx( cllNS() );
+            boost::shared_ptr<Cursor> c = theDataFileMgr.findAll( cllNS() );
+            // skip the entry logged when the oplog was created
+            c->advance();
+            OpTime last;
+            for( vector<BSONObj>::const_iterator i = objs.begin(); i != objs.end(); ++i ) {
+                ASSERT( c->ok() );
+                BSONObj op = c->current();
+                OpTime ts = op[ "ts" ]._opTime();
+                ASSERT( last < ts );
+                last = ts;
+
+                BSONObjBuilder expected;
+                expected.appendTimestamp( "ts", ts.asDate() );
+                expected.append( "op", "i" );
+                expected.append( "ns", ns() );
+                expected.appendBool( "fromMigrate", true );
+                expected.append( "o", *i );
+                ASSERT( expected.obj().binaryEqual( op ) );
+                c->advance();
+            }
+            ASSERT( !c->ok() );
+        }
+    };
+
     namespace Idempotence {
 
         class Base : public ReplTests::Base {
@@ -1329,6 +1370,31 @@ namespace ReplTests {
         }
     };
 
+    /** FindingStartCursor starts its search from an OplogStartIndex entry. */
+    class FindingStartCursorStartIndex : public Base {
+    public:
+        void run() {
+            for( int i = 0; i < 10; ++i ) {
+                client()->insert( ns(), BSON( "_id" << i ) );
+            }
+            Date_t ts = client()->query( "local.oplog.$main", Query().sort( BSON( "$natural" << 1 ) ), 1, 4 )->next()[ "ts" ].date();
+            Client::Context ctx( cllNS() );
+            NamespaceDetails *nsd = nsdetails( cllNS() );
+            BSONObjBuilder b;
+            b.appendDate( "$gte", ts );
+            BSONObj query = BSON( "ts" << b.obj() );
+            FieldRangeSetPair frsp( cllNS(), query );
+            BSONObj order = BSON( "$natural" << 1 );
+            scoped_ptr<QueryPlan> qp( QueryPlan::make( nsd, -1, frsp, &frsp, query, order ) );
+            scoped_ptr<FindingStartCursor> fsc( FindingStartCursor::make( *qp ) );
+            ASSERT( fsc->usedStartIndex() );
+            while( !fsc->done() ) {
+                fsc->next();
+            }
+            ASSERT_EQUALS( 4, fsc->cursor()->current()[ "o" ].Obj()[ "_id" ].Int() );
+        }
+    };
+
     class FindingStartExtentTraversalBase : public Base {
     public:
         FindingStartExtentTraversalBase() {
@@ -1590,6 +1656,7 @@ namespace ReplTests {
 
         void setupTests() {
             add< LogBasic >();
+            add< LogInsertBatch >();
             add< Idempotence::InsertTimestamp >();
             add< Idempotence::InsertAutoId >();
             add< Idempotence::InsertWithId >();
@@ -1651,6 +1718,7 @@ namespace ReplTests {
             add< DatabaseIgnorerUpdate >();
             add< FindingStartCursorStale >();
             add< FindingStartCursorYield >();
+            add< FindingStartCursorStartIndex >();
             add< FindingStartEmptyExtentNonLooped >();
             add< FindingStartTwoEmptyExtentsNonLooped >();
             add< FindingStartTwoEmptyEarlyExtentsNonLooped >();
@@ -0,0 +1,175 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mongo/pch.h"
+
+#include "mongo/s/auto_splitter.h"
+
+#include "mongo/base/counter.h"
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/stats/timer_stats.h"
+#include "mongo/s/chunk.h"
+#include "mongo/s/config.h"
+#include "mongo/s/grid.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    AutoSplitter autoSplitter;
+
+    // Off by default: writes then no longer wait for the splits they trigger, so chunks
+    // are split a little after they grow past the split threshold rather than right away.
+    bool AutoSplitter::enabled = false;
+    int AutoSplitter::maxQueueSize = 100;
+
+    ExportedServerParameter<bool> AutoSplitInBackgroundParameter(
+        ServerParameterSet::getGlobal(),
+        "autoSplitInBackground",
+        &AutoSplitter::enabled,
+        true,
+        true
+    );
+
+    ExportedServerParameter<int> AutoSplitMaxQueueSizeParameter(
+        ServerParameterSet::getGlobal(),
+        "autoSplitMaxQueueSize",
+        &AutoSplitter::maxQueueSize,
+        true,
+        true
+    );
+
+    static Counter64 splitChecksQueued;
+    static ServerStatusMetricField<Counter64> displaySplitChecksQueued(
+            "autoSplit.queued", &splitChecksQueued );
+
+    static Counter64 splitChecksCoalesced;
+    static ServerStatusMetricField<Counter64> displaySplitChecksCoalesced(
+            "autoSplit.coalesced", &splitChecksCoalesced );
+
+    static Counter64 splitChecksDropped;
+    static ServerStatusMetricField<Counter64> displaySplitChecksDropped(
+            "autoSplit.dropped", &splitChecksDropped );
+
+    static Counter64 splitChecksStale;
+    static ServerStatusMetricField<Counter64> displaySplitChecksStale(
+            "autoSplit.stale", &splitChecksStale );
+
+    static Counter64 splitsDone;
+    static ServerStatusMetricField<Counter64> displaySplitsDone(
+            "autoSplit.splits", &splitsDone );
+
+    // time checks waited in the queue, and the time spent checking and splitting, all of
+    // which used to be spent on the write path
+    static TimerStats splitQueueWaitStats;
+    static ServerStatusMetricField<TimerStats> displaySplitQueueWait(
+            "autoSplit.queueWait", &splitQueueWaitStats );
+
+    static TimerStats splitCheckStats;
+    static ServerStatusMetricField<TimerStats> displaySplitCheck(
+            "autoSplit.check", &splitCheckStats );
+
+    AutoSplitter::AutoSplitter() : _mutex( "AutoSplitter" ) {
+    }
+
+    bool AutoSplitter::queueSplitCheck( const string& ns, const BSONObj& min ) {
+        scoped_lock lk( _mutex );
+
+        if ( ! _queued.insert( make_pair( ns, min ) ).second ) {
+            splitChecksCoalesced.increment();
+            return true;
+        }
+
+        if ( _queue.size() >= static_cast<size_t>( maxQueueSize ) ) {
+            _queued.erase( make_pair( ns, min ) );
+            splitChecksDropped.increment();
+            LOG(1) << "auto-split queue full, not checking " << ns << " chunk " << min << endl;
+            return false;
+        }
+
+        SplitCheck check;
+        check.ns = ns;
+        check.min = min.getOwned();
+        check.queuedMillis = curTimeMillis64();
+        _queue.push_back( check );
+        splitChecksQueued.increment();
+
+        _queueNotEmpty.notify_one();
+        return true;
+    }
+
+    size_t AutoSplitter::queueSize() const {
+        scoped_lock lk( _mutex );
+        return _queue.size();
+    }
+
+    void AutoSplitter::run() {
+        while ( ! inShutdown() ) {
+            SplitCheck check;
+            {
+                scoped_lock lk( _mutex );
+                if ( _queue.empty() ) {
+                    _queueNotEmpty.timed_wait( lk.boost(), boost::posix_time::seconds( 1 ) );
+                    continue;
+                }
+
+                check = _queue.front();
+                _queue.pop_front();
+                // writes from now on may queue this chunk again
+                _queued.erase( make_pair( check.ns, check.min ) );
+            }
+
+            splitQueueWaitStats.recordMillis( curTimeMillis64() - check.queuedMillis );
+
+            try {
+                _doCheck( check );
+            }
+            catch ( std::exception& e ) {
+                warning() << "auto-split check of " << check.ns << " chunk " << check.min
+                          << " failed" << causedBy( e ) << endl;
+            }
+        }
+    }
+
+    void AutoSplitter::_doCheck( const SplitCheck& check ) {
+        DBConfigPtr config = grid.getDBConfig( check.ns, false );
+        if ( ! config || ! config->isSharded( check.ns ) ) {
+            splitChecksStale.increment();
+            return;
+        }
+
+        ChunkManagerPtr manager = config->getChunkManagerIfExists( check.ns );
+        if ( ! manager ) {
+            splitChecksStale.increment();
+            return;
+        }
+
+        // The chunk may have been split by another write or mongos since it was queued
+        ChunkPtr chunk = manager->findIntersectingChunk( check.min );
+        if ( chunk->getMin().woCompare( check.min ) != 0 ) {
+            LOG(1) << "not auto-splitting " << check.ns << " chunk " << check.min
+                   << ", it now starts at " << chunk->getMin() << endl;
+            splitChecksStale.increment();
+            return;
+        }
+
+        Timer timer;
+        if ( chunk->autoSplit() )
+            splitsDone.increment();
+        splitCheckStats.record( timer );
+    }
+
+} // namespace mongo
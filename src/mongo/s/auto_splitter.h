@@ -0,0 +1,87 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <boost/thread/condition.hpp>
+#include <deque>
+#include <set>
+#include <string>
+#include <utility>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/util/background.h"
+#include "mongo/util/concurrency/mutex.h"
+
+namespace mongo {
+
+    /**
+     * Runs the auto-split checks that Chunk::splitIfShould() finds due on a background thread
+     * of this mongos, so the splitVector, split and possible migration they involve are off
+     * the write path of the client whose write crossed the threshold.
+     *
+     * A chunk is identified by its namespace and min key. A check requested for a chunk that
+     * is already waiting is coalesced with it. At most 'maxQueueSize' chunks wait at a time;
+     * a check that does not fit is dropped, and the chunk asks again with its next writes.
+     */
+    class AutoSplitter : public BackgroundJob {
+    public:
+        AutoSplitter();
+
+        /**
+         * Queues an auto-split check for the chunk of 'ns' starting at 'min'.
+         * @return false if the check could not be queued because the queue is full
+         */
+        bool queueSplitCheck( const string& ns, const BSONObj& min );
+
+        /** @return the number of chunks waiting to be checked */
+        size_t queueSize() const;
+
+        // BackgroundJob methods
+
+        virtual void run();
+
+        virtual string name() const { return "AutoSplitter"; }
+
+        // Set to check splits here rather than on the writing client's thread
+        static bool enabled;
+
+        // Bound on the number of chunks waiting to be checked
+        static int maxQueueSize;
+
+    private:
+        struct SplitCheck {
+            string ns;
+            BSONObj min;
+            long long queuedMillis;
+        };
+
+        /** Finds the chunk of 'check' in the current metadata and asks it to split. */
+        void _doCheck( const SplitCheck& check );
+
+        // protects the queue
+        mutable mongo::mutex _mutex;
+        boost::condition _queueNotEmpty;
+
+        std::deque<SplitCheck> _queue;
+
+        // ns and min key of each chunk in _queue
+        std::set< std::pair<string, BSONObj> > _queued;
+    };
+
+    extern AutoSplitter autoSplitter;
+
+} // namespace mongo
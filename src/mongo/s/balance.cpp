@@ -18,10 +18,15 @@
 
 #include "mongo/s/balance.h"
 
+#include <boost/thread/thread.hpp>
+
+#include "mongo/base/counter.h"
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/client/distlock.h"
 #include "mongo/db/cmdline.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/namespacestring.h"
 #include "mongo/s/chunk.h"
 #include "mongo/s/config.h"
 #include "mongo/s/grid.h"
@@ -38,20 +43,148 @@ namespace mongo {
 
     Balancer balancer;
 
+    // Outcome of the migrations the balancer started, and how many candidates were put off
+    // to a later wave of the round because their shards or collection were already migrating
+    static Counter64 migrationsSucceeded;
+    static ServerStatusMetricField<Counter64> displayMigrationsSucceeded(
+                                                    "balancer.migrations.succeeded",
+                                                    &migrationsSucceeded );
+    static Counter64 migrationsFailed;
+    static ServerStatusMetricField<Counter64> displayMigrationsFailed(
+                                                    "balancer.migrations.failed",
+                                                    &migrationsFailed );
+    static Counter64 migrationsDeferred;
+    static ServerStatusMetricField<Counter64> displayMigrationsDeferred(
+                                                    "balancer.migrations.deferred",
+                                                    &migrationsDeferred );
+
+    /** Reports a gauge the migration threads update without a lock. */
+    class AtomicGaugeSSM : public ServerStatusMetric {
+    public:
+        AtomicGaugeSSM( const string& name, const AtomicInt32* gauge )
+            : ServerStatusMetric( name ), _gauge( gauge ) {
+        }
+        virtual void appendAtLeaf( BSONObjBuilder& b ) const {
+            b.append( _leafName, _gauge->load() );
+        }
+    private:
+        const AtomicInt32* _gauge;
+    };
+
+    // Most migrations running at once in the last round, and in any round
+    static AtomicInt32 migrationsRunning;
+    static AtomicInt32 lastRoundMigrations;
+    static AtomicGaugeSSM displayLastRoundMigrations( "balancer.migrations.lastRoundConcurrency",
+                                                      &lastRoundMigrations );
+    static AtomicInt32 maxRoundMigrations;
+    static AtomicGaugeSSM displayMaxRoundMigrations( "balancer.migrations.maxConcurrency",
+                                                     &maxRoundMigrations );
+
+    static void raiseGauge( AtomicInt32* gauge, int value ) {
+        int current = gauge->load();
+        while ( value > current ) {
+            int seen = gauge->compareAndSwap( current, value );
+            if ( seen == current )
+                return;
+            current = seen;
+        }
+    }
+
+    /** Counts a migration as running for as long as it is in scope. */
+    class RunningMigration : boost::noncopyable {
+    public:
+        RunningMigration() {
+            int running = migrationsRunning.addAndFetch( 1 );
+            raiseGauge( &lastRoundMigrations, running );
+            raiseGauge( &maxRoundMigrations, running );
+        }
+        ~RunningMigration() {
+            migrationsRunning.subtractAndFetch( 1 );
+        }
+    };
+
+    // Rounds after a migration during which its clone and range deletes may still show in
+    // the operation counts of the shards involved
+    static const int MigrationTrafficRounds = 2;
+
     Balancer::Balancer() : _balancedLastTime(0), _policy( new BalancerPolicy() ) {}
 
     Balancer::~Balancer() {
     }
 
     int Balancer::_moveChunks(const vector<CandidateChunkPtr>* candidateChunks,
+                              int maxMigrations,
                               bool secondaryThrottle,
                               bool waitForDelete)
     {
+        lastRoundMigrations.store( 0 );
+
+        // Candidates sharing a shard or collection with a running migration wait for the next
+        // wave, so every candidate of the round runs and none starves behind the others.
+        vector<CandidateChunkPtr> remaining( *candidateChunks );
+        int movedCount = 0;
+        while ( ! remaining.empty() ) {
+            vector<CandidateChunkPtr> picked;
+            vector<CandidateChunkPtr> deferred;
+            BalancerPolicy::pickConcurrentMigrations( remaining, maxMigrations, &picked, &deferred );
+            migrationsDeferred.increment( deferred.size() );
+
+            LOG(1) << "running " << picked.size() << " of " << remaining.size()
+                   << " remaining candidate migrations" << endl;
+
+            movedCount += _moveChunksAtOnce( picked, secondaryThrottle, waitForDelete );
+            remaining.swap( deferred );
+
+            // a failed migration may have cloned and deleted documents too
+            for ( size_t i = 0; i < picked.size(); i++ ) {
+                const CandidateChunk& chunkInfo = *picked[i];
+                _nsMigrationRounds[ make_pair( chunkInfo.from, chunkInfo.ns ) ] =
+                    MigrationTrafficRounds;
+                _nsMigrationRounds[ make_pair( chunkInfo.to, chunkInfo.ns ) ] =
+                    MigrationTrafficRounds;
+            }
+        }
+        return movedCount;
+    }
+
+    int Balancer::_moveChunksAtOnce(const vector<CandidateChunkPtr>& picked,
+                                    bool secondaryThrottle,
+                                    bool waitForDelete)
+    {
+        vector<int> moved( picked.size(), 0 );
+        if ( picked.size() == 1 ) {
+            _moveChunk( picked[0].get(), secondaryThrottle, waitForDelete, &moved[0] );
+        }
+        else {
+            boost::thread_group threads;
+            for ( size_t i = 0; i < picked.size(); i++ ) {
+                threads.create_thread( boost::bind( &Balancer::_moveChunk,
+                                                    picked[i].get(),
+                                                    secondaryThrottle,
+                                                    waitForDelete,
+                                                    &moved[i] ) );
+            }
+            threads.join_all();
+        }
+
         int movedCount = 0;
+        for ( size_t i = 0; i < moved.size(); i++ ) {
+            movedCount += moved[i];
+        }
+        return movedCount;
+    }
 
-        for ( vector<CandidateChunkPtr>::const_iterator it = candidateChunks->begin(); it != candidateChunks->end(); ++it ) {
-            const CandidateChunk& chunkInfo = *it->get();
+    void Balancer::_moveChunk(const CandidateChunk* chunkInfoPtr,
+                              bool secondaryThrottle,
+                              bool waitForDelete,
+                              int* moved)
+    {
+        const CandidateChunk& chunkInfo = *chunkInfoPtr;
+        *moved = 0;
+
+        RunningMigration running;
 
+        try {
             DBConfigPtr cfg = grid.getDBConfig( chunkInfo.ns );
             verify( cfg );
 
@@ -67,7 +200,7 @@ namespace mongo {
                 c = cm->findIntersectingChunk( chunkInfo.chunk.min );
                 if ( c->getMin().woCompare( chunkInfo.chunk.min ) || c->getMax().woCompare( chunkInfo.chunk.max ) ) {
                     log() << "chunk mismatch after reload, ignoring will retry issue " << chunkInfo.chunk.toString() << endl;
-                    continue;
+                    return;
                 }
             }
 
@@ -77,10 +210,13 @@ namespace mongo {
                                  secondaryThrottle,
                                  waitForDelete,
                                  res)) {
-                movedCount++;
-                continue;
+                migrationsSucceeded.increment();
+                *moved = 1;
+                return;
             }
 
+            migrationsFailed.increment();
+
             // the move requires acquiring the collection metadata's lock, which can fail
             log() << "balancer move failed: " << res << " from: " << chunkInfo.from << " to: " << chunkInfo.to
                   << " chunk: " << chunkInfo.chunk << endl;
@@ -101,13 +237,18 @@ namespace mongo {
                     log() << "marking chunk as jumbo: " << c->toString() << endl;
                     c->markAsJumbo();
                     // we increment moveCount so we do another round right away
-                    movedCount++;
+                    *moved = 1;
                 }
 
             }
         }
-
-        return movedCount;
+        catch ( std::exception& e ) {
+            // runs on its own thread, so nothing above us would catch this
+            migrationsFailed.increment();
+            warning() << "balancer move of " << chunkInfo.ns << chunkInfo.chunk << " from: "
+                      << chunkInfo.from << " to: " << chunkInfo.to << " failed: " << e.what()
+                      << endl;
+        }
     }
 
     void Balancer::_ping( DBClientBase& conn, bool waiting ) {
@@ -176,7 +317,95 @@ namespace mongo {
         }        
     }
 
-    void Balancer::_doBalanceRound( DBClientBase& conn, vector<CandidateChunkPtr>* candidateChunks ) {
+    /**
+     * Estimates the data size of every chunk of 'ns' as the collection's data size on the chunk's
+     * shard, from collStats, spread evenly over the shard's chunks.
+     *
+     * @return false, leaving 'status' untouched, if a shard could not be asked
+     */
+    bool estimateChunkDataSizes( const string& ns,
+                                 const ShardToChunksMap& shardToChunksMap,
+                                 DistributionStatus* status ) {
+
+        NamespaceString nss( ns );
+        map<BSONObj,long long> sizes;
+
+        for ( ShardToChunksMap::const_iterator i = shardToChunksMap.begin();
+              i != shardToChunksMap.end();
+              ++i ) {
+            const vector<BSONObj>& chunks = i->second;
+            if ( chunks.empty() )
+                continue;
+
+            long long size;
+            try {
+                BSONObj res = Shard::make( i->first ).runCommand( nss.db,
+                                                                  BSON( "collStats" << nss.coll ) );
+                size = res["size"].numberLong();
+            }
+            catch ( DBException& e ) {
+                warning() << "could not get the data size of " << ns << " on " << i->first
+                          << ", balancing it by number of chunks" << causedBy( e ) << endl;
+                return false;
+            }
+
+            for ( unsigned j = 0; j < chunks.size(); j++ )
+                sizes[chunks[j][ChunkType::min()].Obj()] = size / chunks.size();
+        }
+
+        for ( map<BSONObj,long long>::const_iterator i = sizes.begin(); i != sizes.end(); ++i )
+            status->setChunkDataSize( i->first, i->second );
+
+        return true;
+    }
+
+    void Balancer::_estimateOpsPerSec( const string& ns,
+                                       const map<string,BSONObj>& shardTops,
+                                       unsigned long long now,
+                                       DistributionStatus* status ) {
+
+        for ( map<string,BSONObj>::const_iterator i = shardTops.begin();
+              i != shardTops.end();
+              ++i ) {
+            // namespaces contain dots, so the entry can't be looked up with a dotted path
+            BSONElement entry = i->second[ns];
+            if ( entry.type() != Object )
+                continue;
+
+            BSONElement total = entry.Obj().getFieldDotted( "total.count" );
+            if ( ! total.isNumber() )
+                continue;
+
+            const pair<string,string> key( i->first, ns );
+            map< pair<string,string>,pair<long long,unsigned long long> >::const_iterator last =
+                _nsOpCounts.find( key );
+            map< pair<string,string>,int >::iterator migrated = _nsMigrationRounds.find( key );
+
+            if ( migrated != _nsMigrationRounds.end() ) {
+                // the count since the last round includes the balancer's own clone and range
+                // delete operations, which would make the shard look busier than its clients
+                // keep it and feed back into the next migration
+                if ( --migrated->second <= 0 )
+                    _nsMigrationRounds.erase( migrated );
+
+                map< pair<string,string>,double >::const_iterator rate = _nsOpsPerSec.find( key );
+                if ( rate != _nsOpsPerSec.end() )
+                    status->setOpsPerSec( i->first, rate->second );
+            }
+            else if ( last != _nsOpCounts.end() && now > last->second.second &&
+                      total.numberLong() >= last->second.first ) {
+                const double rate = ( total.numberLong() - last->second.first ) * 1000.0 /
+                                    ( now - last->second.second );
+                status->setOpsPerSec( i->first, rate );
+                _nsOpsPerSec[ key ] = rate;
+            }
+            _nsOpCounts[ key ] = make_pair( total.numberLong(), now );
+        }
+    }
+
+    void Balancer::_doBalanceRound( DBClientBase& conn,
+                                    vector<CandidateChunkPtr>* candidateChunks,
+                                    bool byLoad ) {
         verify( candidateChunks );
 
         //
@@ -237,6 +466,24 @@ namespace mongo {
 
         OCCASIONALLY warnOnMultiVersion( shardInfo );
 
+        // every shard's operation counts per collection, for balancing by load
+        map<string,BSONObj> shardTops;
+        unsigned long long topTime = 0;
+        if ( byLoad ) {
+            topTime = curTimeMillis64();
+            for ( vector<Shard>::const_iterator it = allShards.begin(); it != allShards.end(); ++it ) {
+                try {
+                    BSONObj res = it->runCommand( "admin", "top" );
+                    if ( res["totals"].type() == Object )
+                        shardTops[ it->getName() ] = res["totals"].Obj().getOwned();
+                }
+                catch ( DBException& e ) {
+                    warning() << "could not get the operation counts of " << it->getName()
+                              << ", balancing by data size only" << causedBy( e ) << endl;
+                }
+            }
+        }
+
         //
         // 3. For each collection, check if the balancing policy recommends moving anything around.
         //
@@ -271,6 +518,11 @@ namespace mongo {
 
             DistributionStatus status( shardInfo, shardToChunksMap );
 
+            if ( byLoad ) {
+                estimateChunkDataSizes( ns, shardToChunksMap, &status );
+                _estimateOpsPerSec( ns, shardTops, topTime, &status );
+            }
+
             // load tags
             conn.ensureIndex(TagsType::ConfigNS,
                              BSON(TagsType::ns() << 1 << TagsType::min() << 1),
@@ -334,7 +586,7 @@ namespace mongo {
                 continue;
             }
 
-            CandidateChunk* p = _policy->balance( ns, status, _balancedLastTime );
+            CandidateChunk* p = _policy->balance( ns, status, _balancedLastTime, byLoad );
             if ( p ) candidateChunks->push_back( CandidateChunkPtr( p ) );
         }
     }
@@ -451,17 +703,27 @@ namespace mongo {
                         secondaryThrottle = balancerConfig[SettingsType::secondaryThrottle()].trueValue();
                     }
 
+                    // no limit by default beyond one migration per shard
+                    int maxMigrations =
+                        balancerConfig[SettingsType::maxConcurrentMigrations()].numberInt();
+
+                    // balance by number of chunks by default
+                    bool byLoad = balancerConfig[SettingsType::balanceByLoad()].trueValue();
+
                     LOG(1) << "waitForDelete: " << waitForDelete << endl;
                     LOG(1) << "secondaryThrottle: " << secondaryThrottle << endl;
+                    LOG(1) << "maxConcurrentMigrations: " << maxMigrations << endl;
+                    LOG(1) << "balanceByLoad: " << byLoad << endl;
 
                     vector<CandidateChunkPtr> candidateChunks;
-                    _doBalanceRound( conn.conn() , &candidateChunks );
+                    _doBalanceRound( conn.conn() , &candidateChunks, byLoad );
                     if ( candidateChunks.size() == 0 ) {
                         LOG(1) << "no need to move any chunk" << endl;
                         _balancedLastTime = 0;
                     }
                     else {
                         _balancedLastTime = _moveChunks(&candidateChunks,
+                                                        maxMigrations,
                                                         secondaryThrottle,
                                                         waitForDelete );
                     }
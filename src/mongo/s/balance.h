@@ -33,7 +33,9 @@ namespace mongo {
      *
      * The balancer does act continuously but in "rounds". At a given round, it would decide if there is an imbalance by
      * checking the difference in chunks between the most and least loaded shards. It would issue a request for a chunk
-     * migration per round, if it found so.
+     * migration per collection per round, if it found so, running at once those migrations that involve distinct shards
+     * and collections.  With the "_balanceByLoad" balancer setting, it compares the shards' data sizes and operation
+     * rates on each collection instead of their numbers of chunks.
      */
     class Balancer : public BackgroundJob {
     public:
@@ -59,6 +61,17 @@ namespace mongo {
         // number of moved chunks in last round
         int _balancedLastTime;
 
+        // operation count and time in millis of every (shard, collection) at the last round, to
+        // tell the policy the rate at which each shard serves operations on each collection
+        map< pair<string,string>,pair<long long,unsigned long long> > _nsOpCounts;
+
+        // the last rate computed from counts free of migration traffic, by (shard, collection)
+        map< pair<string,string>,double > _nsOpsPerSec;
+
+        // how many more rounds the counts of a (shard, collection) that took part in a
+        // migration include the migration's clone and range deletes, see _estimateOpsPerSec()
+        map< pair<string,string>,int > _nsMigrationRounds;
+
         // decide which chunks to move; owned here.
         scoped_ptr<BalancerPolicy> _policy;
         
@@ -71,27 +84,66 @@ namespace mongo {
          */
         bool _init();
 
+        /**
+         * Tells 'status' the rate at which every shard served operations on 'ns' since the last
+         * round, from the "totals" of the shards' top commands in 'shardTops', taken at 'now'
+         * millis.  Shards without a count for 'ns' at both rounds get no rate.  The counts of a
+         * shard that donated or received a chunk of 'ns' include the migration's own operations
+         * for up to two rounds, while its range deletes run, so the shard keeps the rate from
+         * before the migration meanwhile.
+         */
+        void _estimateOpsPerSec( const string& ns,
+                                 const map<string,BSONObj>& shardTops,
+                                 unsigned long long now,
+                                 DistributionStatus* status );
+
         /**
          * Gathers all the necessary information about shards and chunks, and decides whether there are candidate chunks to
          * be moved.
          *
          * @param conn is the connection with the config server(s)
          * @param candidateChunks (IN/OUT) filled with candidate chunks, one per collection, that could possibly be moved
+         * @param byLoad balance by chunk data size and per-collection operation rates, see BalancerPolicy
          */
-        void _doBalanceRound( DBClientBase& conn, vector<CandidateChunkPtr>* candidateChunks );
+        void _doBalanceRound( DBClientBase& conn,
+                              vector<CandidateChunkPtr>* candidateChunks,
+                              bool byLoad );
 
         /**
-         * Issues chunk migration request, one at a time.
+         * Issues chunk migration requests for all the candidates, in waves.  Each wave runs at
+         * once the candidates that don't share a shard or a collection, and the others wait
+         * for a later wave of the same round.
          *
          * @param candidateChunks possible chunks to move
+         * @param maxMigrations caps the number of concurrent migrations if positive
          * @param secondaryThrottle wait for secondaries to catch up before pushing more deletes
          * @param waitForDelete wait for deletes to complete after each chunk move
          * @return number of chunks effectively moved
          */
         int _moveChunks(const vector<CandidateChunkPtr>* candidateChunks,
+                        int maxMigrations,
                         bool secondaryThrottle,
                         bool waitForDelete);
 
+        /**
+         * Issues the chunk migration requests of one wave, each on its own thread.
+         *
+         * @return number of chunks effectively moved
+         */
+        int _moveChunksAtOnce(const vector<CandidateChunkPtr>& picked,
+                              bool secondaryThrottle,
+                              bool waitForDelete);
+
+        /**
+         * Issues one chunk migration request, run on its own thread by _moveChunksAtOnce().
+         *
+         * @param moved (OUT) 1 if the chunk was moved or marked jumbo, 0 otherwise
+         */
+        static void _moveChunk(const CandidateChunk* chunkInfo,
+                               bool secondaryThrottle,
+                               bool waitForDelete,
+                               int* moved);
+
         /**
          * Marks this balancer as being live on the config server(s).
          *
@@ -23,9 +23,14 @@
 #include "mongo/util/text.h"
 
 #include <algorithm>
+#include <cmath>
 
 namespace mongo {
 
+    // Balancing by load moves chunks only while the most and least loaded shards differ by more
+    // than this fraction of the average load
+    static const double loadImbalanceThreshold = 0.2;
+
     string TagRange::toString() const {
         return str::stream() << min << " -->> " << max << "  on  " << tag;
     }
@@ -72,6 +77,28 @@ namespace mongo {
         return total;
     }
 
+    long long DistributionStatus::chunkDataSize( const BSONObj& chunk ) const {
+        map<BSONObj,long long>::const_iterator i =
+            _chunkDataSizes.find( chunk[ChunkType::min()].Obj() );
+        if ( i == _chunkDataSizes.end() )
+            return 0;
+        return i->second;
+    }
+
+    long long DistributionStatus::dataSizeInShardWithTag( const string& shard,
+                                                          const string& tag ) const {
+        ShardToChunksMap::const_iterator i = _shardChunks.find( shard );
+        if ( i == _shardChunks.end() )
+            return 0;
+
+        long long total = 0;
+        for ( unsigned j=0; j<i->second.size(); j++ )
+            if ( tag == getTagForChunk( i->second[j] ) )
+                total += chunkDataSize( i->second[j] );
+
+        return total;
+    }
+
     string DistributionStatus::getBestReceieverShard( const string& tag ) const {
         string best;
         unsigned minChunks = numeric_limits<unsigned>::max();
@@ -172,6 +199,21 @@ namespace mongo {
         return true;
     }
 
+    void DistributionStatus::setChunkDataSize( const BSONObj& chunkMin, long long bytes ) {
+        _chunkDataSizes[chunkMin.getOwned()] = bytes;
+    }
+
+    void DistributionStatus::setOpsPerSec( const string& shard, double opsPerSec ) {
+        _opsPerSec[shard] = opsPerSec;
+    }
+
+    double DistributionStatus::opsPerSec( const string& shard ) const {
+        map<string,double>::const_iterator i = _opsPerSec.find( shard );
+        if ( i == _opsPerSec.end() )
+            return 0;
+        return i->second;
+    }
+
     string DistributionStatus::getTagForChunk( const BSONObj& chunk ) const {
         if ( _tagRanges.size() == 0 )
             return "";
@@ -220,7 +262,8 @@ namespace mongo {
     }
     MigrateInfo* BalancerPolicy::balance( const string& ns,
                                           const DistributionStatus& distribution,
-                                          int balancedLastTime ) {
+                                          int balancedLastTime,
+                                          bool byLoad ) {
 
 
         // 1) check for shards that policy require to us to move off of:
@@ -340,9 +383,21 @@ namespace mongo {
             std::random_shuffle( tags.begin(), tags.end() );
         }
 
+        if ( byLoad && ! distribution.hasChunkDataSizes() ) {
+            LOG(1) << "no chunk data sizes for " << ns << ", balancing by number of chunks" << endl;
+            byLoad = false;
+        }
+
         for ( unsigned i=0; i<tags.size(); i++ ) {
             string tag = tags[i];
 
+            if ( byLoad ) {
+                MigrateInfo* m = _balanceTagByLoad( ns, distribution, tag );
+                if ( m )
+                    return m;
+                continue;
+            }
+
             string from = distribution.getMostOverloadedShard( tag );
             if ( from.size() == 0 )
                 continue;
@@ -401,6 +456,129 @@ namespace mongo {
         return NULL;
     }
 
+    MigrateInfo* BalancerPolicy::_balanceTagByLoad( const string& ns,
+                                                    const DistributionStatus& distribution,
+                                                    const string& tag ) {
+
+        // shards with writebacks queued can neither give nor take chunks, like above
+        vector<string> shards;
+        map<string,long long> data;
+        long long totalData = 0;
+        double totalOps = 0;
+
+        const set<string>& allShards = distribution.shards();
+        for ( set<string>::const_iterator i = allShards.begin(); i != allShards.end(); ++i ) {
+            const ShardInfo& info = distribution.shardInfo( *i );
+            if ( info.hasOpsQueued() || ! info.hasTag( tag ) )
+                continue;
+
+            shards.push_back( *i );
+            data[*i] = distribution.dataSizeInShardWithTag( *i, tag );
+            totalData += data[*i];
+            totalOps += distribution.opsPerSec( *i );
+        }
+
+        if ( shards.size() < 2 || totalData == 0 )
+            return NULL;
+
+        map<string,double> load;
+        for ( unsigned i = 0; i < shards.size(); i++ ) {
+            const string& shard = shards[i];
+            double dataShare = static_cast<double>( data[shard] ) / totalData;
+            if ( totalOps > 0 )
+                load[shard] = ( dataShare +
+                                distribution.opsPerSec( shard ) / totalOps ) / 2;
+            else
+                load[shard] = dataShare;
+        }
+
+        string from;
+        string to;
+        for ( unsigned i = 0; i < shards.size(); i++ ) {
+            const string& shard = shards[i];
+            const ShardInfo& info = distribution.shardInfo( shard );
+
+            if ( data[shard] > 0 && ( from.empty() || load[shard] > load[from] ) )
+                from = shard;
+
+            if ( info.isDraining() || info.isSizeMaxed() )
+                continue;
+
+            if ( to.empty() || load[shard] < load[to] )
+                to = shard;
+        }
+
+        if ( from.empty() || to.empty() || from == to )
+            return NULL;
+
+        const double gap = load[from] - load[to];
+
+        LOG(1) << "collection : " << ns << " tag [" << tag << "]" << endl;
+        LOG(1) << "donor      : " << from << " load " << load[from] << endl;
+        LOG(1) << "receiver   : " << to << " load " << load[to] << endl;
+
+        if ( gap <= loadImbalanceThreshold / shards.size() )
+            return NULL;
+
+        // chunks next to one already on the receiver keep ranges together on fewer shards
+        set<BSONObj> receiverBounds;
+        const vector<BSONObj>& receiverChunks = distribution.getChunks( to );
+        for ( unsigned j = 0; j < receiverChunks.size(); j++ ) {
+            receiverBounds.insert( receiverChunks[j][ChunkType::min()].Obj() );
+            receiverBounds.insert( receiverChunks[j][ChunkType::max()].Obj() );
+        }
+
+        const double donorOpsShare = totalOps > 0 ?
+            distribution.opsPerSec( from ) / totalOps : 0;
+
+        const vector<BSONObj>& chunks = distribution.getChunks( from );
+        int best = -1;
+        double bestGap = gap;
+        bool bestAdjacent = false;
+        for ( unsigned j = 0; j < chunks.size(); j++ ) {
+            if ( distribution.getTagForChunk( chunks[j] ) != tag )
+                continue;
+
+            if ( _isJumbo( chunks[j] ) )
+                continue;
+
+            long long size = distribution.chunkDataSize( chunks[j] );
+            if ( size == 0 )
+                continue;
+
+            double moved = static_cast<double>( size ) / totalData;
+            if ( totalOps > 0 )
+                moved = ( moved + donorOpsShare * size / data[from] ) / 2;
+
+            // the difference between the two shards once the chunk moved
+            double newGap = fabs( gap - 2 * moved );
+            bool adjacent = receiverBounds.count( chunks[j][ChunkType::min()].Obj() ) ||
+                            receiverBounds.count( chunks[j][ChunkType::max()].Obj() );
+
+            if ( newGap > bestGap )
+                continue;
+
+            // of equally good chunks, one next to the receiver's replaces one that is not
+            if ( newGap == bestGap && ( best < 0 || bestAdjacent || ! adjacent ) )
+                continue;
+
+            best = j;
+            bestGap = newGap;
+            bestAdjacent = adjacent;
+        }
+
+        if ( best < 0 ) {
+            LOG(1) << "no chunk on " << from << " narrows the load difference with " << to
+                   << " for tag [" << tag << "]" << endl;
+            return NULL;
+        }
+
+        log() << " ns: " << ns << " going to move " << chunks[best]
+              << " from: " << from << " to: " << to << " tag [" << tag << "]"
+              << " to balance load" << endl;
+        return new MigrateInfo( ns, to, from, chunks[best] );
+    }
+
 
     ShardInfo::ShardInfo( long long maxSize, long long currSize,
                           bool draining, bool opsQueued,
@@ -454,6 +632,37 @@ namespace mongo {
         return ss.str();
     }
 
+    void BalancerPolicy::pickConcurrentMigrations(
+            const vector<shared_ptr<MigrateInfo> >& candidates,
+            int maxMigrations,
+            vector<shared_ptr<MigrateInfo> >* picked,
+            vector<shared_ptr<MigrateInfo> >* deferred ) {
+
+        set<string> busyShards;
+        set<string> busyCollections;
+
+        for ( vector<shared_ptr<MigrateInfo> >::const_iterator it = candidates.begin();
+              it != candidates.end();
+              ++it ) {
+
+            const MigrateInfo& migrate = **it;
+            if ( ( maxMigrations > 0 && picked->size() >= static_cast<size_t>( maxMigrations ) ) ||
+                 busyShards.count( migrate.from ) || busyShards.count( migrate.to ) ||
+                 busyCollections.count( migrate.ns ) ) {
+                LOG(1) << "deferring migration of " << migrate.ns << migrate.chunk.toString()
+                       << " from " << migrate.from << " to " << migrate.to
+                       << " until the migrations running with it finished" << endl;
+                deferred->push_back( *it );
+                continue;
+            }
+
+            busyShards.insert( migrate.from );
+            busyShards.insert( migrate.to );
+            busyCollections.insert( migrate.ns );
+            picked->push_back( *it );
+        }
+    }
+
     string ChunkInfo::toString() const {
         StringBuilder buf;
         buf << " min: " << min;
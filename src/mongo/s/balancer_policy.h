@@ -127,6 +127,18 @@ namespace mongo {
          */
         bool addTagRange( const TagRange& range );
 
+        /**
+         * Records the estimated data size of the chunk starting at 'chunkMin', for balancing by
+         * load.  Chunks without an estimate count as empty.
+         */
+        void setChunkDataSize( const BSONObj& chunkMin, long long bytes );
+
+        /**
+         * Records the operations per second 'shard' served on this collection since the
+         * previous balancing round, for balancing by load.  Shards without a rate count as idle.
+         */
+        void setOpsPerSec( const string& shard, double opsPerSec );
+
         // ---- these methods might be better suiting in BalancerPolicy
         
         /**
@@ -153,6 +165,18 @@ namespace mongo {
         /** @return number of chunks in this shard with the given tag */
         unsigned numberOfChunksInShardWithTag( const string& shard, const string& tag ) const;
 
+        /** @return true if any chunk has a data size estimate */
+        bool hasChunkDataSizes() const { return ! _chunkDataSizes.empty(); }
+
+        /** @return estimated data size of the chunk, 0 if unknown */
+        long long chunkDataSize( const BSONObj& chunk ) const;
+
+        /** @return estimated data size of the chunks in this shard with the given tag */
+        long long dataSizeInShardWithTag( const string& shard, const string& tag ) const;
+
+        /** @return operations per second the shard served on this collection, 0 if unknown */
+        double opsPerSec( const string& shard ) const;
+
         /** @return chunks for the shard */
         const vector<BSONObj>& getChunks( const string& shard ) const;
 
@@ -177,6 +201,8 @@ namespace mongo {
         map<BSONObj,TagRange> _tagRanges;
         set<string> _allTags;
         set<string> _shards;
+        map<BSONObj,long long> _chunkDataSizes; // chunk min -> bytes
+        map<string,double> _opsPerSec; // shard -> operations per second on the collection
     };
 
     class BalancerPolicy {
@@ -190,15 +216,45 @@ namespace mongo {
          * @param ns is the collections namepace.
          * @param DistributionStatus holds all the info about the current state of the cluster/namespace
          * @param balancedLastTime is the number of chunks effectively moved in the last round.
+         * @param byLoad balances each tag's chunks by data size and per-shard operation rates
+         *        rather than by number of chunks, when the distribution has chunk data sizes.
          * @returns NULL or MigrateInfo of the best move to make towards balacing the collection.
          *          caller owns the MigrateInfo instance
          */
         static MigrateInfo* balance( const string& ns,
                                      const DistributionStatus& distribution,
-                                     int balancedLastTime );
+                                     int balancedLastTime,
+                                     bool byLoad = false );
+
+        /**
+         * Picks, in order, the migrations among 'candidates' that can run at the same time.  Every
+         * shard takes part in at most one of them, as donor or recipient, and every collection
+         * in at most one, since the donor holds the collection's distributed lock for the whole
+         * migration.
+         *
+         * @param maxMigrations caps the number of picked migrations if positive
+         * @param picked (OUT) the migrations to run now
+         * @param deferred (OUT) the other candidates, in order, to run once those finished
+         */
+        static void pickConcurrentMigrations( const vector<shared_ptr<MigrateInfo> >& candidates,
+                                              int maxMigrations,
+                                              vector<shared_ptr<MigrateInfo> >* picked,
+                                              vector<shared_ptr<MigrateInfo> >* deferred );
 
     private:
         static bool _isJumbo( const BSONObj& chunk );
+
+        /**
+         * Balancing by load.  A shard's load is its share of the data in chunks with 'tag',
+         * averaged with its share of the operations on the collection when those are known.  Suggests
+         * moving a chunk from the most to the least loaded shard if their loads differ by more
+         * than a fifth of the average load, picking the chunk whose move narrows the difference
+         * the most, and among equally good chunks one next to a chunk already on the receiver.
+         * A moved chunk is assumed to take operations with it in proportion to its data.
+         */
+        static MigrateInfo* _balanceTagByLoad( const string& ns,
+                                               const DistributionStatus& distribution,
+                                               const string& tag );
     };
 
 
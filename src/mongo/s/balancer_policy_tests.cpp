@@ -519,5 +519,246 @@ namespace mongo {
                 }
             }
         }
+
+        shared_ptr<MigrateInfo> migrateInfo( const string& ns,
+                                             const string& from,
+                                             const string& to ) {
+            return shared_ptr<MigrateInfo>( new MigrateInfo( ns, to, from,
+                    BSON( ChunkType::min( BSON( "x" << 0 ) ) <<
+                          ChunkType::max( BSON( "x" << 10 ) ) ) ) );
+        }
+
+        TEST( BalancerPolicyTests, ConcurrentMigrationsDisjointShards ) {
+            vector<shared_ptr<MigrateInfo> > candidates;
+            candidates.push_back( migrateInfo( "a.a", "shard0", "shard1" ) );
+            candidates.push_back( migrateInfo( "a.b", "shard0", "shard2" ) ); // shard0 is busy
+            candidates.push_back( migrateInfo( "a.c", "shard2", "shard3" ) );
+            candidates.push_back( migrateInfo( "a.d", "shard4", "shard1" ) ); // shard1 is busy
+            candidates.push_back( migrateInfo( "a.e", "shard5", "shard4" ) );
+
+            vector<shared_ptr<MigrateInfo> > picked;
+            vector<shared_ptr<MigrateInfo> > deferred;
+            BalancerPolicy::pickConcurrentMigrations( candidates, 0, &picked, &deferred );
+            ASSERT_EQUALS( 3U, picked.size() );
+            ASSERT_EQUALS( "a.a", picked[0]->ns );
+            ASSERT_EQUALS( "a.c", picked[1]->ns );
+            ASSERT_EQUALS( "a.e", picked[2]->ns );
+            ASSERT_EQUALS( 2U, deferred.size() );
+            ASSERT_EQUALS( "a.b", deferred[0]->ns );
+            ASSERT_EQUALS( "a.d", deferred[1]->ns );
+        }
+
+        TEST( BalancerPolicyTests, ConcurrentMigrationsOnePerCollection ) {
+            vector<shared_ptr<MigrateInfo> > candidates;
+            candidates.push_back( migrateInfo( "a.a", "shard0", "shard1" ) );
+            candidates.push_back( migrateInfo( "a.a", "shard2", "shard3" ) );
+            candidates.push_back( migrateInfo( "a.b", "shard2", "shard3" ) );
+
+            vector<shared_ptr<MigrateInfo> > picked;
+            vector<shared_ptr<MigrateInfo> > deferred;
+            BalancerPolicy::pickConcurrentMigrations( candidates, 0, &picked, &deferred );
+            ASSERT_EQUALS( 2U, picked.size() );
+            ASSERT_EQUALS( "a.a", picked[0]->ns );
+            ASSERT_EQUALS( "shard0", picked[0]->from );
+            ASSERT_EQUALS( "a.b", picked[1]->ns );
+            ASSERT_EQUALS( 1U, deferred.size() );
+            ASSERT_EQUALS( "shard2", deferred[0]->from );
+        }
+
+        TEST( BalancerPolicyTests, ConcurrentMigrationsLimit ) {
+            vector<shared_ptr<MigrateInfo> > candidates;
+            candidates.push_back( migrateInfo( "a.a", "shard0", "shard1" ) );
+            candidates.push_back( migrateInfo( "a.b", "shard2", "shard3" ) );
+            candidates.push_back( migrateInfo( "a.c", "shard4", "shard5" ) );
+
+            vector<shared_ptr<MigrateInfo> > picked;
+            vector<shared_ptr<MigrateInfo> > deferred;
+            BalancerPolicy::pickConcurrentMigrations( candidates, 2, &picked, &deferred );
+            ASSERT_EQUALS( 2U, picked.size() );
+            ASSERT_EQUALS( "a.a", picked[0]->ns );
+            ASSERT_EQUALS( "a.b", picked[1]->ns );
+            ASSERT_EQUALS( 1U, deferred.size() );
+            ASSERT_EQUALS( "a.c", deferred[0]->ns );
+        }
+
+        TEST( BalancerPolicyTests, ConcurrentMigrationsInWaves ) {
+            // every candidate shares shard0, so they run one wave each, in order
+            vector<shared_ptr<MigrateInfo> > remaining;
+            remaining.push_back( migrateInfo( "a.a", "shard0", "shard1" ) );
+            remaining.push_back( migrateInfo( "a.b", "shard0", "shard2" ) );
+            remaining.push_back( migrateInfo( "a.c", "shard3", "shard0" ) );
+
+            vector<string> order;
+            int waves = 0;
+            while ( ! remaining.empty() ) {
+                vector<shared_ptr<MigrateInfo> > picked;
+                vector<shared_ptr<MigrateInfo> > deferred;
+                BalancerPolicy::pickConcurrentMigrations( remaining, 0, &picked, &deferred );
+                ASSERT_EQUALS( 1U, picked.size() );
+                order.push_back( picked[0]->ns );
+                remaining.swap( deferred );
+                waves++;
+            }
+
+            ASSERT_EQUALS( 3, waves );
+            ASSERT_EQUALS( "a.a", order[0] );
+            ASSERT_EQUALS( "a.b", order[1] );
+            ASSERT_EQUALS( "a.c", order[2] );
+        }
+
+        BSONObj rangeChunk( int min, int max ) {
+            return BSON( ChunkType::min( BSON( "x" << min ) ) <<
+                         ChunkType::max( BSON( "x" << max ) ) );
+        }
+
+        const long long MB = 1024 * 1024;
+
+        TEST( BalancerPolicyTests, BalanceByLoadDataSize ) {
+            // same number of chunks, but shard0 holds 3x the data of shard1
+            ShardToChunksMap chunkMap;
+            chunkMap["shard0"].push_back( rangeChunk( 0, 10 ) );
+            chunkMap["shard0"].push_back( rangeChunk( 10, 20 ) );
+            chunkMap["shard1"].push_back( rangeChunk( 20, 30 ) );
+            chunkMap["shard1"].push_back( rangeChunk( 30, 40 ) );
+
+            ShardInfoMap info;
+            info["shard0"] = ShardInfo( 0, 0, false, false );
+            info["shard1"] = ShardInfo( 0, 0, false, false );
+
+            DistributionStatus status( info, chunkMap );
+            status.setChunkDataSize( BSON( "x" << 0 ), 30 * MB );
+            status.setChunkDataSize( BSON( "x" << 10 ), 30 * MB );
+            status.setChunkDataSize( BSON( "x" << 20 ), 10 * MB );
+            status.setChunkDataSize( BSON( "x" << 30 ), 10 * MB );
+
+            ASSERT( ! BalancerPolicy::balance( "ns", status, 1 ) );
+
+            scoped_ptr<MigrateInfo> c( BalancerPolicy::balance( "ns", status, 1, true ) );
+            ASSERT( c );
+            ASSERT_EQUALS( "shard0", c->from );
+            ASSERT_EQUALS( "shard1", c->to );
+            // of the two equal chunks, the one next to shard1's chunks
+            ASSERT_EQUALS( 10, c->chunk.min["x"].numberInt() );
+        }
+
+        TEST( BalancerPolicyTests, BalanceByLoadNoNarrowingMove ) {
+            // moving the only chunk of shard0 would leave shard1 more loaded than shard0 was
+            ShardToChunksMap chunkMap;
+            chunkMap["shard0"].push_back( rangeChunk( 0, 10 ) );
+            chunkMap["shard1"].push_back( rangeChunk( 10, 20 ) );
+
+            ShardInfoMap info;
+            info["shard0"] = ShardInfo( 0, 0, false, false );
+            info["shard1"] = ShardInfo( 0, 0, false, false );
+
+            DistributionStatus status( info, chunkMap );
+            status.setChunkDataSize( BSON( "x" << 0 ), 30 * MB );
+            status.setChunkDataSize( BSON( "x" << 10 ), 20 * MB );
+
+            ASSERT( ! BalancerPolicy::balance( "ns", status, 1, true ) );
+        }
+
+        TEST( BalancerPolicyTests, BalanceByLoadOperations ) {
+            // same data on both shards, but shard0 serves 3x the operations of shard1
+            ShardToChunksMap chunkMap;
+            for ( int i = 0; i < 8; i++ )
+                chunkMap[ i < 4 ? "shard0" : "shard1" ].push_back( rangeChunk( i * 10,
+                                                                               i * 10 + 10 ) );
+
+            ShardInfoMap info;
+            info["shard0"] = ShardInfo( 0, 0, false, false );
+            info["shard1"] = ShardInfo( 0, 0, false, false );
+
+            DistributionStatus status( info, chunkMap );
+            for ( int i = 0; i < 8; i++ )
+                status.setChunkDataSize( BSON( "x" << i * 10 ), 10 * MB );
+
+            ASSERT( ! BalancerPolicy::balance( "ns", status, 1, true ) );
+
+            status.setOpsPerSec( "shard0", 300 );
+            status.setOpsPerSec( "shard1", 100 );
+
+            scoped_ptr<MigrateInfo> c( BalancerPolicy::balance( "ns", status, 1, true ) );
+            ASSERT( c );
+            ASSERT_EQUALS( "shard0", c->from );
+            ASSERT_EQUALS( "shard1", c->to );
+        }
+
+        TEST( BalancerPolicyTests, BalanceByLoadOperationsPerCollection ) {
+            // two collections laid out alike on the same shards, only "a.hot" is busy on shard0
+            ShardToChunksMap chunkMap;
+            for ( int i = 0; i < 8; i++ )
+                chunkMap[ i < 4 ? "shard0" : "shard1" ].push_back( rangeChunk( i * 10,
+                                                                               i * 10 + 10 ) );
+
+            ShardInfoMap info;
+            info["shard0"] = ShardInfo( 0, 0, false, false );
+            info["shard1"] = ShardInfo( 0, 0, false, false );
+
+            DistributionStatus hot( info, chunkMap );
+            DistributionStatus cold( info, chunkMap );
+            for ( int i = 0; i < 8; i++ ) {
+                hot.setChunkDataSize( BSON( "x" << i * 10 ), 10 * MB );
+                cold.setChunkDataSize( BSON( "x" << i * 10 ), 10 * MB );
+            }
+            hot.setOpsPerSec( "shard0", 300 );
+            hot.setOpsPerSec( "shard1", 100 );
+            cold.setOpsPerSec( "shard0", 0 );
+            cold.setOpsPerSec( "shard1", 0 );
+
+            scoped_ptr<MigrateInfo> c( BalancerPolicy::balance( "a.hot", hot, 1, true ) );
+            ASSERT( c );
+            ASSERT_EQUALS( "shard0", c->from );
+            ASSERT_EQUALS( "shard1", c->to );
+
+            ASSERT( ! BalancerPolicy::balance( "a.cold", cold, 1, true ) );
+        }
+
+        TEST( BalancerPolicyTests, BalanceByLoadWithoutDataSizes ) {
+            // falls back to balancing by number of chunks
+            ShardToChunksMap chunkMap;
+            chunkMap["shard0"].push_back( rangeChunk( 0, 10 ) );
+            chunkMap["shard0"].push_back( rangeChunk( 10, 20 ) );
+            chunkMap["shard1"];
+
+            ShardInfoMap info;
+            info["shard0"] = ShardInfo( 0, 0, false, false );
+            info["shard1"] = ShardInfo( 0, 0, false, false );
+
+            DistributionStatus status( info, chunkMap );
+            scoped_ptr<MigrateInfo> c( BalancerPolicy::balance( "ns", status, 1, true ) );
+            ASSERT( c );
+            ASSERT_EQUALS( "shard1", c->to );
+        }
+
+        TEST( BalancerPolicyTests, BalanceByLoadTags ) {
+            // shard2 is the least loaded, but can't take chunks tagged "a"
+            ShardToChunksMap chunkMap;
+            chunkMap["shard0"].push_back( rangeChunk( 0, 10 ) );
+            chunkMap["shard0"].push_back( rangeChunk( 10, 20 ) );
+            chunkMap["shard1"].push_back( rangeChunk( 20, 30 ) );
+            chunkMap["shard2"].push_back( rangeChunk( 100, 110 ) );
+
+            set<string> tagged;
+            tagged.insert( "a" );
+
+            ShardInfoMap info;
+            info["shard0"] = ShardInfo( 0, 0, false, false, tagged );
+            info["shard1"] = ShardInfo( 0, 0, false, false, tagged );
+            info["shard2"] = ShardInfo( 0, 0, false, false );
+
+            DistributionStatus status( info, chunkMap );
+            ASSERT( status.addTagRange( TagRange( BSON( "x" << 0 ), BSON( "x" << 100 ), "a" ) ) );
+            status.setChunkDataSize( BSON( "x" << 0 ), 30 * MB );
+            status.setChunkDataSize( BSON( "x" << 10 ), 30 * MB );
+            status.setChunkDataSize( BSON( "x" << 20 ), 10 * MB );
+            status.setChunkDataSize( BSON( "x" << 100 ), 1 * MB );
+
+            scoped_ptr<MigrateInfo> c( BalancerPolicy::balance( "ns", status, 1, true ) );
+            ASSERT( c );
+            ASSERT_EQUALS( "shard0", c->from );
+            ASSERT_EQUALS( "shard1", c->to );
+            ASSERT_EQUALS( 10, c->chunk.min["x"].numberInt() );
+        }
     }
 }
@@ -23,6 +23,8 @@
 #include "mongo/client/connpool.h"
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/db/queryutil.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/s/auto_splitter.h"
 #include "mongo/platform/random.h"
 #include "mongo/s/chunk_diff.h"
 #include "mongo/s/chunk_version.h"
@@ -56,6 +58,10 @@ namespace mongo {
     // Can be overridden from command line
     bool Chunk::ShouldAutoSplit = true;
 
+    // When set, shards pick split points from this many sampled index keys rather than by
+    // scanning every key of the chunk, see SplitVector
+    MONGO_EXPORT_SERVER_PARAMETER( splitVectorSampleSize, int, 0 );
+
     Chunk::Chunk(const ChunkManager * manager, BSONObj from)
         : _manager(manager), _lastmod(0, OID()), _dataWritten(mkDataWritten())
     {
@@ -179,6 +185,9 @@ namespace mongo {
         cmd.append( "maxChunkSizeBytes" , chunkSize );
         cmd.append( "maxSplitPoints" , maxPoints );
         cmd.append( "maxChunkObjects" , maxObjs );
+        if ( splitVectorSampleSize > 0 ) {
+            cmd.append( "sampleSize" , splitVectorSampleSize );
+        }
         BSONObj cmdObj = cmd.obj();
 
         if ( ! conn->runCommand( "admin" , cmdObj , result )) {
@@ -344,31 +353,51 @@ namespace mongo {
         return worked;
     }
 
+    int Chunk::_splitThreshold() const {
+        int splitThreshold = getManager()->getCurrentDesiredChunkSize();
+        if ( minIsInf() || maxIsInf() ) {
+            splitThreshold = (int) ((double)splitThreshold * .9);
+        }
+        return splitThreshold;
+    }
+
     bool Chunk::splitIfShould( long dataWritten ) const {
         LastError::Disabled d( lastError.get() );
 
+        _dataWritten += dataWritten;
+        if ( _dataWritten < _splitThreshold() / ChunkManager::SplitHeuristics::splitTestFactor )
+            return false;
+
+        if ( AutoSplitter::enabled ) {
+            // A chunk whose check could not be queued asks again with its next write
+            if ( autoSplitter.queueSplitCheck( getns(), getMin() ) )
+                _dataWritten = 0;
+            return false;
+        }
+
+        return autoSplit( true );
+    }
+
+    bool Chunk::autoSplit( bool syncWrites ) const {
+        LastError::Disabled d( lastError.get() );
+
         try {
-            _dataWritten += dataWritten;
-            int splitThreshold = getManager()->getCurrentDesiredChunkSize();
-            if ( minIsInf() || maxIsInf() ) {
-                splitThreshold = (int) ((double)splitThreshold * .9);
-            }
+            const int splitThreshold = _splitThreshold();
 
-            if ( _dataWritten < splitThreshold / ChunkManager::SplitHeuristics::splitTestFactor )
-                return false;
-            
             if ( ! getManager()->_splitHeuristics._splitTickets.tryAcquire() ) {
                 LOG(1) << "won't auto split because not enough tickets: " << getManager()->getns() << endl;
                 return false;
             }
             TicketHolderReleaser releaser( &(getManager()->_splitHeuristics._splitTickets) );
 
-            // this is a bit ugly
-            // we need it so that mongos blocks for the writes to actually be committed
-            // this does mean mongos has more back pressure than mongod alone
-            // since it nots 100% tcp queue bound
-            // this was implicit before since we did a splitVector on the same socket
-            ShardConnection::sync();
+            if ( syncWrites ) {
+                // this is a bit ugly
+                // we need it so that mongos blocks for the writes to actually be committed
+                // this does mean mongos has more back pressure than mongod alone
+                // since it nots 100% tcp queue bound
+                // this was implicit before since we did a splitVector on the same socket
+                ShardConnection::sync();
+            }
 
             LOG(1) << "about to initiate autosplit: " << *this << " dataWritten: " << _dataWritten << " splitThreshold: " << splitThreshold << endl;
 
@@ -590,6 +619,7 @@ namespace mongo {
         _ns( ns ),
         _key( pattern ),
         _unique( unique ),
+        _routingTable(),
         _chunkRanges(),
         _mutex("ChunkManager"),
         _sequenceNumber(++NextSequenceNumber)
@@ -609,6 +639,7 @@ namespace mongo {
                                                         collDoc[CollectionType::keyPattern()].Obj().getOwned() :
                                                         BSONObj()),
         _unique(collDoc[CollectionType::unique()].trueValue()),
+        _routingTable(),
         _chunkRanges(),
         _mutex("ChunkManager"),
         // The shard versioning mechanism hinges on keeping track of the number of times we reloaded ChunkManager's.
@@ -631,6 +662,7 @@ namespace mongo {
         _ns( oldManager->getns() ),
         _key( oldManager->getShardKey() ),
         _unique( oldManager->isUnique() ),
+        _routingTable(),
         _chunkRanges(),
         _mutex("ChunkManager"),
         _sequenceNumber(++NextSequenceNumber)
@@ -672,6 +704,7 @@ namespace mongo {
                     const_cast<ChunkMap&>(_chunkMap).swap(chunkMap);
                     const_cast<set<Shard>&>(_shards).swap(shards);
                     const_cast<ShardVersionMap&>(_shardVersions).swap(shardVersions);
+                    const_cast<ChunkRoutingTable&>(_routingTable).reloadAll(_chunkMap);
                     const_cast<ChunkRangeManager&>(_chunkRanges).reloadAll(_chunkMap);
 
                     // Once we load data, clear reference to old manager
@@ -754,7 +787,8 @@ namespace mongo {
             // Load a copy of the old versions
             shardVersions = oldManager->_shardVersions;
 
-            // Load a copy of the chunk map, replacing the chunk manager with our own
+            // Load a copy of the chunk map, replacing the chunk manager with our own.  The bounds
+            // share their buffers with the old chunks.
             const ChunkMap& oldChunkMap = oldManager->getChunkMap();
 
             // Could be v.expensive
@@ -770,7 +804,8 @@ namespace mongo {
 
                 c->setBytesWritten( oldC->getBytesWritten() );
 
-                chunkMap.insert( make_pair( oldC->getMax(), c ) );
+                // the old chunks are in order, so each insert goes at the end in constant time
+                chunkMap.insert( chunkMap.end(), make_pair( oldC->getMax(), c ) );
             }
 
             // Also get any minor versions stored for reload
@@ -972,7 +1007,8 @@ namespace mongo {
 
             if ( !initShards || !initShards->size() ) {
                 // If not specified, only use the primary shard (note that it's not safe for mongos
-                // to put initial chunks on other shards without the primary mongod knowing).
+                // to put initial chunks on other shards without the shard key index existing
+                // there, see ShardCollectionCmd).
                 shards->push_back( primary );
             } else {
                 std::copy( initShards->begin() , initShards->end() , std::back_inserter(*shards) );
@@ -1012,30 +1048,46 @@ namespace mongo {
         uassert( 13449 , str::stream() << "collection " << _ns << " already sharded with "
                                        << existingChunks << " chunks", existingChunks == 0 );
 
-        for ( unsigned i=0; i<=splitPoints.size(); i++ ) {
+        // There may be many thousands of initial chunks, so write them in batches
+        const int maxBatchSize = BSONObjMaxUserSize / 16;
+        const unsigned numChunks = splitPoints.size() + 1;
+
+        vector<BSONObj> chunkBatch;
+        int batchSize = 0;
+
+        for ( unsigned i=0; i<numChunks; i++ ) {
             BSONObj min = i == 0 ? _key.globalMin() : splitPoints[i-1];
             BSONObj max = i < splitPoints.size() ? splitPoints[i] : _key.globalMax();
 
-            Chunk temp( this , min , max , shards[ i % shards.size() ], version );
+            // Each shard gets a contiguous run of chunks, so each shard owns a single range of
+            // the key space and the routing table stays small however many chunks there are
+            const Shard& shard = shards[ ( (unsigned long long) i * shards.size() ) / numChunks ];
+
+            Chunk temp( this , min , max , shard, version );
 
             BSONObjBuilder chunkBuilder;
             temp.serialize( chunkBuilder );
             BSONObj chunkObj = chunkBuilder.obj();
 
-            conn->update(ChunkType::ConfigNS,
-                         QUERY(ChunkType::name(temp.genID())),
-                         chunkObj,
-                         true,
-                         false );
+            chunkBatch.push_back( chunkObj );
+            batchSize += chunkObj.objsize();
 
-            version.incMinor();
-        }
+            if ( batchSize > maxBatchSize || i == numChunks - 1 ) {
+                // no chunks exist for the collection, checked above
+                conn->insert( ChunkType::ConfigNS , chunkBatch );
 
-        string errmsg = conn->getLastError();
-        if ( errmsg.size() ) {
-            string ss = str::stream() << "creating first chunks failed. result: " << errmsg;
-            error() << ss << endl;
-            msgasserted( 15903 , ss );
+                string errmsg = conn->getLastError();
+                if ( errmsg.size() ) {
+                    string ss = str::stream() << "creating first chunks failed. result: " << errmsg;
+                    error() << ss << endl;
+                    msgasserted( 15903 , ss );
+                }
+
+                chunkBatch.clear();
+                batchSize = 0;
+            }
+
+            version.incMinor();
         }
         
         conn.done();
@@ -1045,15 +1097,7 @@ namespace mongo {
 
     ChunkPtr ChunkManager::findIntersectingChunk( const BSONObj& point ) const {
         {
-            BSONObj foo;
-            ChunkPtr c;
-            {
-                ChunkMap::const_iterator it = _chunkMap.upper_bound( point );
-                if (it != _chunkMap.end()) {
-                    foo = it->first;
-                    c = it->second;
-                }
-            }
+            ChunkPtr c = _routingTable.upperBound( point );
 
             if ( c ) {
                 if ( c->containsPoint( point ) ){
@@ -1061,7 +1105,7 @@ namespace mongo {
                     return c;
                 }
 
-                PRINT(foo);
+                PRINT(c->getMax());
                 PRINT(*c);
                 PRINT( point );
 
@@ -1355,6 +1399,73 @@ namespace mongo {
         }
     }
 
+    unsigned long long ChunkRoutingTable::routingKey( const BSONObj& o ) {
+        BSONElement e = o.firstElement();
+        if ( e.eoo() )
+            return 0;
+
+        // values of different canonical types order by type, MinKey (-1) to MaxKey (127)
+        unsigned long long key = static_cast<unsigned long long>( e.canonicalType() + 1 ) << 56;
+        if ( ! e.isNumber() )
+            return key;
+
+        // numbers compare as doubles, NaN below all others and -0 equal to 0
+        double d = e.number();
+        if ( isNaN( d ) )
+            return key;
+        if ( d == 0 )
+            d = 0;
+
+        // flip the IEEE 754 bits so they order as unsigned integers, then keep the top 56 bits
+        unsigned long long bits;
+        memcpy( &bits, &d, sizeof( bits ) );
+        bits = ( bits & ( 1ULL << 63 ) ) ? ~bits : bits | ( 1ULL << 63 );
+        return key | ( bits >> 8 );
+    }
+
+    struct ChunkRoutingTable::EntryKeyCmp {
+        bool operator()( const Entry& entry, unsigned long long key ) const {
+            return entry.key < key;
+        }
+        bool operator()( unsigned long long key, const Entry& entry ) const {
+            return key < entry.key;
+        }
+    };
+
+    struct ChunkRoutingTable::EntryBoundCmp {
+        bool operator()( const BSONObj& point, const Entry& entry ) const {
+            return point.woCompare( entry.chunk->first ) < 0;
+        }
+    };
+
+    void ChunkRoutingTable::reloadAll( const ChunkMap& chunks ) {
+        vector<Entry> entries;
+        entries.reserve( chunks.size() );
+
+        for ( ChunkMap::const_iterator it = chunks.begin(), end = chunks.end(); it != end; ++it ) {
+            Entry entry;
+            entry.key = routingKey( it->first );
+            entry.chunk = it;
+            entries.push_back( entry );
+        }
+
+        _entries.swap( entries );
+    }
+
+    ChunkPtr ChunkRoutingTable::upperBound( const BSONObj& point ) const {
+        const unsigned long long key = routingKey( point );
+
+        // bounds with a lower key are below the point and those with a higher key above it, only
+        // the ones with the same key need comparing as BSON
+        pair<vector<Entry>::const_iterator, vector<Entry>::const_iterator> sameKey =
+                std::equal_range( _entries.begin(), _entries.end(), key, EntryKeyCmp() );
+        vector<Entry>::const_iterator it = std::upper_bound( sameKey.first, sameKey.second,
+                                                             point, EntryBoundCmp() );
+        if ( it == _entries.end() )
+            return ChunkPtr();
+        return it->chunk->second;
+    }
+
     void ChunkRangeManager::reloadAll(const ChunkMap& chunks) {
         _ranges.clear();
         _insertRange(chunks.begin(), chunks.end());
@@ -1401,6 +1512,7 @@ namespace mongo {
     /** This is for testing only, just setting up minimal basic defaults. */
     ChunkManager::ChunkManager() :
     _unique(),
+    _routingTable(),
     _chunkRanges(),
     _mutex( "ChunkManager" ),
     _sequenceNumber()
@@ -105,10 +105,20 @@ namespace mongo {
         /**
          * if the amount of data written nears the max size of a shard
          * then we check the real size, and if its too big, we split
+         * When AutoSplitter::enabled, the check is queued to the AutoSplitter instead.
          * @return if something was split
          */
         bool splitIfShould( long dataWritten ) const;
 
+        /**
+         * Asks the shard whether this chunk is large enough to split, and if so splits it and
+         * may move one of the halves. Never throws.
+         * @param syncWrites waits for the calling thread's writes to the shards first, once a
+         *        split ticket was acquired, so that a writing client feels the back pressure
+         * @return if something was split
+         */
+        bool autoSplit( bool syncWrites = false ) const;
+
         /**
          * Splits this chunk at a non-specificed split key to be chosen by the mongod holding this chunk.
          *
@@ -246,6 +256,9 @@ namespace mongo {
         /** initializes _dataWritten with a random value so that a mongos restart wouldn't cause delay in splitting */
         static int mkDataWritten();
 
+        /** @return the size in bytes above which this chunk should be split */
+        int _splitThreshold() const;
+
         ShardKeyPattern skey() const;
     };
 
@@ -323,6 +336,41 @@ namespace mongo {
         ChunkRangeMap _ranges;
     };
 
+    /**
+     * An index over a ChunkMap for routing keys: one 16 byte entry per chunk, in max bound order,
+     * holding a 64 bit key extracted from the first field of the max bound and the chunk's map
+     * entry.  A lookup is a binary search over the integer keys, and compares BSON only among
+     * the few bounds whose keys tie with the point's.  Built over its ChunkManager's map once
+     * that is loaded and read only afterwards, so lookups need no locking.
+     */
+    class ChunkRoutingTable {
+    public:
+        /** 'chunks' must not change, or be destroyed, while this table is used */
+        void reloadAll( const ChunkMap& chunks );
+
+        size_t size() const { return _entries.size(); }
+
+        /** @return the first chunk whose max is greater than 'point', or null if there is none */
+        ChunkPtr upperBound( const BSONObj& point ) const;
+
+        /**
+         * @return a key for the first field of 'o' such that, for shard key values in the same
+         *     fields, key( a ) < key( b ) implies a < b.  Equal keys don't imply equal values.
+         */
+        static unsigned long long routingKey( const BSONObj& o );
+
+    private:
+        struct Entry {
+            unsigned long long key;
+            ChunkMap::const_iterator chunk;
+        };
+
+        struct EntryKeyCmp;
+        struct EntryBoundCmp;
+
+        vector<Entry> _entries;
+    };
+
     /* config.sharding
          { ns: 'alleyinsider.fs.chunks' ,
            key: { ts : 1 } ,
@@ -409,7 +457,7 @@ namespace mongo {
         /** @param shards set to the shards covered by the interval [min, max], see SERVER-4791 */
         void getShardsForRange( set<Shard>& shards, const BSONObj& min, const BSONObj& max ) const;
 
-        ChunkMap getChunkMap() const { return _chunkMap; }
+        const ChunkMap& getChunkMap() const { return _chunkMap; }
 
         /**
          * Returns true if, for this shard, the chunks are identical in both chunk managers
@@ -458,6 +506,7 @@ namespace mongo {
         const bool _unique;
 
         const ChunkMap _chunkMap;
+        const ChunkRoutingTable _routingTable;
         const ChunkRangeManager _chunkRanges;
 
         const set<Shard> _shards;
@@ -598,19 +598,17 @@ namespace mongo {
                 // Pre-splitting:
                 // For new collections which use hashed shard keys, we can can pre-split the
                 // range of possible hashes into a large number of chunks, and distribute them
-                // evenly at creation time. Until we design a better initialization scheme, the
-                // safest way to pre-split is to
-                // 1. make one big chunk for each shard
-                // 2. move them one at a time
-                // 3. split the big chunks to achieve the desired total number of initial chunks
+                // evenly at creation time. As the collection is empty, the chunks are created
+                // directly on the shards that will own them, each shard getting a contiguous
+                // run of chunks, rather than created on the primary shard and migrated.
 
                 vector<Shard> shards;
                 Shard primary = config->getPrimary();
                 primary.getAllShards( shards );
                 int numShards = shards.size();
 
-                vector<BSONObj> initSplits;  // there will be at most numShards-1 of these
-                vector<BSONObj> allSplits;   // all of the initial desired split points
+                vector<BSONObj> initSplits;  // all of the initial desired split points
+                vector<Shard> initShards;    // the shards to spread the initial chunks over
 
                 bool isHashedShardKey =
                         str::equals(proposedKey.firstElement().valuestrsafe(), "hashed");
@@ -629,93 +627,48 @@ namespace mongo {
                     long long intervalSize = ( std::numeric_limits<long long>::max()/ numChunks )*2;
                     long long current = 0;
                     if( numChunks % 2 == 0 ){
-                        allSplits.push_back( BSON(proposedKey.firstElementFieldName() << current) );
+                        initSplits.push_back( BSON(proposedKey.firstElementFieldName() << current) );
                         current += intervalSize;
                     } else {
                         current += intervalSize/2;
                     }
                     for( int i=0; i < (numChunks-1)/2; i++ ){
-                        allSplits.push_back( BSON(proposedKey.firstElementFieldName() << current) );
-                        allSplits.push_back( BSON(proposedKey.firstElementFieldName() << -current));
+                        initSplits.push_back( BSON(proposedKey.firstElementFieldName() << current) );
+                        initSplits.push_back( BSON(proposedKey.firstElementFieldName() << -current));
                         current += intervalSize;
                     }
-                    sort( allSplits.begin() , allSplits.end() );
-
-                    // 1. the initial splits define the "big chunks" that we will subdivide later
-                    int lastIndex = -1;
-                    for ( int i = 1; i < numShards; i++ ){
-                        if ( lastIndex < (i*numChunks)/numShards - 1 ){
-                            lastIndex = (i*numChunks)/numShards - 1;
-                            initSplits.push_back( allSplits[ lastIndex ] );
-                        }
-                    }
-                }
-
-                tlog() << "CMD: shardcollection: " << cmdObj << endl;
+                    sort( initSplits.begin() , initSplits.end() );
 
-                config->shardCollection( ns , proposedKey , careAboutUnique , &initSplits );
-
-                result << "collectionsharded" << ns;
-
-                // only initially move chunks when using a hashed shard key
-                if (isHashedShardKey) {
-
-                    // Reload the new config info.  If we created more than one initial chunk, then
-                    // we need to move them around to balance.
-                    ChunkManagerPtr chunkManager = config->getChunkManager( ns , true );
-                    ChunkMap chunkMap = chunkManager->getChunkMap();
-                    // 2. Move and commit each "big chunk" to a different shard.
-                    int i = 0;
-                    for ( ChunkMap::const_iterator c = chunkMap.begin(); c != chunkMap.end(); ++c,++i ){
-                        Shard to = shards[ i % numShards ];
-                        ChunkPtr chunk = c->second;
-
-                        // can't move chunk to shard it's already on
-                        if ( to == chunk->getShard() )
+                    // A shard otherwise only gets the shard key index when a chunk migrates to
+                    // it, so build it on every other shard before giving them chunks
+                    for ( vector<Shard>::const_iterator i = shards.begin(); i != shards.end(); ++i ) {
+                        if ( *i == primary )
                             continue;
 
-                        BSONObj moveResult;
-                        if (!chunk->moveAndCommit(to, Chunk::MaxChunkSize,
-                                false, true, moveResult)) {
-                            warning() << "Couldn't move chunk " << chunk << " to shard "  << to
-                                      << " while sharding collection " << ns << ". Reason: "
-                                      <<  moveResult << endl;
+                        ScopedDbConnection shardConn( i->getConnString() );
+                        // call ensureIndex with cache=false, see SERVER-1691
+                        bool ensureSuccess = shardConn->ensureIndex( ns ,
+                                                                     proposedKey ,
+                                                                     careAboutUnique ,
+                                                                     "" ,
+                                                                     false );
+                        shardConn.done();
+                        if ( ! ensureSuccess ) {
+                            errmsg = str::stream() << "ensureIndex failed to create index on shard "
+                                                   << i->getName();
+                            return false;
                         }
                     }
 
-                    if (allSplits.empty()) {
-                        return true;
-                    }
+                    initShards = shards;
+                }
 
-                    // Reload the config info, after all the migrations
-                    chunkManager = config->getChunkManager( ns , true );
-
-                    // 3. Subdivide the big chunks by splitting at each of the points in "allSplits"
-                    //    that we haven't already split by.
-                    ChunkPtr currentChunk = chunkManager->findIntersectingChunk( allSplits[0] );
-                    vector<BSONObj> subSplits;
-                    for ( unsigned i = 0 ; i <= allSplits.size(); i++){
-                        if ( i == allSplits.size() || ! currentChunk->containsPoint( allSplits[i] ) ) {
-                            if ( ! subSplits.empty() ){
-                                BSONObj splitResult;
-                                if ( ! currentChunk->multiSplit( subSplits , splitResult ) ){
-                                    warning() << "Couldn't split chunk " << currentChunk
-                                              << " while sharding collection " << ns << ". Reason: "
-                                              << splitResult << endl;
-                                }
-                                subSplits.clear();
-                            }
-                            if ( i < allSplits.size() )
-                                currentChunk = chunkManager->findIntersectingChunk( allSplits[i] );
-                        } else {
-                            subSplits.push_back( allSplits[i] );
-                        }
-                    }
+                tlog() << "CMD: shardcollection: " << cmdObj << endl;
 
-                    // Proactively refresh the chunk manager. Not really necessary, but this way it's
-                    // immediately up-to-date the next time it's used.
-                    config->getChunkManager( ns , true );
-                }
+                config->shardCollection( ns , proposedKey , careAboutUnique , &initSplits ,
+                                         &initShards );
+
+                result << "collectionsharded" << ns;
 
                 return true;
             }
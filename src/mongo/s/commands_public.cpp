@@ -40,6 +40,7 @@
 #include "mongo/s/config.h"
 #include "mongo/s/grid.h"
 #include "mongo/s/interrupt_status_mongos.h"
+#include "mongo/s/shared_connection_pool.h"
 #include "mongo/s/strategy.h"
 #include "mongo/s/version_manager.h"
 #include "mongo/scripting/engine.h"
@@ -86,6 +87,22 @@ namespace mongo {
 
         private:
             bool _passthrough(const string& db,  DBConfigPtr conf, const BSONObj& cmdObj , int options , BSONObjBuilder& result ) {
+                if ( ShardConnection::shareConnectionsForUnversionedCommands &&
+                     conf->getPrimary().getAddress().type() != ConnectionString::SYNC ) {
+                    BSONObj res;
+                    bool ok;
+                    if ( sharedConnectionPool.tryRunCommand( conf->getPrimary().getConnString(),
+                                                             db , cmdObj , res , ok ,
+                                                             passOptions() ? options : 0 ) ) {
+                        if ( ! ok && res["code"].numberInt() == SendStaleConfigCode ) {
+                            throw RecvStaleConfigException( "command failed because of stale config", res );
+                        }
+                        result.appendElements( res );
+                        return ok;
+                    }
+                    // no shared connection was free in time, use this thread's own
+                }
+
                 ShardConnection conn( conf->getPrimary() , "" );
                 BSONObj res;
                 bool ok = conn->runCommand( db , cmdObj , res , passOptions() ? options : 0 );
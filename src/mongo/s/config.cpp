@@ -20,10 +20,13 @@
 
 #include "pcrecpp.h"
 
+#include "mongo/base/counter.h"
 #include "mongo/client/connpool.h"
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/client/model.h"
+#include "mongo/client/syncclusterconnection.h"
 #include "mongo/db/cmdline.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/pdfile.h"
 #include "mongo/s/chunk.h"
 #include "mongo/s/chunk_version.h"
@@ -204,6 +207,24 @@ namespace mongo {
             sleepsecs( i );
         }
 
+        // The other shards given initial chunks would learn of them on their first versioned
+        // request, tell them now so that request doesn't have to wait for the refresh
+        if ( initShards ) {
+            for ( vector<Shard>::const_iterator i = initShards->begin(); i != initShards->end(); ++i ) {
+                if ( *i == getPrimary() )
+                    continue;
+                try {
+                    ShardConnection conn( *i, ns );
+                    conn.setVersion();
+                    conn.done();
+                }
+                catch( DBException& e ){
+                    warning() << "could not update initial version of " << ns << " on shard " << *i
+                              << causedBy( e ) << endl;
+                }
+            }
+        }
+
         return manager;
     }
 
@@ -287,10 +308,16 @@ namespace mongo {
         }
     }
 
+    static Counter64 chunkManagerReloads;
+    static ServerStatusMetricField<Counter64> displayChunkManagerReloads(
+            "sharding.chunkManagerReload.reloads", &chunkManagerReloads );
+
+    static Counter64 chunkManagerReloadsJoined;
+    static ServerStatusMetricField<Counter64> displayChunkManagerReloadsJoined(
+            "sharding.chunkManagerReload.joined", &chunkManagerReloadsJoined );
+
     ChunkManagerPtr DBConfig::getChunkManager( const string& ns , bool shouldReload, bool forceReload ) {
-        BSONObj key;
-        ChunkVersion oldVersion;
-        ChunkManagerPtr oldManager;
+        unsigned long long reloadNumber;
 
         {
             scoped_lock lk( _lock );
@@ -308,6 +335,65 @@ namespace mongo {
             if ( ! ( shouldReload || forceReload ) || earlyReload )
                 return ci.getCM();
 
+            // Many threads that see the same stale version ask for a reload at once. Any reload
+            // that starts from now on will do for this one; wait for one if another thread runs
+            // it, or run it here.
+            ChunkManagerReloads& reloads = _chunkManagerReloads[ns];
+            const unsigned long long needed = reloads.started + 1;
+            reloads.forceNext = reloads.forceNext || forceReload;
+
+            while ( reloads.inProgress && reloads.finished < needed ) {
+                _chunkManagerReloaded.wait( lk.boost() );
+            }
+
+            if ( reloads.finished >= needed ) {
+                chunkManagerReloadsJoined.increment();
+                CollectionInfo& ci = _collections[ns];
+                uassert( 16823 , str::stream() << "not sharded after reloading chunk manager : " << ns ,
+                         ci.isSharded() );
+                return ci.getCM();
+            }
+
+            reloads.inProgress = true;
+            reloadNumber = ++reloads.started;
+            forceReload = reloads.forceNext;
+            reloads.forceNext = false;
+        }
+
+        chunkManagerReloads.increment();
+
+        ChunkManagerPtr manager;
+        try {
+            manager = _reloadChunkManager( ns, forceReload );
+        }
+        catch ( ... ) {
+            scoped_lock lk( _lock );
+            ChunkManagerReloads& reloads = _chunkManagerReloads[ns];
+            reloads.inProgress = false;
+            reloads.forceNext = reloads.forceNext || forceReload;
+            _chunkManagerReloaded.notify_all();
+            throw;
+        }
+
+        scoped_lock lk( _lock );
+        ChunkManagerReloads& reloads = _chunkManagerReloads[ns];
+        reloads.inProgress = false;
+        reloads.finished = reloadNumber;
+        _chunkManagerReloaded.notify_all();
+        return manager;
+    }
+
+    ChunkManagerPtr DBConfig::_reloadChunkManager( const string& ns, bool forceReload ) {
+        BSONObj key;
+        ChunkVersion oldVersion;
+        ChunkManagerPtr oldManager;
+
+        {
+            scoped_lock lk( _lock );
+
+            CollectionInfo& ci = _collections[ns];
+            uassert( 16824 ,  (string)"not sharded:" + ns , ci.isSharded() );
+
             key = ci.key().copy();
             if ( ci.getCM() ){
                 oldManager = ci.getCM();
@@ -704,6 +790,16 @@ namespace mongo {
 
     /* --- ConfigServer ---- */
 
+    // phases of the writes sent to the config servers through SyncClusterConnection
+    static ServerStatusMetricField<Counter64> displaySyncClusterPrepares(
+            "syncCluster.prepare.num", &SyncClusterConnection::prepareCount );
+    static ServerStatusMetricField<Counter64> displaySyncClusterPrepareMillis(
+            "syncCluster.prepare.totalMillis", &SyncClusterConnection::prepareMillis );
+    static ServerStatusMetricField<Counter64> displaySyncClusterCommits(
+            "syncCluster.commit.num", &SyncClusterConnection::commitCount );
+    static ServerStatusMetricField<Counter64> displaySyncClusterCommitMillis(
+            "syncCluster.commit.totalMillis", &SyncClusterConnection::commitMillis );
+
     ConfigServer::ConfigServer() : DBConfig( "config" ) {
         _shardingEnabled = false;
     }
@@ -187,6 +187,24 @@ namespace mongo {
         bool _reload();
         void _save( bool db = true, bool coll = true );
 
+        /** Reloads the chunk manager of 'ns' from the config servers, see getChunkManager(). */
+        ChunkManagerPtr _reloadChunkManager( const string& ns, bool forceReload );
+
+        /**
+         * Chunk manager reloads of one namespace. Numbered as they start, so a caller that
+         * needs a reload can wait for one that starts after it asked, shared with everyone
+         * else who asked meanwhile, instead of querying the config servers itself.
+         */
+        struct ChunkManagerReloads {
+            ChunkManagerReloads() : inProgress( false ), started( 0 ), finished( 0 ),
+                                    forceNext( false ) {}
+
+            bool inProgress;
+            unsigned long long started;
+            unsigned long long finished; // number of the last reload to finish
+            bool forceNext; // some waiter needs the next reload forced
+        };
+
         string _name; // e.g. "alleyinsider"
         Shard _primary; // e.g. localhost , mongo.foo.com:9999
         bool _shardingEnabled;
@@ -198,6 +216,10 @@ namespace mongo {
 
         mutable mongo::mutex _lock; // TODO: change to r/w lock ??
         mutable mongo::mutex _hitConfigServerLock;
+
+        // protected by _lock
+        map<string,ChunkManagerReloads> _chunkManagerReloads;
+        boost::condition _chunkManagerReloaded;
     };
 
     class ConfigServer : public DBConfig {
@@ -0,0 +1,198 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mongo/pch.h"
+
+#include "mongo/s/config_change_listener.h"
+
+#include "mongo/base/counter.h"
+#include "mongo/client/connpool.h"
+#include "mongo/client/dbclientcursor.h"
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/s/config.h"
+#include "mongo/s/grid.h"
+#include "mongo/s/type_changelog.h"
+
+namespace mongo {
+
+    ConfigChangeListener configChangeListener;
+
+    bool ConfigChangeListener::enabled = false;
+
+    ExportedServerParameter<bool> ConfigChangeListenerParameter(
+        ServerParameterSet::getGlobal(),
+        "tailConfigChangelog",
+        &ConfigChangeListener::enabled,
+        true,
+        true
+    );
+
+    static Counter64 changelogEntriesRead;
+    static ServerStatusMetricField<Counter64> displayChangelogEntriesRead(
+            "sharding.configChangelog.entries", &changelogEntriesRead );
+
+    static Counter64 changelogCollectionsRefreshed;
+    static ServerStatusMetricField<Counter64> displayChangelogCollectionsRefreshed(
+            "sharding.configChangelog.collectionsRefreshed", &changelogCollectionsRefreshed );
+
+    static Counter64 changelogDatabasesRefreshed;
+    static ServerStatusMetricField<Counter64> displayChangelogDatabasesRefreshed(
+            "sharding.configChangelog.databasesRefreshed", &changelogDatabasesRefreshed );
+
+    ConfigChangeListener::ConfigChangeListener() {
+    }
+
+    void ConfigChangeListener::run() {
+        size_t hostIndex = 0;
+
+        while ( ! inShutdown() ) {
+            if ( ! enabled ) {
+                // changes made while disabled were picked up by stale version errors
+                _lastID.clear();
+                sleepsecs( 1 );
+                continue;
+            }
+
+            // every config server holds the whole changelog; move to the next one if the
+            // one tailed fails
+            vector<HostAndPort> hosts =
+                configServer.getPrimary().getAddress().getServers();
+            if ( hosts.empty() ) {
+                sleepsecs( 1 );
+                continue;
+            }
+            const string host = hosts[ hostIndex % hosts.size() ].toString();
+
+            try {
+                _tail( host );
+            }
+            catch ( std::exception& e ) {
+                warning() << "tailing config changelog on " << host << " failed"
+                          << causedBy( e ) << endl;
+                hostIndex++;
+                sleepsecs( 1 );
+            }
+        }
+    }
+
+    void ConfigChangeListener::_tail( const string& host ) {
+        ScopedDbConnection conn( host, 30.0 );
+
+        // A tailable cursor on an empty capped collection dies at once, so wait for a first
+        // entry. Everything up to the newest entry was either seen before or predates the
+        // listener.
+        BSONObj newest = conn->findOne( ChangelogType::ConfigNS,
+                                        Query().sort( BSON( "$natural" << -1 ) ) );
+        if ( newest.isEmpty() ) {
+            conn.done();
+            sleepsecs( 1 );
+            return;
+        }
+        const string newestID = newest[ChangelogType::changeID()].str();
+
+        // The cursor reads the changelog from its start once, then stays open at its end
+        auto_ptr<DBClientCursor> cursor =
+            conn->query( ChangelogType::ConfigNS, Query(), 0, 0, NULL,
+                         QueryOption_CursorTailable | QueryOption_AwaitData );
+        uassert( 16825, "could not query config changelog", cursor.get() );
+
+        bool pastLast = false;
+        bool pastNewest = false;
+        while ( enabled && ! inShutdown() ) {
+            if ( ! cursor->more() ) {
+                // a tailable cursor dies if its position rolled out of the capped collection,
+                // otherwise it just waited for new entries
+                if ( cursor->isDead() )
+                    break;
+                continue;
+            }
+
+            BSONObj entry = cursor->nextSafe();
+            const string changeID = entry[ChangelogType::changeID()].str();
+
+            if ( ! pastNewest ) {
+                if ( changeID == newestID ) {
+                    pastNewest = true;
+                    if ( ! pastLast ) {
+                        if ( ! _lastID.empty() && changeID != _lastID ) {
+                            // _lastID rolled out of the changelog or is missing on this config
+                            // server; stale version errors pick up what was missed
+                            warning() << "config changelog entry " << _lastID << " not found on "
+                                      << host << ", continuing from " << changeID << endl;
+                        }
+                        _lastID = changeID;
+                        continue;
+                    }
+                }
+                else if ( ! pastLast ) {
+                    if ( changeID == _lastID )
+                        pastLast = true;
+                    continue;
+                }
+            }
+
+            _lastID = changeID;
+
+            changelogEntriesRead.increment();
+            try {
+                _apply( entry );
+            }
+            catch ( DBException& e ) {
+                warning() << "could not refresh metadata after config change " << entry
+                          << causedBy( e ) << endl;
+            }
+        }
+
+        if ( cursor->isDead() ) {
+            conn.done();
+            sleepsecs( 1 );
+        }
+        else {
+            // disabled or shutting down with the cursor still open, drop the connection
+            conn.kill();
+        }
+    }
+
+    void ConfigChangeListener::_apply( const BSONObj& entry ) {
+        const string what = entry[ChangelogType::what()].str();
+        const string ns = entry[ChangelogType::ns()].str();
+
+        if ( ns.empty() )
+            return;
+
+        if ( what == "split" || what == "multi-split" || what == "moveChunk.commit" ) {
+            DBConfigPtr config = grid.getDBConfig( ns, false );
+            if ( ! config || ! config->isSharded( ns ) )
+                return;
+
+            LOG(1) << "refreshing " << ns << " after " << what << " in config changelog" << endl;
+            config->getChunkManagerIfExists( ns, true );
+            changelogCollectionsRefreshed.increment();
+        }
+        else if ( what == "dropCollection" || what == "dropDatabase" ) {
+            DBConfigPtr config = grid.getDBConfig( ns, false );
+            if ( ! config )
+                return;
+
+            LOG(1) << "refreshing " << nsToDatabase( ns ) << " after " << what
+                   << " in config changelog" << endl;
+            config->reload();
+            changelogDatabasesRefreshed.increment();
+        }
+    }
+
+} // namespace mongo
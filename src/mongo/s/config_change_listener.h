@@ -0,0 +1,66 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/util/background.h"
+
+namespace mongo {
+
+    /**
+     * Tails the config changelog and refreshes the cached metadata of each collection a
+     * split, migration or drop changed, so this mongos learns of changes made through other
+     * mongoses without first sending a stale version to a shard and reloading on the error.
+     *
+     * Only the collections named in the changelog are reloaded, and their chunk managers are
+     * reloaded incrementally from the cached version. Stale version errors still trigger a
+     * reload as before; the listener only makes them rarer.
+     */
+    class ConfigChangeListener : public BackgroundJob {
+    public:
+        ConfigChangeListener();
+
+        // BackgroundJob methods
+
+        virtual void run();
+
+        virtual string name() const { return "ConfigChangeListener"; }
+
+        // Set to tail the changelog
+        static bool enabled;
+
+    private:
+        /**
+         * Tails the changelog on 'host' in natural order, past _lastID, until the connection
+         * fails, the listener is disabled or mongos shuts down.
+         */
+        void _tail( const string& host );
+
+        /** Refreshes the metadata 'entry' of the changelog says has changed. */
+        void _apply( const BSONObj& entry );
+
+        // _id of the last changelog entry seen, empty until the listener first reaches the
+        // end of the changelog. Entries are matched by _id rather than time, since the time
+        // comes from the clock of whichever process logged the change.
+        string _lastID;
+    };
+
+    extern ConfigChangeListener configChangeListener;
+
+} // namespace mongo
@@ -29,16 +29,20 @@
 #include "mongo/db/auth/privilege.h"
 #include "mongo/client/connpool.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/util/concurrency/task.h"
 #include "mongo/util/net/listen.h"
 
 namespace mongo {
     const int ShardedClientCursor::INIT_REPLY_BUFFER_SIZE = 32768;
+    const long long ShardedClientCursor::PREFETCH_IDLE_MILLIS = 1000;
+    const double ShardedClientCursor::PREFETCH_RELEASE_TIMEOUT_SECS = 2;
 
     // --------  ShardedCursor -----------
 
-    ShardedClientCursor::ShardedClientCursor( QueryMessage& q , ClusteredCursor * cursor ) {
+    ShardedClientCursor::ShardedClientCursor( QueryMessage& q , ClusteredCursor * cursor )
+        : _mutex( "ShardedClientCursor" ) {
         verify( cursor );
         _cursor = cursor;
 
@@ -49,6 +53,7 @@ namespace mongo {
         _done = false;
 
         _id = 0;
+        _lastBatchMillis = Listener::getElapsedTimeMillis();
 
         if ( q.queryOptions & QueryOption_NoCursorTimeout ) {
             _lastAccessMillis = 0;
@@ -98,6 +103,7 @@ namespace mongo {
 
     bool ShardedClientCursor::sendNextBatch( Request& r , int ntoreturn ,
             BufBuilder& buffer, int& docCount ) {
+        scoped_lock lk( _mutex );
         uassert( 10191 ,  "cursor already done" , ! _done );
 
         int maxSize = 1024 * 1024;
@@ -145,10 +151,25 @@ namespace mongo {
 
         _totalSent += docCount;
         _done = ! hasMore;
+        _lastBatchMillis = Listener::getElapsedTimeMillis();
 
         return hasMore;
     }
 
+    bool ShardedClientCursor::releaseIfIdle( long long now ) {
+        // skip a cursor a getMore is using, it isn't idle
+        mongo::mutex::try_lock lk( _mutex );
+        if ( ! lk.ok )
+            return false;
+
+        if ( _done || now - _lastBatchMillis < PREFETCH_IDLE_MILLIS )
+            return false;
+
+        // may wait for the replies, which have usually arrived by now
+        _cursor->releasePrefetchConnections( PREFETCH_RELEASE_TIMEOUT_SECS );
+        return true;
+    }
+
     // ---- CursorCache -----
 
     long long CursorCache::TIMEOUT = 600000;
@@ -158,31 +179,53 @@ namespace mongo {
         return sr->nextInt64();
     }
 
+    CursorCache::Partition::Partition()
+        : mutex( "CursorCache" ),
+          shardedTotal( 0 ),
+          timedOut( 0 ) {
+    }
+
     CursorCache::CursorCache()
-        :_mutex( "CursorCache" ),
-         _random( getCCRandomSeed() ),
-         _shardedTotal(0) {
+        :_randomMutex( "CursorCacheRandom" ),
+         _random( getCCRandomSeed() ) {
     }
 
     CursorCache::~CursorCache() {
         // TODO: delete old cursors?
         bool print = logLevel > 0;
-        if ( _cursors.size() || _refs.size() )
+        size_t sharded = 0;
+        size_t refs = 0;
+        for ( int i = 0; i < NumPartitions; i++ ) {
+            verify( _partitions[i].refs.size() == _partitions[i].refsNS.size() );
+            sharded += _partitions[i].cursors.size();
+            refs += _partitions[i].refs.size();
+        }
+        if ( sharded || refs )
             print = true;
-        verify(_refs.size() == _refsNS.size());
         
         if ( print ) 
             cout << " CursorCache at shutdown - "
-                 << " sharded: " << _cursors.size()
-                 << " passthrough: " << _refs.size()
+                 << " sharded: " << sharded
+                 << " passthrough: " << refs
                  << endl;
     }
 
+    CursorCache::Partition& CursorCache::_partition( long long id ) const {
+        // our own ids have the time in their high bits and shard cursor ids need not be
+        // random at all, so mix all the bits before picking the partition
+        unsigned long long x = static_cast<unsigned long long>( id );
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        return _partitions[ x % NumPartitions ];
+    }
+
     ShardedClientCursorPtr CursorCache::get( long long id ) const {
         LOG(_myLogLevel) << "CursorCache::get id: " << id << endl;
-        scoped_lock lk( _mutex );
-        MapSharded::const_iterator i = _cursors.find( id );
-        if ( i == _cursors.end() ) {
+        Partition& p = _partition( id );
+        scoped_lock lk( p.mutex );
+        MapSharded::const_iterator i = p.cursors.find( id );
+        if ( i == p.cursors.end() ) {
             OCCASIONALLY log() << "Sharded CursorCache missing cursor id: " << id << endl;
             return ShardedClientCursorPtr();
         }
@@ -193,52 +236,66 @@ namespace mongo {
     void CursorCache::store( ShardedClientCursorPtr cursor ) {
         LOG(_myLogLevel) << "CursorCache::store cursor " << " id: " << cursor->getId() << endl;
         verify( cursor->getId() );
-        scoped_lock lk( _mutex );
-        _cursors[cursor->getId()] = cursor;
-        _shardedTotal++;
+        Partition& p = _partition( cursor->getId() );
+        scoped_lock lk( p.mutex );
+        p.cursors[cursor->getId()] = cursor;
+        p.shardedTotal++;
     }
     void CursorCache::remove( long long id ) {
         verify( id );
-        scoped_lock lk( _mutex );
-        _cursors.erase( id );
+        ShardedClientCursorPtr cursor;
+        Partition& p = _partition( id );
+        {
+            scoped_lock lk( p.mutex );
+            MapSharded::iterator i = p.cursors.find( id );
+            if ( i == p.cursors.end() )
+                return;
+            // destroyed below, once the partition is unlocked
+            cursor = i->second;
+            p.cursors.erase( i );
+        }
     }
     
     void CursorCache::removeRef( long long id ) {
         verify( id );
-        scoped_lock lk( _mutex );
-        _refs.erase( id );
-        _refsNS.erase( id );
+        Partition& p = _partition( id );
+        scoped_lock lk( p.mutex );
+        p.refs.erase( id );
+        p.refsNS.erase( id );
     }
 
     void CursorCache::storeRef(const std::string& server, long long id, const std::string& ns) {
         LOG(_myLogLevel) << "CursorCache::storeRef server: " << server << " id: " << id << endl;
         verify( id );
-        scoped_lock lk( _mutex );
-        _refs[id] = server;
-        _refsNS[id] = ns;
+        Partition& p = _partition( id );
+        scoped_lock lk( p.mutex );
+        p.refs[id] = server;
+        p.refsNS[id] = ns;
     }
 
     string CursorCache::getRef( long long id ) const {
         verify( id );
-        scoped_lock lk( _mutex );
-        MapNormal::const_iterator i = _refs.find( id );
+        Partition& p = _partition( id );
+        scoped_lock lk( p.mutex );
+        MapNormal::const_iterator i = p.refs.find( id );
 
-        LOG(_myLogLevel) << "CursorCache::getRef id: " << id << " out: " << ( i == _refs.end() ? " NONE " : i->second ) << endl;
+        LOG(_myLogLevel) << "CursorCache::getRef id: " << id << " out: " << ( i == p.refs.end() ? " NONE " : i->second ) << endl;
 
-        if ( i == _refs.end() )
+        if ( i == p.refs.end() )
             return "";
         return i->second;
     }
 
     std::string CursorCache::getRefNS(long long id) const {
         verify(id);
-        scoped_lock lk(_mutex);
-        MapNormal::const_iterator i = _refsNS.find(id);
+        Partition& p = _partition( id );
+        scoped_lock lk(p.mutex);
+        MapNormal::const_iterator i = p.refsNS.find(id);
 
         LOG(_myLogLevel) << "CursorCache::getRefNs id: " << id
-                << " out: " << ( i == _refsNS.end() ? " NONE " : i->second ) << std::endl;
+                << " out: " << ( i == p.refsNS.end() ? " NONE " : i->second ) << std::endl;
 
-        if ( i == _refsNS.end() )
+        if ( i == p.refsNS.end() )
             return "";
         return i->second;
     }
@@ -246,10 +303,11 @@ namespace mongo {
 
     long long CursorCache::genId() {
         while ( true ) {
-            scoped_lock lk( _mutex );
-
             long long x = Listener::getElapsedTimeMillis() << 32;
-            x |= _random.nextInt32();
+            {
+                scoped_lock lk( _randomMutex );
+                x |= _random.nextInt32();
+            }
 
             if ( x == 0 )
                 continue;
@@ -257,12 +315,15 @@ namespace mongo {
             if ( x < 0 )
                 x *= -1;
 
-            MapSharded::iterator i = _cursors.find( x );
-            if ( i != _cursors.end() )
+            Partition& p = _partition( x );
+            scoped_lock lk( p.mutex );
+
+            MapSharded::iterator i = p.cursors.find( x );
+            if ( i != p.cursors.end() )
                 continue;
 
-            MapNormal::iterator j = _refs.find( x );
-            if ( j != _refs.end() )
+            MapNormal::iterator j = p.refs.find( x );
+            if ( j != p.refs.end() )
                 continue;
 
             return x;
@@ -295,31 +356,35 @@ namespace mongo {
             }
 
             string server;
+            ShardedClientCursorPtr killed;
             {
-                scoped_lock lk( _mutex );
+                Partition& p = _partition( id );
+                scoped_lock lk( p.mutex );
 
-                MapSharded::iterator i = _cursors.find( id );
-                if ( i != _cursors.end() ) {
+                MapSharded::iterator i = p.cursors.find( id );
+                if ( i != p.cursors.end() ) {
                     if (authManager->checkAuthorization(i->second->getNS(),
                                                         ActionType::killCursors)) {
-                        _cursors.erase( i );
+                        // destroyed once the partition is unlocked
+                        killed = i->second;
+                        p.cursors.erase( i );
                     }
                     continue;
                 }
 
-                MapNormal::iterator refsIt = _refs.find(id);
-                MapNormal::iterator refsNSIt = _refsNS.find(id);
-                if (refsIt == _refs.end()) {
+                MapNormal::iterator refsIt = p.refs.find(id);
+                MapNormal::iterator refsNSIt = p.refsNS.find(id);
+                if (refsIt == p.refs.end()) {
                     LOG( LL_WARNING ) << "can't find cursor: " << id << endl;
                     continue;
                 }
-                verify(refsNSIt != _refsNS.end());
+                verify(refsNSIt != p.refsNS.end());
                 if (!authManager->checkAuthorization(refsNSIt->second, ActionType::killCursors)) {
                     continue;
                 }
                 server = refsIt->second;
-                _refs.erase(refsIt);
-                _refsNS.erase(refsNSIt);
+                p.refs.erase(refsIt);
+                p.refsNS.erase(refsNSIt);
             }
 
             LOG(_myLogLevel) << "CursorCache::found gotKillCursors id: " << id << " server: " << server << endl;
@@ -332,27 +397,87 @@ namespace mongo {
     }
 
     void CursorCache::appendInfo( BSONObjBuilder& result ) const {
-        scoped_lock lk( _mutex );
-        result.append( "sharded" , (int)_cursors.size() );
-        result.appendNumber( "shardedEver" , _shardedTotal );
-        result.append( "refs" , (int)_refs.size() );
-        result.append( "totalOpen" , (int)(_cursors.size() + _refs.size() ) );
+        long long sharded = 0;
+        long long shardedEver = 0;
+        long long refs = 0;
+        long long timedOut = 0;
+
+        BSONArrayBuilder partitions;
+        for ( int i = 0; i < NumPartitions; i++ ) {
+            const Partition& p = _partitions[i];
+            scoped_lock lk( p.mutex );
+
+            sharded += p.cursors.size();
+            shardedEver += p.shardedTotal;
+            refs += p.refs.size();
+            timedOut += p.timedOut;
+
+            partitions.append( BSON( "sharded" << (int)p.cursors.size()
+                                  << "refs" << (int)p.refs.size()
+                                  << "shardedEver" << p.shardedTotal
+                                  << "timedOut" << p.timedOut ) );
+        }
+
+        result.append( "sharded" , (int)sharded );
+        result.appendNumber( "shardedEver" , shardedEver );
+        result.append( "refs" , (int)refs );
+        result.append( "totalOpen" , (int)( sharded + refs ) );
+        result.appendNumber( "timedOut" , timedOut );
+        result.append( "partitions" , partitions.arr() );
     }
 
     void CursorCache::doTimeouts() {
         long long now = Listener::getElapsedTimeMillis();
-        scoped_lock lk( _mutex );
-        for ( MapSharded::iterator i=_cursors.begin(); i!=_cursors.end(); ++i ) {
-            // Note: cursors with no timeout will always have an idleTime of 0
-            long long idleFor = i->second->idleTime( now );
-            if ( idleFor < TIMEOUT ) {
-                continue;
+        for ( int p = 0; p < NumPartitions; p++ ) {
+            Partition& partition = _partitions[p];
+
+            // destroyed once the partition is unlocked
+            vector<ShardedClientCursorPtr> timedOut;
+            {
+                scoped_lock lk( partition.mutex );
+                for ( MapSharded::iterator i = partition.cursors.begin();
+                      i != partition.cursors.end(); ) {
+                    // Note: cursors with no timeout will always have an idleTime of 0
+                    long long idleFor = i->second->idleTime( now );
+                    if ( idleFor < TIMEOUT ) {
+                        ++i;
+                        continue;
+                    }
+                    log() << "killing old cursor " << i->second->getId() << " idle for: " << idleFor << "ms" << endl; // TODO: make LOG(1)
+                    timedOut.push_back( i->second );
+                    partition.cursors.erase( i++ );
+                    partition.timedOut++;
+                }
+            }
+        }
+    }
+
+    void CursorCache::releaseIdlePrefetches() {
+        long long now = Listener::getElapsedTimeMillis();
+        vector<ShardedClientCursorPtr> idle;
+        for ( int p = 0; p < NumPartitions; p++ ) {
+            Partition& partition = _partitions[p];
+            scoped_lock lk( partition.mutex );
+            idle.reserve( idle.size() + partition.cursors.size() );
+            for ( MapSharded::iterator i = partition.cursors.begin();
+                  i != partition.cursors.end(); ++i ) {
+                idle.push_back( i->second );
+            }
+        }
+
+        // Cursors left idle between getMores give back the pooled shard connections their
+        // prefetches hold. This isn't done when a batch is returned, since that would make
+        // every getMore wait for the slowest shard's next batch.
+        for ( size_t i = 0; i < idle.size(); i++ ) {
+            try {
+                idle[i]->releaseIfIdle( now );
+            }
+            catch ( DBException& e ) {
+                // the prefetched batch is lost, so the cursor can't continue
+                warning() << "killing cursor " << idle[i]->getId()
+                          << " after failing to read its prefetched batch" << causedBy( e ) << endl;
+                remove( idle[i]->getId() );
             }
-            log() << "killing old cursor " << i->second->getId() << " idle for: " << idleFor << "ms" << endl; // TODO: make LOG(1)
-            _cursors.erase( i );
-            i = _cursors.begin(); // possible 2nd entry will get skipped, will get on next pass
-            if ( i == _cursors.end() )
-                break;
         }
     }
 
@@ -368,10 +493,33 @@ namespace mongo {
         }
     };
 
+    class CursorPrefetchReleaseTask : public task::Task {
+    public:
+        virtual string name() const { return "cursorPrefetchRelease"; }
+        virtual void doWork() {
+            cursorCache.releaseIdlePrefetches();
+        }
+    };
+
     void CursorCache::startTimeoutThread() {
         task::repeat( new CursorTimeoutTask , 4000 );
+        task::repeat( new CursorPrefetchReleaseTask , 500 );
     }
 
+    class CursorServerStats : public ServerStatusSection {
+    public:
+
+        CursorServerStats() : ServerStatusSection( "cursors" ){}
+        virtual bool includeByDefault() const { return true; }
+
+        BSONObj generateSection(const BSONElement& configElement) const {
+            BSONObjBuilder b;
+            cursorCache.appendInfo( b );
+            return b.obj();
+        }
+
+    } cursorServerStats;
+
     class CmdCursorInfo : public Command {
     public:
         CmdCursorInfo() : Command( "cursorInfo", true ) {}
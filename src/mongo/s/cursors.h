@@ -67,13 +67,32 @@ namespace mongo {
         /** @return idle time in ms */
         long long idleTime( long long now );
 
+        /**
+         * Gives back the pooled shard connections held by prefetches if no batch was returned
+         * for PREFETCH_IDLE_MILLIS and no getMore is using the cursor.  Waits at most
+         * PREFETCH_RELEASE_TIMEOUT_SECS for each prefetched reply, and throws if one doesn't
+         * arrive in time or can't be read.
+         *
+         * @return true if the cursor was idle
+         */
+        bool releaseIfIdle( long long now );
+
         std::string getNS() { return _cursor->getNS(); }
 
         // The default initial buffer size for sending responses.
         static const int INIT_REPLY_BUFFER_SIZE;
 
+        // How long a cursor goes without returning a batch before releaseIfIdle() applies.
+        static const long long PREFETCH_IDLE_MILLIS;
+
+        // How long releaseIfIdle() waits for each shard's prefetched reply.
+        static const double PREFETCH_RELEASE_TIMEOUT_SECS;
+
     protected:
 
+        // held while a batch is built, see releaseIfIdle()
+        mongo::mutex _mutex;
+
         ClusteredCursor * _cursor;
 
         int _skip;
@@ -84,11 +103,19 @@ namespace mongo {
 
         long long _id;
         long long _lastAccessMillis; // 0 means no timeout
+        long long _lastBatchMillis;
 
     };
 
     typedef boost::shared_ptr<ShardedClientCursor> ShardedClientCursorPtr;
 
+    /**
+     * Sharded cursors and the ids of shard cursors passed through to clients, by cursor id.
+     *
+     * The cursors are spread over independently locked partitions by id, so getMores on
+     * different cursors rarely wait for each other. Cursors are destroyed, which can talk
+     * to the shards, only after their partition is unlocked.
+     */
     class CursorCache {
     public:
 
@@ -119,17 +146,37 @@ namespace mongo {
         long long genId();
 
         void doTimeouts();
+
+        /**
+         * Gives back the prefetch connections of cursors left idle between getMores.  Runs on
+         * its own thread, since it may wait on the shards.
+         */
+        void releaseIdlePrefetches();
+
         void startTimeoutThread();
+
+        static const int NumPartitions = 16;
     private:
-        mutable mongo::mutex _mutex;
+        struct Partition {
+            Partition();
 
-        PseudoRandom _random;
+            mutable mongo::mutex mutex;
 
-        MapSharded _cursors;
-        MapNormal _refs; // Maps cursor ID to shard name
-        MapNormal _refsNS; // Maps cursor ID to namespace
-        
-        long long _shardedTotal;
+            MapSharded cursors;
+            MapNormal refs; // Maps cursor ID to shard name
+            MapNormal refsNS; // Maps cursor ID to namespace
+
+            long long shardedTotal;
+            long long timedOut;
+        };
+
+        Partition& _partition( long long id ) const;
+
+        mutable Partition _partitions[NumPartitions];
+
+        // protects _random, which genId() shares across partitions
+        mongo::mutex _randomMutex;
+        PseudoRandom _random;
 
         static const int _myLogLevel;
     };
@@ -42,6 +42,53 @@ using namespace std;
 
 namespace mongo {
 
+    static void replyShardConfigStale( Message& m,
+                                       DbResponse* dbresponse,
+                                       const string& ns,
+                                       const string& errmsg,
+                                       const ConfigVersion& received,
+                                       const ConfigVersion& wanted ) {
+        BufBuilder b( 32768 );
+        b.skip( sizeof( QueryResult ) );
+        {
+            BSONObjBuilder bob;
+
+            bob.append( "$err", errmsg );
+            bob.append( "ns", ns );
+            wanted.addToBSON( bob, "vWanted" );
+            received.addToBSON( bob, "vReceived" );
+
+            BSONObj obj = bob.obj();
+
+            b.appendBuf( obj.objdata() , obj.objsize() );
+        }
+
+        QueryResult *qr = (QueryResult*)b.buf();
+        qr->_resultFlags() = ResultFlag_ErrSet | ResultFlag_ShardConfigStale;
+        qr->len = b.len();
+        qr->setOperation( opReply );
+        qr->cursorId = 0;
+        qr->startingFrom = 0;
+        qr->nReturned = 1;
+        b.decouple();
+
+        Message * resp = new Message();
+        resp->setData( qr , true );
+
+        dbresponse->response = resp;
+        dbresponse->responseTo = m.header()->id;
+    }
+
+    bool ShardRequestVersionBlock::handleRejected( Message& m , DbResponse* dbresponse ) {
+        if ( ! _rejected )
+            return false;
+
+        const ConfigVersion wanted = shardingState.enabled() ?
+                shardingState.getVersion( _rejectedNS ) : ConfigVersion( 0, OID() );
+        replyShardConfigStale( m, dbresponse, _rejectedNS, _rejectedMsg, _rejectedVersion, wanted );
+        return true;
+    }
+
     bool _handlePossibleShardedMessage( Message &m, DbResponse* dbresponse ) {
         DEV verify( shardingState.enabled() );
 
@@ -62,42 +109,23 @@ namespace mongo {
         }
 
         bool getsAResponse = doesOpGetAResponse( op );
+        bool rejectWrite = d.reservedField() & Reserved_StaleConfigError;
 
         LOG(1) << "connection sharding metadata does not match for collection " << ns
                << ", will retry (wanted : " << wanted << ", received : " << received << ")"
-               << ( getsAResponse ? "" : " (queuing writeback)" ) << endl;
+               << ( getsAResponse ? "" :
+                    rejectWrite ? " (rejecting write)" : " (queuing writeback)" ) << endl;
 
         if( getsAResponse ){
             verify( dbresponse );
-            BufBuilder b( 32768 );
-            b.skip( sizeof( QueryResult ) );
-            {
-                BSONObjBuilder bob;
-
-                bob.append( "$err", errmsg );
-                bob.append( "ns", ns );
-                wanted.addToBSON( bob, "vWanted" );
-                received.addToBSON( bob, "vReceived" );
-
-                BSONObj obj = bob.obj();
-
-                b.appendBuf( obj.objdata() , obj.objsize() );
-            }
-
-            QueryResult *qr = (QueryResult*)b.buf();
-            qr->_resultFlags() = ResultFlag_ErrSet | ResultFlag_ShardConfigStale;
-            qr->len = b.len();
-            qr->setOperation( opReply );
-            qr->cursorId = 0;
-            qr->startingFrom = 0;
-            qr->nReturned = 1;
-            b.decouple();
-
-            Message * resp = new Message();
-            resp->setData( qr , true );
-
-            dbresponse->response = resp;
-            dbresponse->responseTo = m.header()->id;
+            replyShardConfigStale( m, dbresponse, ns, errmsg, received, wanted );
+            return true;
+        }
+
+        if ( rejectWrite ) {
+            // The sender checks getLastError after the write, and refreshes its config and
+            // resends the write itself, so nothing is queued for the writeback listener
+            lastError.getSafe()->raiseError( SendStaleConfigCode, errmsg.c_str() );
             return true;
         }
 
@@ -197,11 +197,27 @@ namespace mongo {
         void enterForceVersionOkMode() { _forceVersionOk = true; }
         void leaveForceVersionOkMode() { _forceVersionOk = false; }
 
+        /**
+         * The version the current request carries for one namespace, see
+         * ShardRequestVersionBlock. While set it is used for that namespace instead of the
+         * version set on the connection.
+         */
+        bool hasRequestVersion( const string& ns ) const {
+            return _hasRequestVersion && _requestNS == ns;
+        }
+        const ConfigVersion& getRequestVersion() const { return _requestVersion; }
+        void setRequestVersion( const string& ns , const ConfigVersion& version );
+        void clearRequestVersion();
+
     private:
 
         OID _id;
         bool _forceVersionOk; // if this is true, then chunk version #s aren't check, and all ops are allowed
 
+        bool _hasRequestVersion;
+        string _requestNS;
+        ConfigVersion _requestVersion;
+
         typedef map<string,ConfigVersion> NSVersionMap;
         NSVersionMap _versions;
 
@@ -222,6 +238,38 @@ namespace mongo {
         ShardedConnectionInfo * info;
     };
 
+    struct DbResponse;
+
+    /**
+     * Applies the shard version a mongos attached to a query or command as
+     * { $shardVersion : { ns : <ns>, version : <ts>, versionEpoch : <oid> } } for the
+     * duration of that request, so the connection needs no setShardVersion beforehand.
+     * If the request is newer than this shard's metadata, the metadata is refreshed first.
+     * The version is rejected if the client is not authorized for setShardVersion or no
+     * setShardVersion has initialized sharding yet.
+     */
+    class ShardRequestVersionBlock : boost::noncopyable {
+    public:
+        ShardRequestVersionBlock( Message& m );
+        ~ShardRequestVersionBlock();
+
+        /**
+         * @return true, with a stale config reply in 'dbresponse', if the version sent with
+         * 'm' was rejected. The sending mongos then sets the version with setShardVersion.
+         */
+        bool handleRejected( Message& m , DbResponse* dbresponse );
+
+    private:
+        void _reject( const string& ns , const ConfigVersion& version , const string& errmsg );
+
+        ShardedConnectionInfo* _info;
+
+        bool _rejected;
+        string _rejectedNS;
+        ConfigVersion _rejectedVersion;
+        string _rejectedMsg;
+    };
+
     // -----------------
     // --- core ---
     // -----------------
@@ -51,6 +51,7 @@
 #include "mongo/db/repl/rs.h"
 #include "mongo/db/repl/rs_config.h"
 #include "mongo/db/repl/write_concern.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/chunk.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/config.h"
@@ -58,6 +59,7 @@
 #include "mongo/s/shard.h"
 #include "mongo/s/type_chunk.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/compress.h"
 #include "mongo/util/elapsed_tracker.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/queue.h"
@@ -91,10 +93,17 @@ namespace mongo {
 
     Tee* migrateLog = new RamLog( "migrate" );
 
+    // Have the donor compress the documents it sends during the initial clone of a migration.
+    MONGO_EXPORT_SERVER_PARAMETER( migrateCompressClone, bool, true );
+
+    // Limit on the rate at which a recipient copies documents during the initial clone, 0 for
+    // no limit.
+    MONGO_EXPORT_SERVER_PARAMETER( migrateCloneMaxBytesPerSec, int, 0 );
+
     class MoveTimingHelper {
     public:
         MoveTimingHelper( const string& where , const string& ns , BSONObj min , BSONObj max , int total , string& cmdErrmsg )
-            : _where( where ) , _ns( ns ) , _next( 0 ) , _total( total ) , _cmdErrmsg( cmdErrmsg ) {
+            : _where( where ) , _ns( ns ) , _next( 0 ) , _total( total ) , _bytes( 0 ) , _cmdErrmsg( cmdErrmsg ) {
             _nextNote = 0;
             _b.append( "min" , min );
             _b.append( "max" , max );
@@ -133,7 +142,13 @@ namespace mongo {
             else
                 warning() << "op is null in MoveTimingHelper::done" << migrateLog;
 
-            _b.appendNumber( s , _t.millis() );
+            int millis = _t.millis();
+            _b.appendNumber( s , millis );
+            if ( _bytes > 0 ) {
+                string rateField = str::stream() << "step" << step << " bytesPerSec";
+                _b.appendNumber( rateField , _bytes * 1000 / std::max( millis , 1 ) );
+                _bytes = 0;
+            }
             _t.reset();
 
 #if 0
@@ -146,6 +161,11 @@ namespace mongo {
         }
 
 
+        /** data moved during the current step, reported as a rate when the step is done */
+        void noteBytes( long long bytes ) {
+            _bytes += bytes;
+        }
+
         void note( const string& s ) {
             string field = "note";
             if ( _nextNote > 0 ) {
@@ -167,6 +187,7 @@ namespace mongo {
         int _next;
         int _total; // expected # of steps
         int _nextNote;
+        long long _bytes; // moved during the current step
 
         string _cmdErrmsg;
 
@@ -544,7 +565,7 @@ namespace mongo {
             return true;
         }
 
-        bool clone( string& errmsg , BSONObjBuilder& result ) {
+        bool clone( bool compressObjects , string& errmsg , BSONObjBuilder& result ) {
             if ( ! _getActive() ) {
                 errmsg = "not active";
                 return false;
@@ -613,7 +634,16 @@ namespace mongo {
                 
             }
 
-            result.appendArray( "objects" , a.arr() );
+            BSONArray arr = a.arr();
+            if ( compressObjects ) {
+                string compressed;
+                compress( arr.objdata() , arr.objsize() , &compressed );
+                result.appendBinData( "compressedObjects" , compressed.size() , BinDataGeneral ,
+                                      compressed.data() );
+            }
+            else {
+                result.appendArray( "objects" , arr );
+            }
             return true;
         }
 
@@ -840,7 +870,7 @@ namespace mongo {
             out->push_back(Privilege(AuthorizationManager::SERVER_RESOURCE_NAME, actions));
         }
         bool run(const string& , BSONObj& cmdObj, int, string& errmsg, BSONObjBuilder& result, bool) {
-            return migrateFromStatus.clone( errmsg, result );
+            return migrateFromStatus.clone( cmdObj["compress"].trueValue(), errmsg, result );
         }
     } initialCloneCommand;
 
@@ -1164,6 +1194,7 @@ namespace mongo {
             timing.done( 3 );
 
             // 4.
+            long long clonedBytes = 0;
             for ( int i=0; i<86400; i++ ) { // don't want a single chunk move to take more than a day
                 verify( !Lock::isLocked() );
                 // Exponential sleep backoff, up to 1024ms. Don't sleep much on the first few
@@ -1186,6 +1217,9 @@ namespace mongo {
 
                 LOG(0) << "moveChunk data transfer progress: " << res << " my mem used: " << migrateFromStatus.mbUsed() << migrateLog;
 
+                if ( res["counts"].isABSONObj() )
+                    clonedBytes = res["counts"].Obj()["clonedBytes"].numberLong();
+
                 if ( ! ok || res["state"].String() == "fail" ) {
                     warning() << "moveChunk error transferring data caused migration abort: " << res << migrateLog;
                     errmsg = "data transfer error";
@@ -1213,6 +1247,7 @@ namespace mongo {
 
                 killCurrentOp.checkForInterrupt();
             }
+            timing.noteBytes( clonedBytes );
             timing.done(4);
 
             // 5.
@@ -1672,9 +1707,15 @@ namespace mongo {
                 // 3. initial bulk clone
                 state = CLONE;
 
+                // Ask for the next batch before inserting the current one, so the donor reads
+                // and sends it while we write.
+                Timer cloneTimer;
+                auto_ptr<DBClientCursor> request = _requestClone( conn.get() );
                 while ( true ) {
                     BSONObj res;
-                    if ( ! conn->runCommand( "admin" , BSON( "_migrateClone" << 1 ) , res ) ) {  // gets array of objects to copy, in disk order
+                    bool ok = _receiveClone( request.get() , &res );
+                    request.reset();
+                    if ( ! ok ) {
                         state = FAIL;
                         errmsg = "_migrateClone failed: ";
                         errmsg += res.toString();
@@ -1683,40 +1724,24 @@ namespace mongo {
                         return;
                     }
 
-                    BSONObj arr = res["objects"].Obj();
-                    int thisTime = 0;
+                    string uncompressed;
+                    BSONObj arr = _cloneObjects( res , &uncompressed );
+                    if ( arr.isEmpty() )
+                        break;
 
-                    BSONObjIterator i( arr );
-                    while( i.more() ) {
-                        BSONObj o = i.next().Obj();
-                        {
-                            PageFaultRetryableSection pgrs;
-                            while ( 1 ) {
-                                try {
-                                    Lock::DBWrite lk( ns );
-                                    Helpers::upsert( ns, o, true );
-                                    break;
-                                }
-                                catch ( PageFaultException& e ) {
-                                    e.touch();
-                                }
-                            }
-                        }
-                        thisTime++;
-                        numCloned++;
-                        clonedBytes += o.objsize();
+                    request = _requestClone( conn.get() );
 
-                        if ( secondaryThrottle && thisTime > 0 ) {
-                            if ( ! waitForReplication( cc().getLastOp(), 2, 60 /* seconds to wait */ ) ) {
-                                warning() << "secondaryThrottle on, but doc insert timed out after 60 seconds, continuing" << endl;
-                            }
-                        }
-                    }
+                    _insertCloned( arr );
 
-                    if ( thisTime == 0 )
-                        break;
+                    if ( migrateCloneMaxBytesPerSec > 0 ) {
+                        long long aheadMillis = clonedBytes * 1000 / migrateCloneMaxBytesPerSec -
+                                                cloneTimer.millis();
+                        if ( aheadMillis > 0 )
+                            sleepmillis( aheadMillis );
+                    }
                 }
 
+                timing.noteBytes( clonedBytes );
                 timing.done(3);
             }
 
@@ -1850,6 +1875,89 @@ namespace mongo {
 
         }
 
+        /** Sends a _migrateClone request to the donor without waiting for the reply. */
+        static auto_ptr<DBClientCursor> _requestClone( DBClientBase* conn ) {
+            BSONObjBuilder cmd;
+            cmd.append( "_migrateClone" , 1 );
+            if ( migrateCompressClone )
+                cmd.append( "compress" , true );
+
+            auto_ptr<DBClientCursor> request( new DBClientCursor( conn , "admin.$cmd" , cmd.obj() ,
+                                                                  -1 , 0 , 0 , 0 , 0 ) );
+            request->initLazy();
+            return request;
+        }
+
+        /** Waits for the reply to a _requestClone() request, @return true if it succeeded */
+        static bool _receiveClone( DBClientCursor* request , BSONObj* res ) {
+            bool retry = false;
+            if ( ! request->initLazyFinish( retry ) || ! request->more() )
+                return false;
+            *res = request->nextSafe().getOwned();
+            return (*res)["ok"].trueValue();
+        }
+
+        /**
+         * @return the array of documents in a _migrateClone reply, which is uncompressed into
+         * 'buf' if the donor compressed it
+         */
+        static BSONObj _cloneObjects( const BSONObj& res , string* buf ) {
+            BSONElement compressed = res["compressedObjects"];
+            if ( compressed.eoo() )
+                return res["objects"].Obj();
+
+            int len;
+            const char* data = compressed.binData( len );
+            uassert( 16816 , "couldn't uncompress documents from _migrateClone" ,
+                     uncompress( data , len , buf ) );
+
+            BSONObj arr( buf->data() );
+            uassert( 16817 , "bad uncompressed document array from _migrateClone" ,
+                     static_cast<size_t>( arr.objsize() ) == buf->size() );
+            return arr;
+        }
+
+        /**
+         * Upserts the documents of one _migrateClone batch, holding the write lock for many
+         * documents at a time but yielding it every 128 documents or 10ms.  With secondaryThrottle
+         * each group of documents is replicated before the next one is written.
+         */
+        void _insertCloned( const BSONObj& arr ) {
+            BSONObjIterator i( arr );
+            BSONObj next = i.more() ? i.next().Obj() : BSONObj();
+
+            while ( ! next.isEmpty() ) {
+                {
+                    ElapsedTracker tracker( 128 , 10 );
+                    PageFaultRetryableSection pgrs;
+                    while ( 1 ) {
+                        try {
+                            Lock::DBWrite lk( ns );
+                            while ( ! next.isEmpty() ) {
+                                Helpers::upsert( ns , next , true );
+                                numCloned++;
+                                clonedBytes += next.objsize();
+                                next = i.more() ? i.next().Obj() : BSONObj();
+
+                                if ( tracker.intervalHasElapsed() )
+                                    break;
+                            }
+                            break;
+                        }
+                        catch ( PageFaultException& e ) {
+                            e.touch();
+                        }
+                    }
+                }
+
+                if ( secondaryThrottle ) {
+                    if ( ! waitForReplication( cc().getLastOp(), 2, 60 /* seconds to wait */ ) ) {
+                        warning() << "secondaryThrottle on, but doc insert timed out after 60 seconds, continuing" << endl;
+                    }
+                }
+            }
+        }
+
         bool apply( const BSONObj& xfer , ReplTime* lastOpApplied ) {
             ReplTime dummy;
             if ( lastOpApplied == NULL ) {
@@ -28,12 +28,15 @@
 #include "mongo/db/auth/action_set.h"
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/privilege.h"
+#include "mongo/db/btree.h"
 #include "mongo/db/btreecursor.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/index_legacy.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/kill_current_op.h"
+#include "mongo/platform/random.h"
 #include "mongo/s/chunk.h" // for static genID only
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/config.h"
@@ -189,6 +192,213 @@ namespace mongo {
         }
     } cmdCheckShardingIndex;
 
+    /**
+     * One index key picked by a random descent of the btree, see sampleIndexRange().
+     * 'weight' is the number of keys in the range the sample stands for.
+     */
+    struct KeySample {
+        BSONObj key;
+        double weight;
+    };
+
+    class KeySampleLess {
+    public:
+        KeySampleLess( const Ordering& ordering ) : _ordering( ordering ) {}
+        bool operator()( const KeySample& l, const KeySample& r ) const {
+            return l.key.woCompare( r.key, _ordering, false ) < 0;
+        }
+    private:
+        Ordering _ordering;
+    };
+
+    static int randomIndex( PseudoRandom& rand, size_t n ) {
+        return static_cast<uint32_t>( rand.nextInt32() ) % n;
+    }
+
+    /** @return position of the first key in 'bucket' not less than 'key' */
+    template <class V>
+    static int lowerBound( const BtreeBucket<V>* bucket,
+                           const typename V::KeyOwned& key,
+                           const Ordering& ordering ) {
+        int l = 0;
+        int h = bucket->getN();
+        while ( l < h ) {
+            int m = ( l + h ) / 2;
+            if ( bucket->keyNode( m ).key.woCompare( key, ordering ) < 0 )
+                l = m + 1;
+            else
+                h = m;
+        }
+        return l;
+    }
+
+    // The most random descents a splitVector 'sampleSize' may ask for
+    static const int MaxSampleSize = 100000;
+
+    // How many descents sampleIndexRange() makes between yields of the read lock
+    static const int SampleYieldInterval = 128;
+
+    /**
+     * Yields the read lock, touching 'rec' while it's released if given, and looks up the
+     * index 'idx' of 'ns' again, since it may have been dropped meanwhile.
+     *
+     * @return false if the collection or the index is gone, or was rebuilt in another version
+     */
+    static bool yieldForSampling( const string& ns,
+                                  const BSONObj& indexKeyPattern,
+                                  int version,
+                                  Record* rec,
+                                  NamespaceDetails** d,
+                                  const IndexDetails** idx ) {
+        ClientCursor::staticYield( 0, ns, rec );
+
+        *idx = NULL;
+        *d = nsdetails( ns );
+        if ( ! *d )
+            return false;
+
+        int idxNo = (*d)->findIndexByKeyPattern( indexKeyPattern );
+        if ( idxNo < 0 || (*d)->idx( idxNo ).version() != version )
+            return false;
+
+        *idx = &(*d)->idx( idxNo );
+        return true;
+    }
+
+    /**
+     * Samples the keys of 'idx' in [min, max) with 'numSamples' random root-to-leaf descents
+     * instead of a scan. Each descent picks one of the children covering the range at every
+     * bucket and one of the keys in the range at the leaf, both uniformly. Multiplying the
+     * number of choices along the path (Knuth's estimator) estimates the number of keys in the
+     * range without bias, and weighs each sampled key by how many keys it stands for.
+     *
+     * The read lock is yielded every SampleYieldInterval descents, and before reading a bucket
+     * that is likely not in memory, which restarts the descent. 'd' and 'idx' are looked up
+     * again after a yield.
+     *
+     * @return the estimated number of keys in the range, or -1 if the index was dropped while
+     *         the lock was yielded
+     */
+    template <class V>
+    static double sampleIndexRange( const string& ns,
+                                    NamespaceDetails** d,
+                                    const IndexDetails** idx,
+                                    const BSONObj& min,
+                                    const BSONObj& max,
+                                    int numSamples,
+                                    PseudoRandom& rand,
+                                    vector<KeySample>* samples,
+                                    long long* bucketsRead ) {
+
+        const BSONObj indexKeyPattern = (*idx)->keyPattern().getOwned();
+        const int version = (*idx)->version();
+        const Ordering ordering = Ordering::make( indexKeyPattern );
+        const typename V::KeyOwned minKey( min );
+        const typename V::KeyOwned maxKey( max );
+
+        double total = 0;
+        vector<int> keys;
+        vector<DiskLoc> children;
+        for ( int i = 0; i < numSamples; i++ ) {
+            if ( i > 0 && i % SampleYieldInterval == 0 ) {
+                if ( ! yieldForSampling( ns, indexKeyPattern, version, NULL, d, idx ) )
+                    return -1;
+            }
+
+            double weight = 1;
+            double descentTotal = 0;
+            bool faulted = false;
+            DiskLoc loc = (*idx)->head;
+            while ( ! loc.isNull() ) {
+                // Read a bucket that's not in memory with the lock released, once per descent.
+                // The btree may change meanwhile, so the descent starts over.
+                if ( ! faulted && ! loc.rec()->likelyInPhysicalMemory() ) {
+                    faulted = true;
+                    if ( ! yieldForSampling( ns, indexKeyPattern, version, loc.rec(), d, idx ) )
+                        return -1;
+                    weight = 1;
+                    descentTotal = 0;
+                    loc = (*idx)->head;
+                    continue;
+                }
+
+                const BtreeBucket<V>* bucket = loc.btree<V>();
+                ++*bucketsRead;
+
+                const int lo = lowerBound( bucket, minKey, ordering );
+                const int hi = lowerBound( bucket, maxKey, ordering );
+
+                keys.clear();
+                for ( int p = lo; p < hi; p++ ) {
+                    if ( bucket->isUsed( p ) )
+                        keys.push_back( p );
+                }
+                descentTotal += weight * keys.size();
+
+                children.clear();
+                for ( int p = lo; p <= hi; p++ ) {
+                    DiskLoc child = p == bucket->getN() ? bucket->getNextChild() :
+                                                          DiskLoc( bucket->k( p ).prevChildBucket );
+                    if ( ! child.isNull() )
+                        children.push_back( child );
+                }
+
+                if ( children.empty() ) {
+                    if ( ! keys.empty() ) {
+                        KeySample sample;
+                        int p = keys[ randomIndex( rand, keys.size() ) ];
+                        sample.key = bucket->keyNode( p ).key.toBson().getOwned();
+                        sample.weight = weight * keys.size();
+                        samples->push_back( sample );
+                    }
+                    break;
+                }
+
+                weight *= children.size();
+                loc = children[ randomIndex( rand, children.size() ) ];
+            }
+            total += descentTotal;
+        }
+
+        return total / numSamples;
+    }
+
+    /**
+     * Picks split keys from 'samples', sorted in index order, so that about 'keyCount' of the
+     * sampled keys' weight falls between consecutive split keys, the way SplitVector does with
+     * the keys of a scan. Never splits at 'firstKey', the first key of the range.
+     * @return the number of samples that were skipped as a split key because they repeat one
+     */
+    static int pickSampledSplitKeys( const vector<KeySample>& samples,
+                                     int numSamples,
+                                     const BSONObj& firstKey,
+                                     double keyCount,
+                                     long long maxSplitPoints,
+                                     const Ordering& ordering,
+                                     vector<BSONObj>* splitKeys ) {
+        int tooFrequent = 0;
+        double sinceSplit = 0;
+        BSONObj lastKey = firstKey;
+        for ( vector<KeySample>::const_iterator it = samples.begin(); it != samples.end(); ++it ) {
+            sinceSplit += it->weight / numSamples;
+            if ( sinceSplit <= keyCount )
+                continue;
+
+            if ( it->key.woCompare( lastKey, ordering, false ) == 0 ) {
+                tooFrequent++;
+                continue;
+            }
+
+            splitKeys->push_back( it->key );
+            lastKey = it->key;
+            sinceSplit = 0;
+
+            if ( maxSplitPoints && static_cast<long long>( splitKeys->size() ) >= maxSplitPoints )
+                break;
+        }
+        return tooFrequent;
+    }
+
     class SplitVector : public Command {
     public:
         SplitVector() : Command( "splitVector" , false ) {}
@@ -204,6 +414,8 @@ namespace mongo {
                  "  \n"
                  "  { splitVector : \"blog.post\" , keyPattern:{x:1} , min:{x:10} , max:{x:20}, force: true }\n"
                  "  'force' will produce one split point even if data is small; defaults to false\n"
+                 "  May optionally specify 'sampleSize' to pick split points from that many randomly sampled\n"
+                 "  index keys rather than from every key of the chunk (at most 100000)\n"
                  "NOTE: This command may take a while to run";
         }
         virtual void addRequiredPrivileges(const std::string& dbname,
@@ -243,6 +455,12 @@ namespace mongo {
                 maxSplitPoints = maxSplitPointsElem.numberLong();
             }
 
+            int sampleSize = 0;
+            BSONElement sampleSizeElem = jsobj[ "sampleSize" ];
+            if ( sampleSizeElem.isNumber() ) {
+                sampleSize = std::min( sampleSizeElem.numberInt(), MaxSampleSize );
+            }
+
             long long maxChunkObjects = Chunk::MaxObjectPerChunk;
             BSONElement MaxChunkObjectsElem = jsobj[ "maxChunkObjects" ];
             if ( MaxChunkObjectsElem.isNumber() ) {
@@ -339,7 +557,95 @@ namespace mongo {
                 }
                 
                 //
-                // 2. Traverse the index and add the keyCount-th key to the result vector. If that key
+                // 2.a If asked to, estimate the split points from a sample of the index keys in the
+                //     range. This reads a bounded number of btree buckets however large the chunk is,
+                //     which matters most for the big chunks that need splitting. Ranges no larger than
+                //     the sample are cheaper to scan, so those fall through to the exact traversal.
+                //
+
+                if ( sampleSize > 0 ) {
+                    Timer timer;
+                    PseudoRandom rand( static_cast<int64_t>( curTimeMicros64() ) );
+                    vector<KeySample> samples;
+                    long long bucketsRead = 0;
+                    double estimatedKeys = 0;
+                    switch ( idx->version() ) {
+                    case 0:
+                        estimatedKeys = sampleIndexRange<V0>( ns, &d, &idx, min, max, sampleSize,
+                                                              rand, &samples, &bucketsRead );
+                        break;
+                    case 1:
+                        estimatedKeys = sampleIndexRange<V1>( ns, &d, &idx, min, max, sampleSize,
+                                                              rand, &samples, &bucketsRead );
+                        break;
+                    }
+
+                    if ( estimatedKeys < 0 ) {
+                        errmsg = "index dropped while sampling split points";
+                        return false;
+                    }
+
+                    if ( estimatedKeys > sampleSize ) {
+                        shared_ptr<Cursor> c( BtreeCursor::make( d, *idx, min, max, false, 1 ) );
+                        if ( ! c->ok() ) {
+                            errmsg = "can't open a cursor for splitting (desired range is possibly empty)";
+                            return false;
+                        }
+                        const BSONObj firstKey = c->currKey().getOwned();
+
+                        const Ordering ordering = Ordering::make( idx->keyPattern() );
+                        sort( samples.begin(), samples.end(), KeySampleLess( ordering ) );
+
+                        // 'force' splits the chunk in half, which the scan below gets to by
+                        // scanning again if the first pass found nothing
+                        if ( force && keyCount > estimatedKeys / 2 ) {
+                            keyCount = static_cast<long long>( estimatedKeys / 2 );
+                        }
+
+                        int tooFrequent = pickSampledSplitKeys( samples, sampleSize, firstKey,
+                                                                keyCount, maxSplitPoints,
+                                                                ordering, &splitKeys );
+
+                        if ( tooFrequent ) {
+                            warning() << "chunk " << ns << " " << min << " -->> " << max
+                                      << " is likely larger than " << maxChunkSize
+                                      << " bytes because of frequent keys" << endl;
+                        }
+
+                        for ( size_t i = 0; i < splitKeys.size(); i++ ) {
+                            splitKeys[i] = splitKeys[i].replaceFieldNames( idx->keyPattern() )
+                                                       .clientReadable()
+                                                       .extractFields( keyPattern );
+                        }
+
+                        // The position of each split key is estimated from the samples between
+                        // it and the previous one, so its relative error is about 1/sqrt(those).
+                        const double samplesPerChunk = samples.size() * keyCount / estimatedKeys;
+
+                        BSONObjBuilder sampleInfo( result.subobjStart( "sample" ) );
+                        sampleInfo.append( "size", sampleSize );
+                        sampleInfo.append( "estimatedKeys", static_cast<long long>( estimatedKeys ) );
+                        sampleInfo.append( "bucketsRead", bucketsRead );
+                        sampleInfo.append( "expectedChunkSizeError",
+                                           samplesPerChunk > 0 ? 1 / sqrt( samplesPerChunk ) : 1.0 );
+                        sampleInfo.done();
+
+                        LOG(1) << "sampled " << splitKeys.size() << " split keys for " << ns
+                               << " from " << sampleSize << " samples, " << bucketsRead
+                               << " buckets read, about " << estimatedKeys << " keys in chunk"
+                               << endl;
+
+                        result.append( "timeMillis", timer.millis() );
+                        result.append( "splitKeys" , splitKeys );
+                        return true;
+                    }
+
+                    LOG(1) << "scanning " << ns << " for split points, only about "
+                           << estimatedKeys << " keys in chunk" << endl;
+                }
+
+                //
+                // 2.b Traverse the index and add the keyCount-th key to the result vector. If that key
                 //    appeared in the vector before, we omit it. The invariant here is that all the
                 //    instances of a given key value live in the same chunk.
                 //
@@ -347,6 +653,7 @@ namespace mongo {
                 Timer timer;
                 long long currCount = 0;
                 long long numChunks = 0;
+                long long keysExamined = 0;
                 
                 BtreeCursor * bc = BtreeCursor::make( d, *idx, min, max, false, 1 );
                 shared_ptr<Cursor> c( bc );
@@ -364,6 +671,7 @@ namespace mongo {
                 while ( 1 ) {
                     while ( cc->ok() ) {
                         currCount++;
+                        keysExamined++;
                         
                         if ( currCount > keyCount ) {
                             BSONObj currKey = bc->prettyKey( c->currKey() ).extractFields(keyPattern);
@@ -442,6 +750,7 @@ namespace mongo {
                 // 4MB work of 'result' size. This should be okay for now.
 
                 result.append( "timeMillis", timer.millis() );
+                result.append( "keysExamined", keysExamined );
             }
 
             result.append( "splitKeys" , splitKeys );
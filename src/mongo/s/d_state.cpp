@@ -28,10 +28,14 @@
 #include <string>
 #include <vector>
 
+#include "mongo/base/counter.h"
 #include "mongo/db/auth/action_set.h"
 #include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/privilege.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/dbmessage.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/db.h"
 #include "mongo/db/repl/is_master.h"
@@ -350,6 +354,7 @@ namespace mongo {
 
     ShardedConnectionInfo::ShardedConnectionInfo() {
         _forceVersionOk = false;
+        _hasRequestVersion = false;
         _id.clear();
     }
 
@@ -381,6 +386,17 @@ namespace mongo {
         _versions[ns] = version;
     }
 
+    void ShardedConnectionInfo::setRequestVersion( const string& ns , const ConfigVersion& version ) {
+        _hasRequestVersion = true;
+        _requestNS = ns;
+        _requestVersion = version;
+    }
+
+    void ShardedConnectionInfo::clearRequestVersion() {
+        _hasRequestVersion = false;
+        _requestNS.clear();
+    }
+
     void ShardedConnectionInfo::addHook() {
         static mongo::mutex lock("ShardedConnectionInfo::addHook mutex");
         static bool done = false;
@@ -399,6 +415,101 @@ namespace mongo {
         _id = id;
     }
 
+    // -----ShardedConnectionInfo END ----
+
+    static Counter64 requestVersionsApplied;
+    static ServerStatusMetricField<Counter64> displayRequestVersionsApplied(
+            "sharding.requestShardVersion.applied", &requestVersionsApplied );
+
+    static Counter64 requestVersionRefreshes;
+    static ServerStatusMetricField<Counter64> displayRequestVersionRefreshes(
+            "sharding.requestShardVersion.refreshes", &requestVersionRefreshes );
+
+    static Counter64 requestVersionsRejected;
+    static ServerStatusMetricField<Counter64> displayRequestVersionsRejected(
+            "sharding.requestShardVersion.rejected", &requestVersionsRejected );
+
+    ShardRequestVersionBlock::ShardRequestVersionBlock( Message& m )
+        : _info( 0 ), _rejected( false ) {
+        BSONObj query;
+        try {
+            DbMessage d( m );
+            QueryMessage q( d );
+            query = q.query;
+        }
+        catch ( DBException& ) {
+            // a malformed message is reported when the query itself is run
+            return;
+        }
+
+        BSONElement e = query["$shardVersion"];
+        if ( e.type() != Object )
+            return;
+
+        BSONObj metadata = e.embeddedObject();
+        const string ns = metadata["ns"].str();
+        bool canParse;
+        const ConfigVersion version = ConfigVersion::fromBSON( metadata, "version", &canParse );
+        if ( ns.empty() || ! canParse )
+            return;
+
+        // right now connections to secondaries aren't versioned at all, see shardVersionOk()
+        if ( ! isMasterNs( ns.c_str() ) )
+            return;
+
+        // The version is only taken from a client that could have set it with setShardVersion,
+        // and only once a setShardVersion has initialized sharding here. Otherwise the request
+        // fails as stale, and mongos retries it after an explicit setShardVersion.
+        if ( ! cc().getAuthorizationManager()->checkAuthorization(
+                    AuthorizationManager::CLUSTER_RESOURCE_NAME, ActionType::setShardVersion ) ) {
+            _reject( ns, version, "not authorized to send a shard version with a request" );
+            return;
+        }
+
+        if ( ! shardingState.enabled() ) {
+            _reject( ns, version, "sharding is not initialized, a setShardVersion is needed" );
+            return;
+        }
+
+        // The same refresh setShardVersion does when a mongos knows of a newer version than
+        // this shard. If it fails, the request fails the version check and mongos reloads.
+        const ConfigVersion globalVersion = shardingState.getVersion( ns );
+        if ( version.isSet() &&
+             ! version.isWriteCompatibleWith( globalVersion ) &&
+             ! ( version < globalVersion && version.hasCompatibleEpoch( globalVersion ) ) &&
+             ! shardingState.inCriticalMigrateSection() ) {
+
+            LOG(1) << "refreshing shard version of " << ns << " from " << globalVersion
+                   << " for request at " << version << endl;
+
+            requestVersionRefreshes.increment();
+            ConfigVersion currVersion = version;
+            shardingState.trySetVersion( ns , currVersion );
+        }
+
+        requestVersionsApplied.increment();
+        _info = ShardedConnectionInfo::get( true );
+        _info->setRequestVersion( ns , version );
+    }
+
+    void ShardRequestVersionBlock::_reject( const string& ns,
+                                           const ConfigVersion& version,
+                                           const string& errmsg ) {
+        LOG(1) << "rejecting request version " << version << " for " << ns << ": "
+               << errmsg << endl;
+
+        requestVersionsRejected.increment();
+        _rejected = true;
+        _rejectedNS = ns;
+        _rejectedVersion = version;
+        _rejectedMsg = errmsg;
+    }
+
+    ShardRequestVersionBlock::~ShardRequestVersionBlock() {
+        if ( _info )
+            _info->clearRequestVersion();
+    }
+
     class MongodShardCommand : public Command {
     public:
         MongodShardCommand( const char * n ) : Command( n ) {
@@ -540,6 +651,9 @@ namespace mongo {
             lastError.disableForCommand();
             ShardedConnectionInfo* info = ShardedConnectionInfo::get( true );
 
+            // mongos only targets multi-writes at shards which honor Reserved_StaleConfigError
+            result.appendBool( "rejectsStaleWrites" , true );
+
             // make sure we have the mongos id for writebacks
             if ( ! checkMongosID( info , cmdObj["serverID"] , errmsg ) ) 
                 return false;
@@ -818,7 +932,7 @@ namespace mongo {
 
         // TODO : all collections at some point, be sharded or not, will have a version
         //  (and a ShardChunkManager)
-        received = info->getVersion( ns );
+        received = info->hasRequestVersion( ns ) ? info->getRequestVersion() : info->getVersion( ns );
         wanted = shardingState.getVersion( ns );
 
         if( received.isWriteCompatibleWith( wanted ) ) return true;
@@ -49,4 +49,14 @@ namespace mongo {
         return false;
     }
 
+    BSONObj VersionManager::requestShardVersionCB( ShardConnection* conn_in, const Shard& shard ) {
+        return BSONObj();
+    }
+
+    BSONObj VersionManager::attachShardVersion( const BSONObj& query,
+                                                const BSONObj& versionMetadata,
+                                                bool isCommand ) {
+        return query;
+    }
+
 }  // namespace mongo
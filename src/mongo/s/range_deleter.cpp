@@ -61,7 +61,8 @@ namespace mongo {
     struct RangeDeleter::RangeDeleteEntry {
         RangeDeleteEntry():
                 secondaryThrottle(true),
-                notifyDone(NULL) {
+                notifyDone(NULL),
+                queueTimeMillis(0) {
         }
 
         std::string ns;
@@ -87,6 +88,9 @@ namespace mongo {
         // Important invariant: Can only be set and used by one thread.
         Notification* notifyDone;
 
+        // When the delete was queued, used to compute how long it waited.
+        long long queueTimeMillis;
+
         // For debugging only
         BSONObj toBSON() const {
             return BSON("ns" << ns
@@ -127,6 +131,7 @@ namespace mongo {
 
     RangeDeleter::RangeDeleter(RangeDeleterEnv* env):
         _env(env), // ownership xfer
+        _workersStarted(false),
         _stopMutex("stopRangeDeleter"),
         _stopRequested(false),
         _queueMutex("RangeDeleter"),
@@ -159,9 +164,14 @@ namespace mongo {
         }
     }
 
-    void RangeDeleter::startWorkers() {
-        if (!_worker) {
-            _worker.reset(new boost::thread(boost::bind(&RangeDeleter::doWork, this)));
+    void RangeDeleter::startWorkers(size_t numWorkers) {
+        if (_workersStarted) {
+            return;
+        }
+
+        _workersStarted = true;
+        for (size_t i = 0; i < std::max(numWorkers, static_cast<size_t>(1)); i++) {
+            _workers.create_thread(boost::bind(&RangeDeleter::doWork, this));
         }
     }
 
@@ -171,9 +181,7 @@ namespace mongo {
             _stopRequested = true;
         }
 
-        if (_worker) {
-            _worker->join();
-        }
+        _workers.join_all();
 
         scoped_lock sl(_queueMutex);
         while (_stats->hasInProgress_inlock()) {
@@ -198,6 +206,7 @@ namespace mongo {
         toDelete->shardKeyPattern = shardKeyPattern.getOwned();
         toDelete->secondaryThrottle = secondaryThrottle;
         toDelete->notifyDone = notifyDone;
+        toDelete->queueTimeMillis = curTimeMillis64();
 
         {
             scoped_lock sl(_queueMutex);
@@ -222,7 +231,7 @@ namespace mongo {
 
             if (toDelete->cursorsToWait.empty()) {
                 _taskQueue.push_back(toDelete.release());
-                _taskQueueNotEmptyCV.notify_one();
+                _taskQueueNotEmptyCV.notify_all();
             }
             else {
                 _notReadyQueue.push_back(toDelete.release());
@@ -246,6 +255,8 @@ namespace mongo {
         string dummy;
         if (errMsg == NULL) errMsg = &dummy;
 
+        const long long startMillis = curTimeMillis64();
+
         NSMinMax deleteRange(ns, min, max);
         {
             scoped_lock sl(_queueMutex);
@@ -303,13 +314,18 @@ namespace mongo {
             sleepmillis(checkIntervalMillis);
         }
 
+        const long long deleteStartMillis = curTimeMillis64();
         bool result = _env->deleteRange(ns, min, max, shardKeyPattern,
                                         secondaryThrottle, errMsg);
+        const long long deleteEndMillis = curTimeMillis64();
 
         {
             scoped_lock sl(_queueMutex);
             _deleteSet.erase(&deleteRange);
 
+            _stats->recordCompletedDelete_inlock(deleteStartMillis - startMillis,
+                                                 deleteEndMillis - deleteStartMillis);
+
             _stats->decInProgressDeletes_inlock();
             _stats->decTotalDeletes_inlock();
 
@@ -389,10 +405,12 @@ namespace mongo {
             string errMsg;
 
             RangeDeleteEntry* nextTask = NULL;
+            long long queueWaitMillis = 0;
 
             {
                 scoped_lock sl(_queueMutex);
-                while (_taskQueue.empty()) {
+                TaskList::iterator taskIter;
+                while ((taskIter = nextReadyTask_inlock()) == _taskQueue.end()) {
                     _taskQueueNotEmptyCV.timed_wait(
                         sl.boost(), duration::milliseconds(NotEmptyTimeoutMillis));
 
@@ -401,36 +419,10 @@ namespace mongo {
                         return;
                     }
 
-                    if (_taskQueue.empty()) {
+                    if (nextReadyTask_inlock() == _taskQueue.end()) {
                         // Try to check if some deletes are ready and move them to the
                         // ready queue.
-
-                        TaskList::iterator iter = _notReadyQueue.begin();
-                        while (iter != _notReadyQueue.end()) {
-                            RangeDeleteEntry* entry = *iter;
-
-                            set<CursorId> cursorsNow;
-                            _env->getCursorIds(entry->ns, &cursorsNow);
-
-                            set<CursorId> cursorsLeft;
-                            std::set_intersection(entry->cursorsToWait.begin(),
-                                                  entry->cursorsToWait.end(),
-                                                  cursorsNow.begin(),
-                                                  cursorsNow.end(),
-                                                  std::inserter(cursorsLeft,
-                                                                cursorsLeft.end()));
-
-                            entry->cursorsToWait.swap(cursorsLeft);
-
-                            if (entry->cursorsToWait.empty()) {
-                                _taskQueue.push_back(*iter);
-                                _taskQueueNotEmptyCV.notify_one();
-                                iter = _notReadyQueue.erase(iter);
-                            }
-                            else {
-                                ++iter;
-                            }
-                        }
+                        promoteReadyTasks_inlock();
                     }
                 }
 
@@ -439,13 +431,16 @@ namespace mongo {
                     return;
                 }
 
-                nextTask = _taskQueue.front();
-                _taskQueue.pop_front();
+                nextTask = *taskIter;
+                _taskQueue.erase(taskIter);
+                _nsInProgress.insert(nextTask->ns);
+                queueWaitMillis = curTimeMillis64() - nextTask->queueTimeMillis;
 
                 _stats->decPendingDeletes_inlock();
                 _stats->incInProgressDeletes_inlock();
             }
 
+            const long long deleteStartMillis = curTimeMillis64();
             if (!_env->deleteRange(nextTask->ns,
                                    nextTask->min,
                                    nextTask->max,
@@ -455,14 +450,17 @@ namespace mongo {
                 warning() << "Error encountered while trying to delete range: "
                           << errMsg << endl;
             }
+            const long long deleteMillis = curTimeMillis64() - deleteStartMillis;
 
             {
                 scoped_lock sl(_queueMutex);
 
                 NSMinMax setEntry(nextTask->ns, nextTask->min, nextTask->max);
                 deletePtrElement(&_deleteSet, &setEntry);
+                _nsInProgress.erase(nextTask->ns);
                 _stats->decInProgressDeletes_inlock();
                 _stats->decTotalDeletes_inlock();
+                _stats->recordCompletedDelete_inlock(queueWaitMillis, deleteMillis);
 
                 if (nextTask->notifyDone) {
                     nextTask->notifyDone->notifyOne();
@@ -470,6 +468,50 @@ namespace mongo {
 
                 delete nextTask;
                 nextTask = NULL;
+
+                // Deletes for this namespace may have been held back while it was busy.
+                if (!_taskQueue.empty()) {
+                    _taskQueueNotEmptyCV.notify_all();
+                }
+            }
+        }
+    }
+
+    RangeDeleter::TaskList::iterator RangeDeleter::nextReadyTask_inlock() {
+        for (TaskList::iterator iter = _taskQueue.begin(); iter != _taskQueue.end(); ++iter) {
+            if (_nsInProgress.count((*iter)->ns) == 0) {
+                return iter;
+            }
+        }
+
+        return _taskQueue.end();
+    }
+
+    void RangeDeleter::promoteReadyTasks_inlock() {
+        TaskList::iterator iter = _notReadyQueue.begin();
+        while (iter != _notReadyQueue.end()) {
+            RangeDeleteEntry* entry = *iter;
+
+            set<CursorId> cursorsNow;
+            _env->getCursorIds(entry->ns, &cursorsNow);
+
+            set<CursorId> cursorsLeft;
+            std::set_intersection(entry->cursorsToWait.begin(),
+                                  entry->cursorsToWait.end(),
+                                  cursorsNow.begin(),
+                                  cursorsNow.end(),
+                                  std::inserter(cursorsLeft,
+                                                cursorsLeft.end()));
+
+            entry->cursorsToWait.swap(cursorsLeft);
+
+            if (entry->cursorsToWait.empty()) {
+                _taskQueue.push_back(*iter);
+                _taskQueueNotEmptyCV.notify_all();
+                iter = _notReadyQueue.erase(iter);
+            }
+            else {
+                ++iter;
             }
         }
     }
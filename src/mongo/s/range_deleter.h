@@ -41,9 +41,11 @@ namespace mongo {
      *
      * Threading assumptions:
      *
-     *   This class has (currently) one worker thread attacking the queue, one
-     *   job at a time. If we want an immediate deletion, that job is going to
-     *   be performed on the thread that is requesting it.
+     *   This class has a configurable number of worker threads attacking the queue,
+     *   each one job at a time. Workers never delete from the same namespace
+     *   concurrently, so multiple workers only help when deletes for several
+     *   collections are queued. If we want an immediate deletion, that job is going
+     *   to be performed on the thread that is requesting it.
      *
      *   All calls regarding deletion are synchronized.
      *
@@ -77,15 +79,15 @@ namespace mongo {
         //
 
         /**
-         * Starts the background thread to work on this queue. Does nothing if the worker
-         * thread is already active.
+         * Starts numWorkers background threads to work on this queue. Does nothing if the
+         * workers are already active.
          *
          * This call is _not_ thread safe and must be issued before any other call.
          */
-        void startWorkers();
+        void startWorkers(size_t numWorkers = 1);
 
         /**
-         * Stops the background thread working on this queue. This will block if there are
+         * Stops the background threads working on this queue. This will block if there are
          * tasks that are being deleted, but will leave the pending tasks in the queue.
          *
          * Steps:
@@ -188,9 +190,21 @@ namespace mongo {
 
         typedef std::set<NSMinMax*, NSMinMaxCmp> NSMinMaxSet; // owned here
 
-        /** Body of the worker thread */
+        /** Body of the worker threads */
         void doWork();
 
+        /**
+         * Returns the first task in _taskQueue whose namespace no other worker is deleting
+         * from, or _taskQueue.end() if there is none. Assumes _queueMutex is held.
+         */
+        TaskList::iterator nextReadyTask_inlock();
+
+        /**
+         * Moves the deletes that no longer have open cursors to wait for from _notReadyQueue
+         * to _taskQueue. Assumes _queueMutex is held.
+         */
+        void promoteReadyTasks_inlock();
+
         /** Returns true if range is blacklisted. Assumes _queueMutex is held */
         bool isBlacklisted_inlock(const StringData& ns,
                                   const BSONObj& min,
@@ -209,7 +223,8 @@ namespace mongo {
         scoped_ptr<RangeDeleterEnv> _env;
 
         // Initially not active. Must be started explicitly.
-        scoped_ptr<boost::thread> _worker;
+        boost::thread_group _workers;
+        bool _workersStarted;
 
         // Protects _stopRequested.
         mutable mutex _stopMutex;
@@ -238,6 +253,10 @@ namespace mongo {
         // Note: pointer life cycle is not handled here.
         TaskList _taskQueue;
 
+        // Namespaces a worker is currently deleting from. A namespace in here is skipped by
+        // the other workers so deletes on the same collection never compete for its lock.
+        std::set<std::string> _nsInProgress;
+
         // Set of all deletes - deletes waiting for cursors, waiting to be acted upon
         // and in progress. Includes both queued and immediate deletes.
         //
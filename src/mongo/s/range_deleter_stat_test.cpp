@@ -186,6 +186,21 @@ namespace {
                                          &inProgressCount, NULL /* don't care errMsg */));
         ASSERT_EQUALS(0, inProgressCount);
 
+        long long completedCount = 0;
+        ASSERT_TRUE(FieldParser::extract(stats, RangeDeleterStats::CompletedDeletesField,
+                                         &completedCount, NULL /* don't care errMsg */));
+        ASSERT_EQUALS(1, completedCount);
+
+        long long queueWaitMillis = -1;
+        ASSERT_TRUE(FieldParser::extract(stats, RangeDeleterStats::QueueWaitMillisField,
+                                         &queueWaitMillis, NULL /* don't care errMsg */));
+        ASSERT_GREATER_THAN_OR_EQUALS(queueWaitMillis, 0);
+
+        long long maxQueueWaitMillis = -1;
+        ASSERT_TRUE(FieldParser::extract(stats, RangeDeleterStats::MaxQueueWaitMillisField,
+                                         &maxQueueWaitMillis, NULL /* don't care errMsg */));
+        ASSERT_EQUALS(queueWaitMillis, maxQueueWaitMillis);
+
         deleter.stopWorkers();
     }
 
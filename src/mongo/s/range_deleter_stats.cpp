@@ -20,6 +20,10 @@ namespace mongo {
     const BSONField<int> RangeDeleterStats::TotalDeletesField("totalDeletes");
     const BSONField<int> RangeDeleterStats::PendingDeletesField("pendingDeletes");
     const BSONField<int> RangeDeleterStats::InProgressDeletesField("inProgressDeletes");
+    const BSONField<long long> RangeDeleterStats::CompletedDeletesField("completedDeletes");
+    const BSONField<long long> RangeDeleterStats::DeleteMillisField("deleteMillis");
+    const BSONField<long long> RangeDeleterStats::QueueWaitMillisField("queueWaitMillis");
+    const BSONField<long long> RangeDeleterStats::MaxQueueWaitMillisField("maxQueueWaitMillis");
 
     BSONObj RangeDeleterStats::toBSON() const {
         scoped_lock sl(*_lockPtr);
@@ -28,6 +32,10 @@ namespace mongo {
         builder << TotalDeletesField(_totalDeletes);
         builder << PendingDeletesField(_pendingDeletes);
         builder << InProgressDeletesField(_inProgressDeletes);
+        builder << CompletedDeletesField(_completedDeletes);
+        builder << DeleteMillisField(_deleteMillis);
+        builder << QueueWaitMillisField(_queueWaitMillis);
+        builder << MaxQueueWaitMillisField(_maxQueueWaitMillis);
 
         return builder.obj();
     }
@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include <algorithm>
+
 #include "mongo/bson/bson_field.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/platform/cstdint.h"
@@ -40,6 +42,17 @@ namespace mongo {
         // Total number of deletes that are currently in progress.
         static const BSONField<int> InProgressDeletesField;
 
+        // Number of deletes that have finished, successfully or not.
+        static const BSONField<long long> CompletedDeletesField;
+
+        // Total time spent by the finished deletes actually deleting documents.
+        static const BSONField<long long> DeleteMillisField;
+
+        // Total and maximum time the finished deletes waited between being requested and
+        // being worked on, including the time spent waiting for open cursors.
+        static const BSONField<long long> QueueWaitMillisField;
+        static const BSONField<long long> MaxQueueWaitMillisField;
+
         /**
          * Creates a stat object given the mutex from the RangeDeleter object
          * that this instance is keeping track of.
@@ -48,7 +61,11 @@ namespace mongo {
             _lockPtr(lockPtr),
             _totalDeletes(0),
             _pendingDeletes(0),
-            _inProgressDeletes(0) {
+            _inProgressDeletes(0),
+            _completedDeletes(0),
+            _deleteMillis(0),
+            _queueWaitMillis(0),
+            _maxQueueWaitMillis(0) {
         }
 
         /**
@@ -89,6 +106,17 @@ namespace mongo {
             return _inProgressDeletes > 0;
         }
 
+        /**
+         * Records a finished delete that waited queueWaitMillis before being worked on and
+         * took deleteMillis to perform.
+         */
+        void recordCompletedDelete_inlock(long long queueWaitMillis, long long deleteMillis) {
+            _completedDeletes++;
+            _deleteMillis += deleteMillis;
+            _queueWaitMillis += queueWaitMillis;
+            _maxQueueWaitMillis = std::max(_maxQueueWaitMillis, queueWaitMillis);
+        }
+
     private:
         // Protects all data structures below this. Not owned here.
         mutable mutex* _lockPtr;
@@ -96,5 +124,10 @@ namespace mongo {
         int _totalDeletes;
         int _pendingDeletes;
         int _inProgressDeletes;
+
+        long long _completedDeletes;
+        long long _deleteMillis;
+        long long _queueWaitMillis;
+        long long _maxQueueWaitMillis;
     };
 }
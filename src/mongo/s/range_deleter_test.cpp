@@ -23,6 +23,7 @@
 #include "mongo/s/range_deleter.h"
 #include "mongo/s/range_deleter_stats.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/time_support.h"
 
 namespace {
 
@@ -41,6 +42,21 @@ namespace {
     // Capped sleep interval is 640 mSec, Nyquist frequency is 1280 mSec => round up to 2 sec.
     const int MAX_IMMEDIATE_DELETE_WAIT_SECS = 2;
 
+    // Blocks until the deleter has finished at least the given number of deletes.
+    void waitForCompletedDeletes(const RangeDeleter& deleter, long long numDeletes) {
+        while (true) {
+            const BSONObj stats(deleter.getStats()->toBSON());
+            long long completedCount = 0;
+            ASSERT_TRUE(FieldParser::extract(stats, RangeDeleterStats::CompletedDeletesField,
+                                             &completedCount, NULL /* don't care errMsg */));
+            if (completedCount >= numDeletes) {
+                return;
+            }
+
+            mongo::sleepmillis(1);
+        }
+    }
+
     // Should not be able to queue deletes if deleter workers were not started.
     TEST(QueueDelete, CantAfterStop) {
         RangeDeleterMockEnv* env = new RangeDeleterMockEnv();
@@ -327,6 +343,75 @@ namespace {
         deleter.stopWorkers();
     }
 
+    // Multiple workers should delete from different namespaces at the same time, but never
+    // work on two ranges of the same namespace concurrently.
+    TEST(MixedDeletes, MultipleWorkers) {
+        const string ns1("test.user");
+        const string ns2("test.order");
+
+        RangeDeleterMockEnv* env = new RangeDeleterMockEnv();
+        RangeDeleter deleter(env);
+        deleter.startWorkers(3);
+
+        env->pauseDeletes();
+
+        Notification notifyDone1;
+        ASSERT_TRUE(deleter.queueDelete(ns1,
+                                        BSON("x" << 10),
+                                        BSON("x" << 20),
+                                        BSON("x" << 1),
+                                        true,
+                                        &notifyDone1,
+                                        NULL /* don't care errMsg */));
+
+        Notification notifyDone2;
+        ASSERT_TRUE(deleter.queueDelete(ns1,
+                                        BSON("x" << 20),
+                                        BSON("x" << 30),
+                                        BSON("x" << 1),
+                                        true,
+                                        &notifyDone2,
+                                        NULL /* don't care errMsg */));
+
+        Notification notifyDone3;
+        ASSERT_TRUE(deleter.queueDelete(ns2,
+                                        BSON("x" << 10),
+                                        BSON("x" << 20),
+                                        BSON("x" << 1),
+                                        true,
+                                        &notifyDone3,
+                                        NULL /* don't care errMsg */));
+
+        // One delete from each namespace should be in progress.
+        env->waitForNthPausedDelete(2u);
+
+        const BSONObj stats(deleter.getStats()->toBSON());
+        int inProgressCount = 0;
+        ASSERT_TRUE(FieldParser::extract(stats, RangeDeleterStats::InProgressDeletesField,
+                                         &inProgressCount, NULL /* don't care errMsg */));
+        ASSERT_EQUALS(2, inProgressCount);
+
+        int pendingCount = 0;
+        ASSERT_TRUE(FieldParser::extract(stats, RangeDeleterStats::PendingDeletesField,
+                                         &pendingCount, NULL /* don't care errMsg */));
+        ASSERT_EQUALS(1, pendingCount);
+
+        // Resume the deletes one at a time, the second range of ns1 can only start once the
+        // first one is done.
+        env->resumeOneDelete();
+        waitForCompletedDeletes(deleter, 1);
+        env->resumeOneDelete();
+        waitForCompletedDeletes(deleter, 2);
+        env->waitForNthPausedDelete(3u);
+        env->resumeOneDelete();
+
+        notifyDone1.waitToBeNotified();
+        notifyDone2.waitToBeNotified();
+        notifyDone3.waitToBeNotified();
+
+        deleter.stopWorkers();
+    }
+
     // Should not be able to delete ranges that overlaps with a black listed range.
     TEST(BlackList, CantDeleteBlackListed) {
         RangeDeleterMockEnv* env = new RangeDeleterMockEnv();
@@ -25,10 +25,12 @@
 #include "mongo/db/dbwebserver.h"
 #include "mongo/db/initialize_server_global_state.h"
 #include "mongo/db/lasterror.h"
+#include "mongo/s/auto_splitter.h"
 #include "mongo/s/balance.h"
 #include "mongo/s/chunk.h"
 #include "mongo/s/client_info.h"
 #include "mongo/s/config.h"
+#include "mongo/s/config_change_listener.h"
 #include "mongo/s/config_upgrade.h"
 #include "mongo/s/cursors.h"
 #include "mongo/s/grid.h"
@@ -226,6 +228,8 @@ namespace mongo {
 
     void start( const MessageServer::Options& opts ) {
         balancer.go();
+        autoSplitter.go();
+        configChangeListener.go();
         cursorCache.startTimeoutThread();
         PeriodicTask::theRunner->go();
 
@@ -292,6 +292,16 @@ namespace mongo {
 
         static bool releaseConnectionsAfterResponse;
 
+        // Send unversioned commands for a shard over a connection shared with other threads,
+        // see SharedConnectionPool, rather than over this thread's own connection.  While all
+        // sharedConnectionsPerHost of them are in use, commands wait for one to be released,
+        // for up to sharedConnectionWaitMillis before using this thread's own connection.
+        static bool shareConnectionsForUnversionedCommands;
+
+        // Send the shard version of versioned queries and commands with each request rather
+        // than setting it on the connection first, see VersionManager::requestShardVersionCB().
+        static bool shardVersionAsRequestMetadata;
+
         /** checks all of my thread local connections for the version of this ns */
         static void checkMyConnectionVersions( const string & ns );
 
@@ -26,6 +26,7 @@
 #include "mongo/s/config.h"
 #include "mongo/s/request.h"
 #include "mongo/s/shard.h"
+#include "mongo/s/shared_connection_pool.h"
 #include "mongo/s/stale_exception.h"
 #include "mongo/s/version_manager.h"
 #include "mongo/server.h"
@@ -94,6 +95,10 @@ namespace mongo {
             shardConnectionPool.appendInfo( result );
             // Thread connection info
             activeClientConnections.appendInfo( result );
+            // Connections shared by all threads
+            BSONObjBuilder sharedBuilder( result.subobjStart( "shared" ) );
+            sharedConnectionPool.appendInfo( &sharedBuilder );
+            sharedBuilder.done();
             return true;
         }
 
@@ -479,6 +484,45 @@ namespace mongo {
         true
     );
 
+    // Off by default: a command sent over a shared connection is not ordered after
+    // unacknowledged writes this thread sent over its own connection to the same shard.
+    bool ShardConnection::shareConnectionsForUnversionedCommands( false );
+
+    ExportedServerParameter<bool> ShareConnectionsForUnversionedCommands(
+        ServerParameterSet::getGlobal(),
+        "shareConnectionsForUnversionedCommands",
+        &ShardConnection::shareConnectionsForUnversionedCommands,
+        true,
+        true
+    );
+
+    // Off by default: shards older than this mongos ignore a version sent with the request.
+    bool ShardConnection::shardVersionAsRequestMetadata( false );
+
+    ExportedServerParameter<bool> ShardVersionAsRequestMetadata(
+        ServerParameterSet::getGlobal(),
+        "shardVersionAsRequestMetadata",
+        &ShardConnection::shardVersionAsRequestMetadata,
+        true,
+        true
+    );
+
+    ExportedServerParameter<int> SharedConnectionsPerHost(
+        ServerParameterSet::getGlobal(),
+        "sharedConnectionsPerHost",
+        &SharedConnectionPool::connectionsPerHost,
+        true,
+        true
+    );
+
+    ExportedServerParameter<int> SharedConnectionWaitMillis(
+        ServerParameterSet::getGlobal(),
+        "sharedConnectionWaitMillis",
+        &SharedConnectionPool::waitMillis,
+        true,
+        true
+    );
+
     void ShardConnection::releaseMyConnections() {
         ClientConnections::threadInstance()->releaseAll();
     }
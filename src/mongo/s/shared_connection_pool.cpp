@@ -0,0 +1,182 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "mongo/pch.h"
+
+#include "mongo/s/shared_connection_pool.h"
+
+#include <boost/thread/thread_time.hpp>
+
+#include "mongo/client/connpool.h"
+#include "mongo/client/dbclient_rs.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+    SharedConnectionPool sharedConnectionPool;
+
+    int SharedConnectionPool::connectionsPerHost( 4 );
+
+    int SharedConnectionPool::waitMillis( 1000 );
+
+    SharedConnectionPool::SharedConnectionPool() :
+        _mutex( "SharedConnectionPool" ) {
+    }
+
+    bool SharedConnectionPool::tryRunCommand( const string& host,
+                                              const string& db,
+                                              const BSONObj& cmd,
+                                              BSONObj& res,
+                                              bool& ok,
+                                              int options ) {
+        string server = host;
+
+        string errmsg;
+        ConnectionString cs = ConnectionString::parse( host, errmsg );
+        uassert( 16818, str::stream() << "invalid host " << host << causedBy( errmsg ),
+                 cs.isValid() );
+
+        if ( cs.type() == ConnectionString::SET ) {
+            ReplicaSetMonitorPtr monitor = ReplicaSetMonitor::get( cs.getSetName(), true );
+            uassert( 16819, str::stream() << "no replica set monitor for " << host, monitor );
+            server = monitor->getMaster().toString();
+        }
+
+        DBClientBase* conn = _get( server );
+        if ( ! conn )
+            return false;
+
+        try {
+            ok = conn->runCommand( db, cmd, res, options );
+        }
+        catch ( ... ) {
+            _release( server, conn, true );
+            throw;
+        }
+
+        _release( server, conn, conn->isFailed() );
+        return true;
+    }
+
+    DBClientBase* SharedConnectionPool::_get( const string& server ) {
+        {
+            scoped_lock lk( _mutex );
+            HostConnections& host = _hosts[ server ];
+            host.requests++;
+
+            bool waited = false;
+            boost::system_time deadline;
+            while ( host.idle.empty() && host.open >= connectionsPerHost ) {
+                if ( ! waited ) {
+                    waited = true;
+                    host.waits++;
+                    deadline = boost::get_system_time() +
+                               boost::posix_time::milliseconds( waitMillis );
+                }
+
+                host.waiting++;
+                host.maxWaiting = std::max( host.maxWaiting, host.waiting );
+                bool signaled = _connectionReleased.timed_wait( lk.boost(), deadline );
+                host.waiting--;
+
+                if ( ! signaled && host.idle.empty() && host.open >= connectionsPerHost ) {
+                    host.timeouts++;
+                    return NULL;
+                }
+            }
+
+            if ( ! host.idle.empty() ) {
+                DBClientBase* conn = host.idle.back();
+                host.idle.pop_back();
+                return conn;
+            }
+
+            // counted before connecting, so no other caller opens one beyond the limit
+            host.open++;
+        }
+
+        // Connect without holding the mutex, the server might not be answering. The pool's
+        // hooks authenticate the new connection.
+        DBClientBase* conn = NULL;
+        try {
+            conn = pool.get( server );
+        }
+        catch ( ... ) {
+            scoped_lock lk( _mutex );
+            _hosts[ server ].open--;
+            _connectionReleased.notify_one();
+            throw;
+        }
+
+        LOG(1) << "opened shared connection to " << server << endl;
+        return conn;
+    }
+
+    void SharedConnectionPool::_release( const string& server, DBClientBase* conn, bool failed ) {
+        if ( failed ) {
+            warning() << "closing failed shared connection to " << server << endl;
+            delete conn;
+        }
+
+        scoped_lock lk( _mutex );
+        HostConnections& host = _hosts[ server ];
+        if ( failed )
+            host.open--;
+        else
+            host.idle.push_back( conn );
+
+        // several hosts share the condition, so wake every waiter to check its own
+        _connectionReleased.notify_all();
+    }
+
+    void SharedConnectionPool::appendInfo( BSONObjBuilder* builder ) const {
+        int totalOpen = 0;
+        int totalInUse = 0;
+        long long totalWaits = 0;
+        long long totalTimeouts = 0;
+
+        BSONObjBuilder hostsBuilder( builder->subobjStart( "hosts" ) );
+        {
+            scoped_lock lk( _mutex );
+            for ( HostMap::const_iterator it = _hosts.begin(); it != _hosts.end(); ++it ) {
+                const HostConnections& host = it->second;
+                const int inUse = host.open - static_cast<int>( host.idle.size() );
+
+                BSONObjBuilder hostBuilder( hostsBuilder.subobjStart( it->first ) );
+                hostBuilder.append( "open", host.open );
+                hostBuilder.append( "inUse", inUse );
+                hostBuilder.appendNumber( "requests", host.requests );
+                hostBuilder.appendNumber( "waits", host.waits );
+                hostBuilder.appendNumber( "timeouts", host.timeouts );
+                hostBuilder.append( "maxWaiting", host.maxWaiting );
+                hostBuilder.done();
+
+                totalOpen += host.open;
+                totalInUse += inUse;
+                totalWaits += host.waits;
+                totalTimeouts += host.timeouts;
+            }
+        }
+        hostsBuilder.done();
+
+        builder->append( "totalOpen", totalOpen );
+        builder->append( "totalInUse", totalInUse );
+        builder->appendNumber( "totalWaits", totalWaits );
+        builder->appendNumber( "totalTimeouts", totalTimeouts );
+    }
+
+} // namespace mongo
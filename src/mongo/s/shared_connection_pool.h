@@ -0,0 +1,125 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <boost/thread/condition.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/concurrency/mutex.h"
+
+namespace mongo {
+
+    class DBClientBase;
+
+    /**
+     * A bounded pool of connections to each server, shared by all threads, each of which
+     * carries one command at a time. At most connectionsPerHost connections are opened to a
+     * server; while all of them are in use, callers wait up to waitMillis for one to be
+     * released rather than opening another, so the connections to a shard don't grow with the
+     * client threads. A caller which waited longer sends its command over its own connection,
+     * so a few slow commands don't hold up every other one to the same server.
+     *
+     * Requests are not pipelined over a connection: mongod serves a connection's requests one
+     * after the other on a single thread, so a command queued behind another one would only
+     * start once that one finished on the server.
+     *
+     * Only requests which don't depend on state the server keeps per connection (shard
+     * versions, getLastError, authentication other than the internal user) may be sent this
+     * way.
+     */
+    class SharedConnectionPool {
+        MONGO_DISALLOW_COPYING(SharedConnectionPool);
+    public:
+        SharedConnectionPool();
+
+        /**
+         * Runs a command on host over a shared connection, waiting up to waitMillis for one to
+         * be free if needed. host is a server address or a replica set connection string, in
+         * which case the command goes to the primary.
+         *
+         * Returns false, sending nothing, if no connection was free in time. Otherwise sets ok
+         * to whether the command succeeded, res holding the reply, and returns true. Throws if
+         * the command could not be sent or no reply was received.
+         */
+        bool tryRunCommand(const std::string& host,
+                           const std::string& db,
+                           const BSONObj& cmd,
+                           BSONObj& res,
+                           bool& ok,
+                           int options = 0);
+
+        /**
+         * Appends the connections to each server, the commands in flight over them, and how
+         * often callers waited for one or gave up waiting.
+         */
+        void appendInfo(BSONObjBuilder* builder) const;
+
+        // Upper bound on the connections kept to a single server.
+        static int connectionsPerHost;
+
+        // How long a caller waits for a connection before using its own.
+        static int waitMillis;
+
+    private:
+        struct HostConnections {
+            HostConnections() : open(0), requests(0), waits(0), timeouts(0), maxWaiting(0),
+                                waiting(0) {}
+
+            // Connections not carrying a command.
+            std::vector<DBClientBase*> idle;
+
+            // Connections to the server, in use or idle, and ones being opened.
+            int open;
+
+            long long requests;
+
+            // Requests that had to wait for a connection, those that gave up waiting, and
+            // most of them waiting at once.
+            long long waits;
+            long long timeouts;
+            int maxWaiting;
+            int waiting;
+        };
+
+        typedef std::map<std::string, HostConnections> HostMap;
+
+        /**
+         * Returns a connection to server for the caller's exclusive use, waiting up to
+         * waitMillis if needed, or NULL if none was free in time.
+         */
+        DBClientBase* _get(const std::string& server);
+
+        /** Gives conn back to the pool, or closes it if it failed. */
+        void _release(const std::string& server, DBClientBase* conn, bool failed);
+
+        // Protects _hosts.
+        mutable mongo::mutex _mutex;
+
+        // Signaled when a connection was released or closed.
+        boost::condition _connectionReleased;
+
+        HostMap _hosts;
+    };
+
+    extern SharedConnectionPool sharedConnectionPool;
+
+} // namespace mongo
@@ -18,6 +18,8 @@
 
 #include "pch.h"
 
+#include "mongo/base/counter.h"
+#include "mongo/base/owned_pointer_vector.h"
 #include "mongo/base/status.h"
 #include "mongo/bson/util/builder.h"
 #include "mongo/client/connpool.h"
@@ -25,8 +27,10 @@
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/index.h"
 #include "mongo/db/namespacestring.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/s/client_info.h"
 #include "mongo/s/chunk.h"
@@ -41,6 +45,25 @@
 
 namespace mongo {
 
+    // Off by default: every write then waits for the shard's getLastError, so that a shard at a
+    // newer version rejects the write and mongos refreshes and resends it itself, rather than
+    // the shard queuing it for this mongos's writeback listener.  Multi-updates and
+    // multi-removes are then also sent only to the shards owning the queried range, see
+    // _targetedWrite(), rather than to every shard.
+    MONGO_EXPORT_SERVER_PARAMETER( staleWriteRetry, bool, false );
+
+    static Counter64 staleWritesRejected;
+    static ServerStatusMetricField<Counter64> displayStaleWritesRejected(
+            "sharding.staleWrites.rejected", &staleWritesRejected );
+
+    static Counter64 staleWritesRetried;
+    static ServerStatusMetricField<Counter64> displayStaleWritesRetried(
+            "sharding.staleWrites.retried", &staleWritesRetried );
+
+    static Counter64 staleWritesFailed;
+    static ServerStatusMetricField<Counter64> displayStaleWritesFailed(
+            "sharding.staleWrites.failed", &staleWritesFailed );
+
     class ShardStrategy : public Strategy {
 
         bool _isSystemIndexes( const char* ns ) {
@@ -281,15 +304,19 @@ namespace mongo {
                             const string& ns,
                             const BSONObj& query,
                             StaleConfigException& e,
-                            Request& r) // TODO: remove
+                            Request& r, // TODO: remove
+                            bool resetRequest = true)
         {
             static const int MAX_RETRIES = 5;
             if (retries >= MAX_RETRIES) {
+                staleWritesFailed.increment();
                 // If we rethrow b/c too many retries, make sure we add as much data as possible
                 e.addContext(query.toString());
                 throw e;
             }
 
+            staleWritesRetried.increment();
+
             //
             // On a stale config exception, we have to assume that the entire collection could have
             // become unsharded, or sharded with a different shard key - we need to re-run all the
@@ -305,7 +332,29 @@ namespace mongo {
                 versionManager.forceRemoteCheckShardVersionCB(ns);
             }
 
-            r.reset();
+            if (resetRequest) r.reset();
+        }
+
+        /**
+         * A write sent with WriteOption_StaleConfigError is not queued for writeback by a shard at
+         * a newer version, but reported as an error.  Waits for the last write on 'dbcon' and, if
+         * the shard rejected it, reloads the chunk manager for 'ns' and throws, so the caller can
+         * retry the write through _handleRetries().  Otherwise the client's getLastError later
+         * sees the same result.
+         */
+        void _checkStaleWrite(ShardConnection& dbcon, const string& ns) {
+            BSONObj gle;
+            dbcon->runCommand("admin", BSON( "getLastError" << 1 ), gle);
+
+            if (gle["code"].numberInt() != SendStaleConfigCode) return;
+
+            staleWritesRejected.increment();
+            grid.getDBConfig(ns)->getChunkManagerIfExists(ns, true);
+
+            throw SendStaleConfigException(ns, str::stream() << "write rejected by shard "
+                                                             << dbcon->getServerAddress()
+                                                             << causedBy(gle["err"].str()),
+                                           ChunkVersion(0, OID()), ChunkVersion(0, OID()));
         }
 
         struct InsertGroup {
@@ -501,8 +550,327 @@ namespace mongo {
             }
         }
 
+        /**
+         * The documents of a continue-on-error insert bound for a single shard, in their original
+         * relative order.
+         */
+        struct ShardInsertBatch {
+            ShardInsertBatch() : unchecked(0) {}
+
+            ShardPtr shard;
+            vector<BSONObj> inserts;
+            map<ChunkPtr, int> chunkData;
+
+            // Index of the first insert the shard may still reject as stale
+            size_t unchecked;
+        };
+
+        /**
+         * Sends 'inserts' over 'dbcon' without waiting for a response, in messages of at most
+         * 8MB so that the writeback listener can replay them.
+         *
+         * With WriteOption_StaleConfigError, every message but the last is checked before the
+         * next is sent, see _checkStaleWrite(), and 'unchecked' is left at the first insert of
+         * the message that was rejected or, if none was, of the last message.
+         */
+        void _sendInserts(ShardConnection& dbcon, const string& ns,
+                          const vector<BSONObj>& inserts, int flags, size_t* unchecked) {
+            *unchecked = 0;
+            vector<BSONObj> message;
+            int messageSize = 0;
+            for (vector<BSONObj>::const_iterator it = inserts.begin(); it != inserts.end(); ++it) {
+                int objSize = it->objsize();
+                if (!message.empty() && messageSize + objSize > BSONObjMaxUserSize / 2) {
+                    dbcon->insert(ns, message, flags);
+                    if (flags & WriteOption_StaleConfigError) _checkStaleWrite(dbcon, ns);
+                    *unchecked += message.size();
+                    message.clear();
+                    messageSize = 0;
+                }
+                message.push_back(*it);
+                messageSize += objSize;
+            }
+            if (!message.empty()) {
+                dbcon->insert(ns, message, flags);
+            }
+        }
+
+        /**
+         * Continue-on-error inserts do not depend on the order in which documents reach
+         * different shards, so rather than sending consecutive runs of documents for the same
+         * shard and waiting for each run before the next, the whole batch is bucketed by
+         * destination shard and every shard's documents are sent before waiting on any shard.
+         * The shards then apply their inserts concurrently.
+         *
+         * Shard-side errors are collected per shard by the client's getLastError ("errs").  An
+         * error detected by mongos while sending is reported after the other documents have been
+         * inserted, as with mongod.
+         *
+         * Returns false, without having sent anything, if a document has no valid shard key: which
+         * error is reported then depends on document order, so the caller must insert in order.
+         */
+        bool _insertBucketed(const string& ns, DbMessage& d, int flags, Request& r) {
+
+            vector<BSONObj> pending;
+            while (d.moreJSObjs()) {
+                pending.push_back(d.nextJsObj());
+            }
+
+            int retries = 0;
+            bool reloadedConfig = false;
+            bool sentAny = false;
+
+            // The last error detected by mongos, reported once all inserts were sent
+            int errCode = 0;
+            string errMsg;
+
+            while (!pending.empty()) {
+
+                uassert( 16814, str::stream() << "too many retries during insert", retries < 30 );
+
+                ChunkManagerPtr manager;
+                ShardPtr primary;
+                grid.getDBConfig(ns)->getChunkManagerOrPrimary(ns, manager, primary);
+
+                //
+                // BUCKET BY SHARD
+                //
+
+                map<string, ShardInsertBatch> batches;
+                bool reload = false;
+
+                for (vector<BSONObj>::iterator it = pending.begin(); it != pending.end(); ++it) {
+
+                    BSONObj o = *it;
+
+                    if (!manager) {
+                        ShardInsertBatch& batch = batches[primary->getName()];
+                        if (!batch.shard) batch.shard = primary;
+                        batch.inserts.push_back(o);
+                        continue;
+                    }
+
+                    if (!manager->hasShardKey(o)) {
+
+                        bool bad = true;
+
+                        // If _id is part of shard key pattern, but item doesn't already have one,
+                        // add autogenerated _id and see if we now have a shard key.
+                        if (manager->getShardKey().partOfShardKey("_id") && !o.hasField("_id")) {
+                            BSONObjBuilder b;
+                            b.appendOID("_id", 0, true);
+                            b.appendElements(o);
+                            o = b.obj();
+                            bad = !manager->hasShardKey(o);
+                        }
+
+                        if (bad && !reloadedConfig) {
+                            // We may be stale, see _getNextInsertGroup()
+                            warning() << "shard key mismatch for insert " << o
+                                      << ", expected values for " << manager->getShardKey()
+                                      << ", reloading config data to ensure not stale" << endl;
+                            reload = true;
+                            break;
+                        }
+
+                        if (bad && !sentAny) {
+                            return false;
+                        }
+
+                        if (bad) {
+                            // Sleep to avoid DOS'ing config server when we have invalid inserts
+                            _sleepForVerifiedLocalError();
+
+                            errCode = 8011;
+                            errMsg = str::stream()
+                                    << "tried to insert object with no valid shard key for "
+                                    << manager->getShardKey().toString() << " : " << o.toString();
+                            log() << errMsg << endl;
+                            continue;
+                        }
+                    }
+
+                    // Make sure our objSize is not greater than maximum, otherwise WBL won't work
+                    verify( o.objsize() <= BSONObjMaxUserSize );
+
+                    ChunkPtr chunk = manager->findChunkForDoc(o);
+                    ShardInsertBatch& batch = batches[chunk->getShard().getName()];
+                    if (!batch.shard) batch.shard.reset(new Shard(chunk->getShard()));
+
+                    // Many operations benefit from having the shard key early in the object
+                    o = manager->getShardKey().moveToFront(o);
+                    batch.inserts.push_back(o);
+                    batch.chunkData[chunk] += o.objsize();
+                }
+
+                if (reload) {
+                    grid.getDBConfig(ns)->getChunkManagerIfExists(ns, true);
+                    reloadedConfig = true;
+                    continue;
+                }
+
+                //
+                // SEND TO EVERY SHARD BEFORE WAITING ON ANY
+                //
+
+                vector<BSONObj> unsent;
+                scoped_ptr<StaleConfigException> stale;
+
+                for (map<string, ShardInsertBatch>::iterator it = batches.begin();
+                        it != batches.end(); ++it) {
+
+                    ShardInsertBatch& batch = it->second;
+
+                    if (stale) {
+                        unsent.insert(unsent.end(), batch.inserts.begin(), batch.inserts.end());
+                        batch.unchecked = batch.inserts.size();
+                        continue;
+                    }
+
+                    ShardConnection dbcon(*batch.shard, ns, manager);
+
+                    LOG(5) << "inserting " << batch.inserts.size() << " documents to shard "
+                           << batch.shard << " at version "
+                           << (manager.get() ? manager->getVersion().toString() :
+                                               ChunkVersion(0, OID()).toString())
+                           << endl;
+
+                    try {
+                        // Will throw SCE if we need to reset our version before sending.
+                        dbcon.setVersion();
+                    }
+                    catch (StaleConfigException& e) {
+                        dbcon.done();
+                        stale.reset(new StaleConfigException(e));
+                        unsent.insert(unsent.end(), batch.inserts.begin(), batch.inserts.end());
+                        batch.unchecked = batch.inserts.size();
+                        continue;
+                    }
+
+                    sentAny = true;
+
+                    try {
+                        _sendInserts(dbcon, ns, batch.inserts, flags, &batch.unchecked);
+
+                        //
+                        // WARNING: We *have* to return the connection here, otherwise the
+                        // error gets checked on a different connection!
+                        //
+                        dbcon.done();
+
+                        globalOpCounters.incInsertInWriteLock(batch.inserts.size());
+                    }
+                    catch (StaleConfigException& e) {
+                        // The shard rejected one of the batch's messages, see _sendInserts()
+                        dbcon.done();
+                        stale.reset(new StaleConfigException(e));
+                        unsent.insert(unsent.end(),
+                                      batch.inserts.begin() + batch.unchecked,
+                                      batch.inserts.end());
+                        batch.unchecked = batch.inserts.size();
+                        continue;
+                    }
+                    catch (DBException& e) {
+                        dbcon.kill();
+                        batch.unchecked = batch.inserts.size();
+
+                        errCode = 16460;
+                        errMsg = str::stream() << "error inserting " << batch.inserts.size()
+                                               << " documents to shard "
+                                               << batch.shard->toString() << causedBy(e);
+                        warning() << errMsg << endl;
+                        continue;
+                    }
+
+                    //
+                    // SPLIT CHUNKS IF NEEDED
+                    //
+
+                    // Should never throw errors!
+                    if (!batch.chunkData.empty() && r.getClientInfo()->autoSplitOk()) {
+                        for (map<ChunkPtr, int>::iterator c = batch.chunkData.begin();
+                                c != batch.chunkData.end(); ++c) {
+                            c->first->splitIfShould(c->second);
+                        }
+                    }
+                }
+
+                //
+                // CHECK THE LAST MESSAGE TO EVERY SHARD, NOW THAT ALL HAVE BEEN SENT
+                //
+
+                vector<string> acceptedShards;
+
+                if (flags & WriteOption_StaleConfigError) {
+                    for (map<string, ShardInsertBatch>::iterator it = batches.begin();
+                            it != batches.end(); ++it) {
+
+                        ShardInsertBatch& batch = it->second;
+                        if (batch.unchecked >= batch.inserts.size()) continue;
+
+                        // The same connection the inserts went out on, without a version check
+                        ShardConnection dbcon(*batch.shard, "");
+                        try {
+                            _checkStaleWrite(dbcon, ns);
+                            dbcon.done();
+                            acceptedShards.push_back(batch.shard->getConnString());
+                        }
+                        catch (StaleConfigException& e) {
+                            dbcon.done();
+                            if (!stale) stale.reset(new StaleConfigException(e));
+                            unsent.insert(unsent.end(),
+                                          batch.inserts.begin() + batch.unchecked,
+                                          batch.inserts.end());
+                        }
+                        catch (DBException& e) {
+                            dbcon.kill();
+                            warning() << "could not check inserts to shard "
+                                      << batch.shard->toString() << causedBy(e) << endl;
+                        }
+                    }
+                }
+
+                if (stale) {
+                    _handleRetries("insert", retries, ns, unsent[0], *stale, r);
+                    retries++;
+
+                    // The retry forgets the shards written to so far, but the client's
+                    // getLastError must still check those that accepted their inserts
+                    for (vector<string>::iterator it = acceptedShards.begin();
+                            it != acceptedShards.end(); ++it) {
+                        r.getClientInfo()->addShard(*it);
+                    }
+                }
+
+                pending.swap(unsent);
+            }
+
+            if (errMsg.empty()) {
+                // The client's getLastError checks every shard we sent to
+                return true;
+            }
+
+            //
+            // Our error supersedes any from the shards, so wait for the shards first, as
+            // _insert() does before reporting an error from mongos
+            //
+
+            ClientInfo* ci = r.getClientInfo();
+            ci->newRequest();
+
+            BSONObjBuilder gleB;
+            string gleErrMsg;
+            ci->getLastError("admin", BSON( "getLastError" << 1 ), gleB, gleErrMsg, false);
+            LOG(3) << "shard GLE before reporting insert error was " << gleB.obj()
+                   << " errmsg: " << gleErrMsg << endl;
+            ci->clearSinceLastGetError();
+
+            uasserted(errCode, str::stream() << "error inserting documents" << causedBy(errMsg));
+        }
+
         /**
          * This insert function now handes all inserts, unsharded or sharded, through mongos.
+         * Continue-on-error inserts are dispatched to all shards at once, see _insertBucketed().
          *
          * Semantics for insert are ContinueOnError - to match mongod semantics :
          * 1) Error is thrown immediately for corrupt objects
@@ -536,6 +904,16 @@ namespace mongo {
 
             bool continueOnError = flags & InsertOption_ContinueOnError;
 
+            if (staleWriteRetry) flags |= WriteOption_StaleConfigError;
+
+            if (continueOnError) {
+                d.markSet();
+                if (_insertBucketed(ns, d, flags, r)) {
+                    return;
+                }
+                d.markReset();
+            }
+
             // Sanity check, probably not needed but for safety
             int retries = 0;
 
@@ -601,9 +979,6 @@ namespace mongo {
                         // Will throw SCE if we need to reset our version before sending.
                         dbcon.setVersion();
 
-                        // Reset our retries to zero since this batch's version went through
-                        retries = 0;
-
                         //
                         // SEND INSERT
                         //
@@ -614,6 +989,14 @@ namespace mongo {
 
                             dbcon->insert(ns, group.inserts, flags);
 
+                            // Will throw SCE if the shard rejected the inserts as stale
+                            if (flags & WriteOption_StaleConfigError) {
+                                _checkStaleWrite(dbcon, ns);
+                            }
+
+                            // Reset our retries to zero since this batch's version went through
+                            retries = 0;
+
                             //
                             // WARNING: We *have* to return the connection here, otherwise the
                             // error gets checked on a different connection!
@@ -671,6 +1054,9 @@ namespace mongo {
                                 ci->clearSinceLastGetError();
                             }
                         }
+                        catch (StaleConfigException&) {
+                            throw;
+                        }
                         catch (DBException& e) {
                             // Network error on send or GLE
                             insertErr = e.what();
@@ -796,6 +1182,7 @@ namespace mongo {
                             ShardPtr& shard,
                             ChunkManagerPtr& manager,
                             ShardPtr& primary,
+                            set<Shard>& shards,
                             // Input
                             bool reloadConfigData = false)
         {
@@ -803,13 +1190,7 @@ namespace mongo {
             // Updates have three basic targeting options :
             // 1) Primary shard
             // 2) Single shard in collection
-            // 3) All shards in cluster
-            //
-            // We don't (currently) target just a few shards because on retry we'd need to ensure that we didn't send
-            // the update to a shard twice.
-            //
-            // TODO: Think this is fixable, if we better track where we're sending requests.
-            // TODO: Async connection layer with error checking would make this much simpler.
+            // 3) The shards whose chunks intersect the query, see _targetedWrite()
             //
 
             // Refresh config if specified
@@ -822,6 +1203,7 @@ namespace mongo {
 
             chunk.reset();
             shard.reset();
+            shards.clear();
 
             // Unsharded updates just go to the one primary shard
             if( ! manager ){
@@ -872,7 +1254,8 @@ namespace mongo {
                         // Retry reloading the config data once, in case the shard key
                         // has changed on us in the meantime
                         if( ! reloadConfigData ){
-                            _prepareUpdate( ns, query, toUpdate, flags, chunk, shard, manager, primary, true );
+                            _prepareUpdate( ns, query, toUpdate, flags, chunk, shard, manager, primary,
+                                            shards, true );
                             return;
                         }
 
@@ -898,7 +1281,8 @@ namespace mongo {
 
                     // Retry reloading the config data once
                     if( ! reloadConfigData ){
-                        _prepareUpdate( ns, query, toUpdate, flags, chunk, shard, manager, primary, true );
+                        _prepareUpdate( ns, query, toUpdate, flags, chunk, shard, manager, primary,
+                                        shards, true );
                         return;
                     }
 
@@ -921,7 +1305,8 @@ namespace mongo {
 
                         // Retry reloading the config data once
                         if( ! reloadConfigData ){
-                            _prepareUpdate( ns, query, toUpdate, flags, chunk, shard, manager, primary, true );
+                            _prepareUpdate( ns, query, toUpdate, flags, chunk, shard, manager, primary,
+                                            shards, true );
                             return;
                         }
 
@@ -958,7 +1343,8 @@ namespace mongo {
 
                     // Retry reloading the config data once
                     if( ! reloadConfigData ){
-                        _prepareUpdate( ns, query, toUpdate, flags, chunk, shard, manager, primary, true );
+                        _prepareUpdate( ns, query, toUpdate, flags, chunk, shard, manager, primary,
+                                        shards, true );
                         return;
                     }
 
@@ -968,7 +1354,6 @@ namespace mongo {
                         << "can't upsert something without full valid shard key : " << query );
                 }
 
-                set<Shard> shards;
                 manager->getShardsForQuery( shards, query );
 
                 verify( shards.size() > 0 );
@@ -985,7 +1370,8 @@ namespace mongo {
 
                     // Retry reloading the config data once
                     if( ! reloadConfigData ){
-                        _prepareUpdate( ns, query, toUpdate, flags, chunk, shard, manager, primary, true );
+                        _prepareUpdate( ns, query, toUpdate, flags, chunk, shard, manager, primary,
+                                        shards, true );
                         return;
                     }
 
@@ -999,6 +1385,137 @@ namespace mongo {
             }
         }
 
+        /**
+         * Sends an update or delete that may match documents on several shards to just the
+         * shards whose chunks intersect its query, rather than to every shard in the cluster.
+         * Only used with staleWriteRetry on, otherwise such writes are broadcast.
+         *
+         * The version of every targeted shard is set before the write is sent to any of them,
+         * so a stale routing table throws StaleConfigException while the write can still be
+         * re-targeted and retried without reaching any shard twice.
+         *
+         * A migration can still commit after the versions were set, moving matching documents
+         * to a shard that was not targeted.  Each shard checks the write against the version
+         * it was sent with, so the shards the migration changed see it as stale.  The write
+         * carries Reserved_StaleConfigError, so such a shard rejects it rather than queuing a
+         * writeback, which would re-send it to every targeted shard and apply a non-idempotent
+         * write twice on the ones which had already applied it.  Each rejection is read back
+         * through _checkStaleWrite(), and the write is re-targeted with the reloaded chunk
+         * manager and sent to the shards now owning the query's range, except those which
+         * applied it already.
+         *
+         * A shard too old to honor Reserved_StaleConfigError would still queue a writeback, so
+         * if a targeted shard did not say it honors it, nothing is sent.
+         *
+         * @return false if a targeted shard may not honor Reserved_StaleConfigError, in which
+         *         case the caller broadcasts the write
+         */
+        bool _targetedWrite( const string& op,
+                             const string& ns,
+                             const BSONObj& query,
+                             set<Shard> shards,
+                             ChunkManagerPtr manager,
+                             Request& r )
+        {
+            r.d().reservedField() |= Reserved_StaleConfigError;
+
+            // Shards which applied the write, and must not be sent it again
+            set<Shard> applied;
+
+            for ( int retries = 0; ; retries++ ) {
+
+                LOG(2) << "targeted write to " << ns << " on " << shards.size() << " shards" << endl;
+
+                OwnedPointerVector<ShardConnection> conns;
+                vector<ShardConnection*>& dbcons = conns.mutableVector();
+                bool stale = false;
+                bool rejectsStaleWrites = true;
+
+                try {
+                    for ( set<Shard>::const_iterator it = shards.begin(); it != shards.end(); ++it ) {
+                        dbcons.push_back( new ShardConnection( *it, ns, manager ) );
+
+                        // An exception will be thrown if the version is incompatible
+                        dbcons.back()->setVersion();
+
+                        if ( ! versionManager.rejectsStaleWrites( dbcons.back() ) )
+                            rejectsStaleWrites = false;
+                    }
+                }
+                catch ( StaleConfigException& e ) {
+                    // Nothing was sent yet, so every connection can go back to the pool
+                    for ( size_t i = 0; i < dbcons.size(); i++ ) dbcons[i]->done();
+
+                    // Before any shard applied the write, the caller re-runs all targeting
+                    if ( applied.empty() ) throw;
+
+                    _handleRetries( op, retries, ns, query, e, r, false );
+                    stale = true;
+                }
+
+                if ( ! stale && ! rejectsStaleWrites ) {
+                    for ( size_t i = 0; i < dbcons.size(); i++ ) dbcons[i]->done();
+
+                    if ( applied.empty() ) {
+                        LOG(1) << "not targeting " << op << " on " << ns << ", a shard may not "
+                               << "reject stale writes" << endl;
+                        r.d().reservedField() &= ~Reserved_StaleConfigError;
+                        return false;
+                    }
+
+                    // Broadcasting now would apply the write twice on the shards which applied
+                    // it already
+                    uasserted( 16967, str::stream() << op << " on " << ns << " was applied on "
+                                                    << applied.size() << " shards, but the "
+                                                    << "shards it moved to may not reject stale "
+                                                    << "writes" );
+                }
+
+                if ( ! stale ) {
+
+                    for ( size_t i = 0; i < dbcons.size(); i++ ) {
+                        (*dbcons[i])->say( r.m() );
+                    }
+
+                    set<Shard>::const_iterator shard = shards.begin();
+                    for ( size_t i = 0; i < dbcons.size(); i++, ++shard ) {
+                        try {
+                            _checkStaleWrite( *dbcons[i], ns );
+                            applied.insert( *shard );
+                        }
+                        catch ( StaleConfigException& e ) {
+                            if ( ! stale ) _handleRetries( op, retries, ns, query, e, r, false );
+                            stale = true;
+                        }
+
+                        //
+                        // WARNING: We *have* to return the connection here, otherwise the
+                        // error gets checked on a different connection!
+                        //
+                        dbcons[i]->done();
+                    }
+                }
+
+                if ( ! stale )
+                    return true;
+
+                manager = grid.getDBConfig( ns )->getChunkManagerIfExists( ns );
+                uassert( 16966, str::stream() << op << " on " << ns << " was applied on "
+                                              << applied.size() << " shards, but the collection "
+                                              << "is no longer sharded",
+                         manager );
+
+                shards.clear();
+                manager->getShardsForQuery( shards, query );
+                for ( set<Shard>::const_iterator it = applied.begin(); it != applied.end(); ++it ) {
+                    shards.erase( *it );
+                }
+
+                if ( shards.empty() )
+                    return true;
+            }
+        }
+
         void _update( Request& r , DbMessage& d ){
 
             // const details of the request
@@ -1035,19 +1552,27 @@ namespace mongo {
             ShardPtr shard;
             ChunkManagerPtr manager;
             ShardPtr primary;
+            set<Shard> shards;
 
-            _prepareUpdate( ns, query, toUpdate, flags, chunk, shard, manager, primary );
+            _prepareUpdate( ns, query, toUpdate, flags, chunk, shard, manager, primary, shards );
 
             if( ! shard ){
 
                 //
-                // Without a shard, target all shards
+                // Without a single shard, target the shards whose chunks intersect the query if
+                // their rejections are checked, otherwise send to every shard
                 //
 
-                //
-                // data could be on more than one shard. must send to all
-                // TODO: make this safer w/ shard add/remove
-                //
+                try {
+                    if ( staleWriteRetry &&
+                            _targetedWrite( "update", ns, query, shards, manager, r ) )
+                        return;
+                }
+                catch ( StaleConfigException& e ) {
+                    _handleRetries( "update", retries, ns, query, e, r );
+                    _update( ns, query, toUpdate, flags, r, d, retries + 1 );
+                    return;
+                }
 
                 int* opts = (int*)( r.d().afterNS() );
                 opts[0] |= UpdateOption_Broadcast; // this means don't check shard version in mongod
@@ -1075,7 +1600,22 @@ namespace mongo {
                 return;
             }
 
-            dbcon->update( ns, query, toUpdate, flags );
+            if ( staleWriteRetry ) {
+                dbcon->update( ns, query, toUpdate, flags | WriteOption_StaleConfigError );
+
+                try {
+                    _checkStaleWrite( dbcon, ns );
+                }
+                catch ( StaleConfigException& e ) {
+                    dbcon.done();
+                    _handleRetries( "update", retries, ns, query, e, r );
+                    _update( ns, query, toUpdate, flags, r, d, retries + 1 );
+                    return;
+                }
+            }
+            else {
+                dbcon->update( ns, query, toUpdate, flags );
+            }
 
             dbcon.done();
 
@@ -1090,6 +1630,7 @@ namespace mongo {
                              ShardPtr& shard,
                              ChunkManagerPtr& manager,
                              ShardPtr& primary,
+                             set<Shard>& shards,
                              bool reloadConfigData = false )
         {
 
@@ -1097,13 +1638,7 @@ namespace mongo {
             // Deletes also have three basic targeting options :
             // 1) Primary shard
             // 2) Single shard in collection
-            // 3) All shards in cluster
-            //
-            // We don't (currently) target just a few shards because on retry we'd need to ensure that we didn't send
-            // the delete to a shard twice.
-            //
-            // TODO: Think this is fixable, if we better track where we're sending requests.
-            // TODO: Async connection layer with error checking would make this much simpler.
+            // 3) The shards whose chunks intersect the query, see _targetedWrite()
             //
 
             // Refresh config if specified
@@ -1112,6 +1647,7 @@ namespace mongo {
             bool justOne = flags & RemoveOption_JustOne;
 
             shard.reset();
+            shards.clear();
             grid.getDBConfig( ns )->getChunkManagerOrPrimary( ns, manager, primary );
 
             if( primary ){
@@ -1120,7 +1656,6 @@ namespace mongo {
                 return;
             }
 
-            set<Shard> shards;
             manager->getShardsForQuery( shards, query );
 
             LOG(2) << "delete : " << query << " \t " << shards.size() << " justOne: " << justOne << endl;
@@ -1135,7 +1670,7 @@ namespace mongo {
 
                 // Retry reloading the config data once
                 if( ! reloadConfigData ){
-                    _prepareDelete( ns, query, flags, shard, manager, primary, true );
+                    _prepareDelete( ns, query, flags, shard, manager, primary, shards, true );
                     return;
                 }
 
@@ -1149,7 +1684,7 @@ namespace mongo {
 
                 // Retry reloading the config data once
                 if( ! reloadConfigData ){
-                    _prepareDelete( ns, query, flags, shard, manager, primary, true );
+                    _prepareDelete( ns, query, flags, shard, manager, primary, shards, true );
                     return;
                 }
 
@@ -1193,14 +1728,26 @@ namespace mongo {
             ShardPtr shard;
             ChunkManagerPtr manager;
             ShardPtr primary;
+            set<Shard> shards;
 
-            _prepareDelete( ns, query, flags, shard, manager, primary );
+            _prepareDelete( ns, query, flags, shard, manager, primary, shards );
 
             if( ! shard ){
 
+                try {
+                    if ( staleWriteRetry &&
+                            _targetedWrite( "delete", ns, query, shards, manager, r ) )
+                        return;
+                }
+                catch ( StaleConfigException& e ) {
+                    _handleRetries( "delete", retries, ns, query, e, r );
+                    _delete( ns, query, flags, r, d, retries + 1 );
+                    return;
+                }
+
                 int * x = (int*)(r.d().afterNS());
                 x[0] |= RemoveOption_Broadcast; // this means don't check shard version in mongod
-                broadcastWrite(dbDelete, r);
+                broadcastWrite( dbDelete, r );
                 return;
             }
 
@@ -1217,7 +1764,22 @@ namespace mongo {
                 return;
             }
 
-            dbcon->remove( ns, query, flags );
+            if ( staleWriteRetry ) {
+                dbcon->remove( ns, query, flags | WriteOption_StaleConfigError );
+
+                try {
+                    _checkStaleWrite( dbcon, ns );
+                }
+                catch ( StaleConfigException& e ) {
+                    dbcon.done();
+                    _handleRetries( "delete", retries, ns, query, e, r );
+                    _delete( ns, query, flags, r, d, retries + 1 );
+                    return;
+                }
+            }
+            else {
+                dbcon->remove( ns, query, flags );
+            }
 
             dbcon.done();
         }
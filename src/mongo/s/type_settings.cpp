@@ -31,6 +31,8 @@ namespace mongo {
     const BSONField<BSONObj> SettingsType::balancerActiveWindow("activeWindow");
     const BSONField<bool> SettingsType::shortBalancerSleep("_nosleep");
     const BSONField<bool> SettingsType::secondaryThrottle("_secondaryThrottle");
+    const BSONField<int> SettingsType::maxConcurrentMigrations("maxConcurrentMigrations");
+    const BSONField<bool> SettingsType::balanceByLoad("_balanceByLoad");
 
     SettingsType::SettingsType() {
         clear();
@@ -66,6 +68,12 @@ namespace mongo {
             return true;
         }
         else if (_key == "balancer") {
+            if (_isMaxConcurrentMigrationsSet && _maxConcurrentMigrations < 0) {
+                *errMsg = stream() << maxConcurrentMigrations.name() <<
+                                      " must not be negative";
+                return false;
+            }
+
             if (_balancerActiveWindow.nFields() != 0) {
                 // check if both 'start' and 'stop' are present
                 const std::string start = _balancerActiveWindow["start"].str();
@@ -103,6 +111,10 @@ namespace mongo {
         }
         if (_isShortBalancerSleepSet) builder.append(shortBalancerSleep(), _shortBalancerSleep);
         if (_isSecondaryThrottleSet) builder.append(secondaryThrottle(), _secondaryThrottle);
+        if (_isMaxConcurrentMigrationsSet) {
+            builder.append(maxConcurrentMigrations(), _maxConcurrentMigrations);
+        }
+        if (_isBalanceByLoadSet) builder.append(balanceByLoad(), _balanceByLoad);
 
         return builder.obj();
     }
@@ -139,6 +151,15 @@ namespace mongo {
         if (fieldState == FieldParser::FIELD_INVALID) return false;
         _isSecondaryThrottleSet = fieldState == FieldParser::FIELD_SET;
 
+        fieldState = FieldParser::extractNumber(source, maxConcurrentMigrations,
+                                                &_maxConcurrentMigrations, errMsg);
+        if (fieldState == FieldParser::FIELD_INVALID) return false;
+        _isMaxConcurrentMigrationsSet = fieldState == FieldParser::FIELD_SET;
+
+        fieldState = FieldParser::extract(source, balanceByLoad, &_balanceByLoad, errMsg);
+        if (fieldState == FieldParser::FIELD_INVALID) return false;
+        _isBalanceByLoadSet = fieldState == FieldParser::FIELD_SET;
+
         return true;
     }
 
@@ -162,6 +183,12 @@ namespace mongo {
         _secondaryThrottle = false;
         _isSecondaryThrottleSet = false;
 
+        _maxConcurrentMigrations = 0;
+        _isMaxConcurrentMigrationsSet = false;
+
+        _balanceByLoad = false;
+        _isBalanceByLoadSet = false;
+
     }
 
     void SettingsType::cloneTo(SettingsType* other) const {
@@ -185,6 +212,12 @@ namespace mongo {
         other->_secondaryThrottle = _secondaryThrottle;
         other->_isSecondaryThrottleSet = _isSecondaryThrottleSet;
 
+        other->_maxConcurrentMigrations = _maxConcurrentMigrations;
+        other->_isMaxConcurrentMigrationsSet = _isMaxConcurrentMigrationsSet;
+
+        other->_balanceByLoad = _balanceByLoad;
+        other->_isBalanceByLoadSet = _isBalanceByLoadSet;
+
     }
 
     std::string SettingsType::toString() const {
@@ -83,7 +83,9 @@ namespace {
                            SettingsType::balancerActiveWindow(BSON("start" << "23:00" <<
                                                                    "stop" << "6:00" )) <<
                            SettingsType::shortBalancerSleep(true) <<
-                           SettingsType::secondaryThrottle(true));
+                           SettingsType::secondaryThrottle(true) <<
+                           SettingsType::maxConcurrentMigrations(2) <<
+                           SettingsType::balanceByLoad(true));
         ASSERT(settings.parseBSON(objBalancer, &errMsg));
         ASSERT_EQUALS(errMsg, "");
         ASSERT_TRUE(settings.isValid(NULL));
@@ -93,6 +95,18 @@ namespace {
                                                                "stop" << "6:00" ));
         ASSERT_EQUALS(settings.getShortBalancerSleep(), true);
         ASSERT_EQUALS(settings.getSecondaryThrottle(), true);
+        ASSERT_EQUALS(settings.getMaxConcurrentMigrations(), 2);
+        ASSERT_EQUALS(settings.getBalanceByLoad(), true);
+    }
+
+    TEST(Validity, NegativeMaxConcurrentMigrations) {
+        SettingsType settings;
+        BSONObj objBalancer = BSON(SettingsType::key("balancer") <<
+                                   SettingsType::maxConcurrentMigrations(-1));
+        string errMsg;
+        ASSERT(settings.parseBSON(objBalancer, &errMsg));
+        ASSERT_EQUALS(errMsg, "");
+        ASSERT_FALSE(settings.isValid(NULL));
     }
 
     TEST(Validity, BadType) {
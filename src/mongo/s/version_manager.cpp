@@ -18,6 +18,8 @@
 
 #include "mongo/s/version_manager.h"
 
+#include "mongo/base/counter.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/s/chunk.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/config.h"
@@ -31,6 +33,20 @@ namespace mongo {
     // Global version manager
     VersionManager versionManager;
 
+    // setShardVersion round trips made before a request, and those requestShardVersionCB()
+    // saved by sending the version with the request on a connection that needed one
+    static Counter64 setShardVersionRoundTrips;
+    static ServerStatusMetricField<Counter64> displaySetShardVersionRoundTrips(
+            "sharding.shardVersion.roundTrips", &setShardVersionRoundTrips );
+
+    static Counter64 setShardVersionRoundTripsAvoided;
+    static ServerStatusMetricField<Counter64> displaySetShardVersionRoundTripsAvoided(
+            "sharding.shardVersion.roundTripsAvoided", &setShardVersionRoundTripsAvoided );
+
+    static Counter64 requestsWithShardVersion;
+    static ServerStatusMetricField<Counter64> displayRequestsWithShardVersion(
+            "sharding.shardVersion.requestMetadata", &requestsWithShardVersion );
+
     // when running in sharded mode, use chunk shard version control
     struct ConnectionShardStatus {
 
@@ -53,14 +69,32 @@ namespace mongo {
         void reset( DBClientBase * conn ) {
             scoped_lock lk( _mutex );
             _map.erase( conn->getConnectionId() );
+            _rejectsStaleWrites.erase( conn->getConnectionId() );
+        }
+
+        bool rejectsStaleWrites( DBClientBase * conn ) {
+            scoped_lock lk( _mutex );
+            return _rejectsStaleWrites.count( conn->getConnectionId() ) > 0;
+        }
+
+        void setRejectsStaleWrites( DBClientBase * conn , bool rejects ) {
+            scoped_lock lk( _mutex );
+            if ( rejects )
+                _rejectsStaleWrites.insert( conn->getConnectionId() );
+            else
+                _rejectsStaleWrites.erase( conn->getConnectionId() );
         }
 
-        // protects _map
+        // protects _map and _rejectsStaleWrites
         mongo::mutex _mutex;
 
         // a map from a connection into ChunkManager's sequence number for each namespace
         map<unsigned long long, map<string,unsigned long long> > _map;
 
+        // connections whose shard reported in setShardVersion that it honors
+        // Reserved_StaleConfigError
+        set<unsigned long long> _rejectsStaleWrites;
+
     } connectionShardStatus;
 
     void VersionManager::resetShardVersionCB( DBClientBase * conn ) {
@@ -229,11 +263,15 @@ namespace mongo {
 
         const string versionableServerAddress(conn->getServerAddress());
 
+        setShardVersionRoundTrips.increment();
+
         BSONObj result;
         if ( setShardVersion( *conn , ns , version , manager , authoritative , result ) ) {
             // success!
             LOG(1) << "      setShardVersion success: " << result << endl;
             connectionShardStatus.setSequence( conn , ns , officialSequenceNumber );
+            connectionShardStatus.setRejectsStaleWrites( conn ,
+                                                         result["rejectsStaleWrites"].trueValue() );
             return true;
         }
 
@@ -289,4 +327,61 @@ namespace mongo {
         return checkShardVersion( conn_in->get(), conn_in->getNS(), conn_in->getManager(), authoritative, tryNumber );
     }
 
+    bool VersionManager::rejectsStaleWrites( ShardConnection* conn_in ) {
+        return connectionShardStatus.rejectsStaleWrites( getVersionable( conn_in->get() ) );
+    }
+
+    BSONObj VersionManager::requestShardVersionCB( ShardConnection* conn_in, const Shard& shard ) {
+
+        ChunkManagerPtr manager = conn_in->getManager();
+        verify( manager );
+
+        // nothing is set on the connection, so it must not be initialized yet
+        conn_in->donotCheckVersion();
+
+        DBClientBase* rawConn = conn_in->getRawConn();
+        WriteBackListener::init( *rawConn );
+
+        // Would checkShardVersion() have issued a setShardVersion for this request?
+        DBClientBase* conn = getVersionable( rawConn );
+        if ( connectionShardStatus.getSequence( conn, manager->getns() ) !=
+                manager->getSequenceNumber() ) {
+            setShardVersionRoundTripsAvoided.increment();
+        }
+        requestsWithShardVersion.increment();
+
+        BSONObjBuilder b;
+        b.append( "ns", manager->getns() );
+        manager->getVersion( shard ).addToBSON( b, "version" );
+        return b.obj();
+    }
+
+    BSONObj VersionManager::attachShardVersion( const BSONObj& query,
+                                                const BSONObj& versionMetadata,
+                                                bool isCommand ) {
+
+        // Same test for an already wrapped query as the shard uses, see ParsedQuery and
+        // _runCommands()
+        bool wrapped;
+        if ( isCommand ) {
+            BSONElement first = query.firstElement();
+            wrapped = first.type() == Object &&
+                      ( str::equals( first.fieldName(), "query" ) ||
+                        str::equals( first.fieldName(), "$query" ) );
+        }
+        else {
+            wrapped = query["query"].isABSONObj() || query["$query"].isABSONObj();
+        }
+
+        BSONObjBuilder b;
+        if ( wrapped ) {
+            b.appendElements( query );
+        }
+        else {
+            b.append( "$query", query );
+        }
+        b.append( "$shardVersion", versionMetadata );
+        return b.obj();
+    }
+
 }  // namespace mongo
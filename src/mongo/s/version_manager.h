@@ -22,6 +22,7 @@ namespace mongo {
 
     class ShardConnection;
     class DBClientBase;
+    class Shard;
 
     class VersionManager {
     public:
@@ -34,6 +35,28 @@ namespace mongo {
         bool checkShardVersionCB( ShardConnection*, bool, int );
         void resetShardVersionCB( DBClientBase* );
 
+        /**
+         * @return true if the shard behind the connection said, when its version was last set,
+         * that it reports a write sent with Reserved_StaleConfigError at a stale version as an
+         * error rather than queuing a writeback. Shards older than that never say so.
+         */
+        bool rejectsStaleWrites( ShardConnection* );
+
+        /**
+         * Used instead of checkShardVersionCB() when the shard version is sent with each
+         * request rather than set on the connection. Marks the connection as needing no
+         * setShardVersion and returns the version metadata of its namespace on 'shard',
+         * to be passed to attachShardVersion().
+         */
+        BSONObj requestShardVersionCB( ShardConnection*, const Shard& );
+
+        /**
+         * @return 'query', a query or command, carrying 'versionMetadata' as $shardVersion
+         */
+        static BSONObj attachShardVersion( const BSONObj& query,
+                                           const BSONObj& versionMetadata,
+                                           bool isCommand );
+
     };
 
     extern VersionManager versionManager;
@@ -59,7 +59,7 @@ namespace mongo {
                     doWork();
                 }
                 catch(...) { }
-                sleepmillis(repeat);
+                sleepmillis(pauseMillis(repeat));
                 if( inShutdown() )
                     break;
                 if( repeat == 0 )
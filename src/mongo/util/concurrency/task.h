@@ -32,6 +32,9 @@ namespace mongo {
             virtual void setUp();  // Override to perform any do-once work for the task.
             virtual void doWork() = 0;                  // implement the task here.
             virtual string name() const = 0;            // name the thread
+            /** for a repeating task, the pause before the next doWork().  'millis' is the pause
+                given to repeat(), or 0 once halted.  Override to pause less after some runs. */
+            virtual unsigned pauseMillis(unsigned millis) { return millis; }
         public:
             Task();
 